@@ -0,0 +1,223 @@
+#pragma once
+
+/*
+ * Bounding volume hierarchy over axis aligned bounding boxes
+ * - Built top down, each node split where the surface area heuristic (SAH) is cheapest, found by sweeping the
+ *   items sorted by centroid along every axis.
+ * - Items that move are refit in place by walking up from their leaf. Refitting keeps queries correct but not the
+ *   tree's quality, rebuild after items are added or have moved far.
+ * - Queries report item indices (the order items were given to buildBVH()) in no particular order.
+ */
+
+#define BVH_MAX_LEAF_ITEM_COUNT 4
+#define BVH_NODE_NONE U32_MAX
+#define BVH_MAX_DEPTH 64
+
+struct BVHNode {
+  BoundingBox bounds;
+  u32 firstChildOrItem; // NOTE: interior: left child, right child directly follows. leaf: first of BVH::leafItems
+  u32 itemCount; // NOTE: 0 for interior nodes
+  u32 parent;
+};
+
+struct BVH {
+  BVHNode* nodes; // NOTE: nodes[0] is the root
+  u32* leafItems; // NOTE: item indices grouped by leaf
+  u32* itemLeaves; // NOTE: leaf node of each item
+  BoundingBox* itemBounds;
+  u32 nodeCount;
+  u32 itemCount;
+  u32 maxItemCount;
+};
+
+void initBVH(BVH* bvh, u32 maxItemCount) {
+  *bvh = {};
+  bvh->maxItemCount = maxItemCount;
+  bvh->nodes = new BVHNode[(2 * maxItemCount) - 1]; // NOTE: at least one item per leaf
+  bvh->leafItems = new u32[maxItemCount];
+  bvh->itemLeaves = new u32[maxItemCount];
+  bvh->itemBounds = new BoundingBox[maxItemCount];
+}
+
+void deleteBVH(BVH* bvh) {
+  delete[] bvh->nodes;
+  delete[] bvh->leafItems;
+  delete[] bvh->itemLeaves;
+  delete[] bvh->itemBounds;
+  *bvh = {};
+}
+
+internal_func BoundingBox bvhItemsBounds(const BVH& bvh, u32 firstLeafItem, u32 itemCount) {
+  BoundingBox bounds = bvh.itemBounds[bvh.leafItems[firstLeafItem]];
+  for(u32 i = firstLeafItem + 1; i < firstLeafItem + itemCount; i++) {
+    bounds = boundingBoxUnion(bounds, bvh.itemBounds[bvh.leafItems[i]]);
+  }
+  return bounds;
+}
+
+internal_func void sortBVHItemsByCentroid(BVH* bvh, u32 firstLeafItem, u32 itemCount, u32 axis) {
+  const BoundingBox* itemBounds = bvh->itemBounds;
+  std::sort(bvh->leafItems + firstLeafItem, bvh->leafItems + firstLeafItem + itemCount, [itemBounds, axis](u32 a, u32 b) {
+    // NOTE: min + max is twice the centroid, good enough for ordering
+    return (2.0f * itemBounds[a].min.val[axis]) + itemBounds[a].diagonal.val[axis] <
+           (2.0f * itemBounds[b].min.val[axis]) + itemBounds[b].diagonal.val[axis];
+  });
+}
+
+internal_func void buildBVHNode(BVH* bvh, u32 nodeIndex, u32 firstLeafItem, u32 itemCount, f32* sweepAreas) {
+  BVHNode* node = bvh->nodes + nodeIndex;
+  node->bounds = bvhItemsBounds(*bvh, firstLeafItem, itemCount);
+
+  // NOTE: SAH cost relative to the node's area: 1 (traversal) + (leftArea * leftCount + rightArea * rightCount) / area
+  // versus itemCount for a leaf
+  f32 bestCost = F32_MAX;
+  u32 bestAxis = 0;
+  u32 bestLeftCount = 0;
+  if(itemCount > 1) {
+    for(u32 axis = 0; axis < 3; axis++) {
+      sortBVHItemsByCentroid(bvh, firstLeafItem, itemCount, axis);
+      // sweepAreas[i] = area of the items from i to the end
+      BoundingBox sweepBounds = bvh->itemBounds[bvh->leafItems[firstLeafItem + itemCount - 1]];
+      for(u32 i = itemCount - 1; i > 0; i--) {
+        sweepBounds = boundingBoxUnion(sweepBounds, bvh->itemBounds[bvh->leafItems[firstLeafItem + i]]);
+        sweepAreas[i] = surfaceArea(sweepBounds);
+      }
+      sweepBounds = bvh->itemBounds[bvh->leafItems[firstLeafItem]];
+      for(u32 leftCount = 1; leftCount < itemCount; leftCount++) {
+        sweepBounds = boundingBoxUnion(sweepBounds, bvh->itemBounds[bvh->leafItems[firstLeafItem + leftCount - 1]]);
+        f32 cost = (surfaceArea(sweepBounds) * leftCount) + (sweepAreas[leftCount] * (itemCount - leftCount));
+        if(cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestLeftCount = leftCount;
+        }
+      }
+    }
+    f32 nodeArea = surfaceArea(node->bounds);
+    bestCost = nodeArea > 0.0f ? 1.0f + (bestCost / nodeArea) : F32_MAX; // NOTE: degenerate bounds can't be split usefully
+  }
+
+  b32 splittable = bestCost != F32_MAX;
+  if(itemCount <= BVH_MAX_LEAF_ITEM_COUNT && (!splittable || bestCost >= (f32)itemCount)) {
+    node->firstChildOrItem = firstLeafItem;
+    node->itemCount = itemCount;
+    for(u32 i = firstLeafItem; i < firstLeafItem + itemCount; i++) {
+      bvh->itemLeaves[bvh->leafItems[i]] = nodeIndex;
+    }
+    return;
+  }
+  if(!splittable) { // NOTE: coincident items, split down the middle to bound leaf size
+    bestAxis = 2;
+    bestLeftCount = itemCount / 2;
+  }
+
+  if(bestAxis != 2) { sortBVHItemsByCentroid(bvh, firstLeafItem, itemCount, bestAxis); }
+  u32 leftChild = bvh->nodeCount;
+  bvh->nodeCount += 2;
+  node->firstChildOrItem = leftChild;
+  node->itemCount = 0;
+  bvh->nodes[leftChild].parent = nodeIndex;
+  bvh->nodes[leftChild + 1].parent = nodeIndex;
+  buildBVHNode(bvh, leftChild, firstLeafItem, bestLeftCount, sweepAreas);
+  buildBVHNode(bvh, leftChild + 1, firstLeafItem + bestLeftCount, itemCount - bestLeftCount, sweepAreas);
+}
+
+void buildBVH(BVH* bvh, const BoundingBox* itemBounds, u32 itemCount) {
+  Assert(itemCount <= bvh->maxItemCount);
+  bvh->itemCount = itemCount;
+  bvh->nodeCount = 0;
+  if(itemCount == 0) { return; }
+
+  for(u32 item = 0; item < itemCount; item++) {
+    bvh->itemBounds[item] = itemBounds[item];
+    bvh->leafItems[item] = item;
+  }
+  std::vector<f32> sweepAreas(itemCount);
+  bvh->nodeCount = 1;
+  bvh->nodes[0].parent = BVH_NODE_NONE;
+  buildBVHNode(bvh, 0, 0, itemCount, sweepAreas.data());
+}
+
+// NOTE: Updates an item's bounds and refits every node from its leaf up to the root
+void refitBVHItem(BVH* bvh, u32 item, const BoundingBox& bounds) {
+  Assert(item < bvh->itemCount);
+  bvh->itemBounds[item] = bounds;
+  u32 nodeIndex = bvh->itemLeaves[item];
+  while(nodeIndex != BVH_NODE_NONE) {
+    BVHNode* node = bvh->nodes + nodeIndex;
+    if(node->itemCount != 0) {
+      node->bounds = bvhItemsBounds(*bvh, node->firstChildOrItem, node->itemCount);
+    } else {
+      node->bounds = boundingBoxUnion(bvh->nodes[node->firstChildOrItem].bounds, bvh->nodes[node->firstChildOrItem + 1].bounds);
+    }
+    nodeIndex = node->parent;
+  }
+}
+
+/*
+ * Depth first traversal shared by the queries
+ * nodeTest(const BoundingBox&) decides whether to descend, itemVisit(u32 item) returns false to stop the traversal
+ */
+template<typename NodeTest, typename ItemVisit>
+internal_func void traverseBVH(const BVH& bvh, NodeTest nodeTest, ItemVisit itemVisit) {
+  if(bvh.nodeCount == 0) { return; }
+  u32 nodeStack[BVH_MAX_DEPTH];
+  u32 nodeStackCount = 0;
+  nodeStack[nodeStackCount++] = 0;
+  while(nodeStackCount > 0) {
+    const BVHNode& node = bvh.nodes[nodeStack[--nodeStackCount]];
+    if(!nodeTest(node.bounds)) { continue; }
+    if(node.itemCount != 0) {
+      for(u32 i = node.firstChildOrItem; i < node.firstChildOrItem + node.itemCount; i++) {
+        u32 item = bvh.leafItems[i];
+        if(node.itemCount > 1 && !nodeTest(bvh.itemBounds[item])) { continue; }
+        if(!itemVisit(item)) { return; }
+      }
+    } else {
+      Assert(nodeStackCount + 2 <= BVH_MAX_DEPTH);
+      nodeStack[nodeStackCount++] = node.firstChildOrItem + 1;
+      nodeStack[nodeStackCount++] = node.firstChildOrItem;
+    }
+  }
+}
+
+// NOTE: returns the number of items written to items, items whose bounds overlap box beyond maxItemCount are dropped
+u32 queryBVHOverlap(const BVH& bvh, const BoundingBox& box, Out u32* items, u32 maxItemCount) {
+  u32 itemCount = 0;
+  traverseBVH(bvh,
+              [&box](const BoundingBox& bounds) { return overlap(bounds, box); },
+              [&](u32 item) { items[itemCount++] = item; return itemCount < maxItemCount; });
+  return itemCount;
+}
+
+// NOTE: planes as returned by frustumPlanes(), results are conservative like frustumBoxIntersection()
+u32 queryBVHFrustum(const BVH& bvh, const vec4* planes, Out u32* items, u32 maxItemCount) {
+  u32 itemCount = 0;
+  traverseBVH(bvh,
+              [planes](const BoundingBox& bounds) { return frustumBoxIntersection(planes, bounds); },
+              [&](u32 item) { items[itemCount++] = item; return itemCount < maxItemCount; });
+  return itemCount;
+}
+
+// NOTE: Closest item whose bounds are hit by the ray within maxDistance, direction need not be normalized
+// but distances are then in units of its length
+b32 queryBVHRay(const BVH& bvh, const vec3& origin, const vec3& direction, f32 maxDistance,
+                Out u32* hitItem, Out f32* hitDistance = nullptr) {
+  const vec3 inverseDirection{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+  f32 closestDistance = maxDistance;
+  u32 closestItem = BVH_NODE_NONE;
+  traverseBVH(bvh,
+              [&](const BoundingBox& bounds) { return rayBoxIntersection(origin, inverseDirection, bounds, closestDistance); },
+              [&](u32 item) {
+                f32 distance;
+                if(rayBoxIntersection(origin, inverseDirection, bvh.itemBounds[item], closestDistance, &distance)) {
+                  closestDistance = distance;
+                  closestItem = item;
+                }
+                return true;
+              });
+  if(closestItem == BVH_NODE_NONE) { return false; }
+  *hitItem = closestItem;
+  if(hitDistance != nullptr) { *hitDistance = closestDistance; }
+  return true;
+}
@@ -159,4 +159,19 @@ mat4 getViewMat(const Camera& camera) {
   // resulting matrix. All angles and area preserved.
   mat4 resultMat = measure * translation;
   return resultMat; // Remember to read from right to left (first translation then measure)
-}
\ No newline at end of file
+}
+
+// NOTE: Blends two states of the same camera, ex: for rendering between simulation steps. Cameras switching between
+// first and third person aren't blended, the result is the second camera.
+Camera lerpCamera(const Camera& a, const Camera& b, f32 t) {
+  if(a.thirdPerson != b.thirdPerson) { return b; }
+  Camera camera;
+  camera.thirdPerson = b.thirdPerson;
+  camera.origin = lerp(a.origin, b.origin, t);
+  camera.pitch = lerp(a.pitch, b.pitch, t);
+  camera.yaw = lerpAngle(a.yaw, b.yaw, t);
+  camera.forward = normalize(lerp(a.forward, b.forward, t));
+  camera.right = normalize(cross(camera.forward, WORLD_UP));
+  camera.up = cross(camera.right, camera.forward);
+  return camera;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+/*
+ * Swept axis aligned box collision with sliding
+ * - sweepBoxes(): time of impact of a moving box against a static box, found by casting the moving box's min corner
+ *   against the static box grown by the moving box's size (their Minkowski sum)
+ * - moveAndSlide(): moves a box until it hits something, then projects the remaining movement onto the surface hit
+ *   so the box slides along it. At most COLLISION_MAX_SLIDE_ITERATIONS sweeps over the obstacles are made, which
+ *   bounds the cost of a move to (iterations * obstacles) sweeps.
+ * Boxes only touching are not colliding, and obstacles the box already overlaps are ignored so it can always move
+ * out of them.
+ */
+
+#define COLLISION_MAX_SLIDE_ITERATIONS 4
+#define COLLISION_SKIN 0.001f // NOTE: distance moves stop short of surfaces, so resting contact is never an overlap
+
+/*
+ * parameters:
+ * hitTime returns the fraction of delta travelled before the boxes touch, in [0,1)
+ * hitNormal returns the axis aligned normal of the obstacle's face that was hit
+ */
+b32 sweepBoxes(const BoundingBox& box, const vec3& delta, const BoundingBox& obstacle, Out f32* hitTime, Out vec3* hitNormal) {
+  const vec3 expandedMin = obstacle.min - box.diagonal;
+  const vec3 expandedMax = obstacle.min + obstacle.diagonal;
+  f32 tEnter = -F32_MAX;
+  f32 tExit = F32_MAX;
+  u32 enterAxis = 0;
+  for(u32 axis = 0; axis < 3; axis++) {
+    f32 origin = box.min.val[axis];
+    if(delta.val[axis] == 0.0f) {
+      if(origin <= expandedMin.val[axis] || origin >= expandedMax.val[axis]) { return false; } // never overlapping on this axis
+      continue;
+    }
+    f32 inverseDelta = 1.0f / delta.val[axis];
+    f32 t1 = (expandedMin.val[axis] - origin) * inverseDelta;
+    f32 t2 = (expandedMax.val[axis] - origin) * inverseDelta;
+    f32 tNear = Min(t1, t2);
+    f32 tFar = Max(t1, t2);
+    if(tNear > tEnter) {
+      tEnter = tNear;
+      enterAxis = axis;
+    }
+    tExit = Min(tExit, tFar);
+  }
+
+  // NOTE: tEnter < 0 is either already overlapping or moving away
+  if(tEnter >= tExit || tEnter < 0.0f || tEnter >= 1.0f) { return false; }
+  *hitTime = tEnter;
+  *hitNormal = {};
+  hitNormal->val[enterAxis] = delta.val[enterAxis] > 0.0f ? -1.0f : 1.0f;
+  return true;
+}
+
+// NOTE: returns the movement actually made, which never exceeds delta on any axis
+vec3 moveAndSlide(const BoundingBox& box, const vec3& delta, const BoundingBox* obstacles, u32 obstacleCount) {
+  BoundingBox movedBox = box;
+  vec3 remaining = delta;
+  for(u32 iteration = 0; iteration < COLLISION_MAX_SLIDE_ITERATIONS; iteration++) {
+    if(remaining.x == 0.0f && remaining.y == 0.0f && remaining.z == 0.0f) { break; }
+
+    f32 closestHitTime = 1.0f;
+    vec3 closestHitNormal{};
+    for(u32 i = 0; i < obstacleCount; i++) {
+      f32 hitTime;
+      vec3 hitNormal;
+      if(sweepBoxes(movedBox, remaining, obstacles[i], &hitTime, &hitNormal) && hitTime < closestHitTime) {
+        closestHitTime = hitTime;
+        closestHitNormal = hitNormal;
+      }
+    }
+
+    if(closestHitTime == 1.0f) {
+      movedBox.min += remaining;
+      break;
+    }
+
+    // stop short of the surface, then slide the rest of the way along it
+    f32 remainingLength = magnitude(remaining);
+    f32 safeHitTime = Max(closestHitTime - (COLLISION_SKIN / remainingLength), 0.0f);
+    movedBox.min += remaining * safeHitTime;
+    remaining = remaining * (1.0f - safeHitTime);
+    remaining -= closestHitNormal * dot(remaining, closestHitNormal);
+  }
+  return movedBox.min - box.min;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+/*
+ * Instanced scene submission
+ * - Every mesh of every entity in a scene is recorded as a DrawInstance (model & normal matrix) tagged with the
+ *   program, mesh and mesh level of detail it needs.
+ * - Records are sorted by (program, mesh, level of detail). Each run of equal records becomes one DrawCommand, drawn with a single
+ *   instanced draw, and program/material state only changes between commands.
+ * - Instance data is stored in a texture buffer and fetched with firstDrawInstance + gl_InstanceID (see
+ *   DrawInstance.glsl), as GL 3.3 offers neither multi-draw indirect, gl_DrawID, nor shader storage buffers.
+ */
+
+#define MAX_DRAW_INSTANCES 1024
+
+struct DrawInstance {
+  mat4 model;
+  mat4 normal; // NOTE: upper-left 3x3 used
+};
+
+struct DrawCommand {
+  GLuint programId;
+  const Mesh* mesh;
+  const VertexAtt* vertexAtt; // NOTE: level of detail of mesh
+  const ShaderProgram* shader;
+  u32 firstInstance;
+  u32 instanceCount;
+};
+
+struct DrawRecord {
+  GLuint programId;
+  const Mesh* mesh;
+  const VertexAtt* vertexAtt; // NOTE: level of detail of mesh
+  const ShaderProgram* shader;
+  u32 instanceIndex; // NOTE: into recordedInstances
+};
+
+struct DrawList {
+  DrawRecord records[MAX_DRAW_INSTANCES];
+  DrawInstance recordedInstances[MAX_DRAW_INSTANCES];
+  u32 recordCount;
+  u32 droppedRecordCount; // NOTE: non-zero means meshes went undrawn, consider raising MAX_DRAW_INSTANCES
+
+  DrawInstance instances[MAX_DRAW_INSTANCES]; // NOTE: recordedInstances in command order
+  DrawCommand commands[MAX_DRAW_INSTANCES];
+  u32 commandCount;
+
+  TextureBuffer instancesBuffer;
+};
+
+static_assert(sizeof(DrawInstance) == DRAW_INSTANCE_TEXEL_COUNT * sizeof(vec4), "DrawInstance must match DRAW_INSTANCE_TEXEL_COUNT");
+
+void initDrawList(DrawList* drawList) {
+  initTextureBuffer(&drawList->instancesBuffer, GL_RGBA32F, sizeof(drawList->instances));
+}
+
+void deleteDrawList(DrawList* drawList) {
+  deleteTextureBuffer(&drawList->instancesBuffer);
+}
+
+void clearDrawList(DrawList* drawList) {
+  drawList->recordCount = 0;
+  drawList->droppedRecordCount = 0;
+  drawList->commandCount = 0;
+}
+
+// NOTE: Records every mesh of the model, each with the shader permutation it requires. Recording doesn't need the GL
+// context as long as those permutations have already been compiled (ex: by addNewEntity())
+// NOTE: instance.model is the model's transform, each mesh's own vertex transform is applied on top
+// NOTE: pixelsPerUnit is the on-screen size of one model space unit and selects each mesh's level of detail
+void recordModel(DrawList* drawList, const Model& model, ShaderProgram* shader, const DrawInstance& instance, f32 pixelsPerUnit) {
+  for(u32 meshIndex = 0; meshIndex < model.meshCount; ++meshIndex) {
+    if(drawList->recordCount == MAX_DRAW_INSTANCES) {
+      drawList->droppedRecordCount += model.meshCount - meshIndex;
+      return;
+    }
+    const Mesh* mesh = model.meshes + meshIndex;
+    u32 recordIndex = drawList->recordCount++;
+    drawList->records[recordIndex].programId = shaderPermutationId(shader, shaderPermutationFlags(mesh->textureData) | ShaderPermutation_DrawInstanced);
+    drawList->records[recordIndex].mesh = mesh;
+    drawList->records[recordIndex].vertexAtt = mesh->lods + selectMeshLod(*mesh, pixelsPerUnit);
+    drawList->records[recordIndex].shader = shader;
+    drawList->records[recordIndex].instanceIndex = recordIndex;
+    drawList->recordedInstances[recordIndex].model = meshModelMat(*mesh, instance.model);
+    drawList->recordedInstances[recordIndex].normal = instance.normal;
+  }
+}
+
+// NOTE: Groups records into commands, must be called after recording and before submitting
+void buildDrawCommands(DrawList* drawList) {
+  std::sort(drawList->records, drawList->records + drawList->recordCount, [](const DrawRecord& a, const DrawRecord& b) {
+    if(a.programId != b.programId) { return a.programId < b.programId; }
+    if(a.mesh != b.mesh) { return a.mesh < b.mesh; }
+    return a.vertexAtt < b.vertexAtt;
+  });
+
+  drawList->commandCount = 0;
+  DrawCommand* command = nullptr;
+  for(u32 recordIndex = 0; recordIndex < drawList->recordCount; ++recordIndex) {
+    const DrawRecord& record = drawList->records[recordIndex];
+    if(command == nullptr || command->programId != record.programId || command->vertexAtt != record.vertexAtt) {
+      command = drawList->commands + drawList->commandCount++;
+      command->programId = record.programId;
+      command->mesh = record.mesh;
+      command->vertexAtt = record.vertexAtt;
+      command->shader = record.shader;
+      command->firstInstance = recordIndex;
+      command->instanceCount = 0;
+    }
+    command->instanceCount++;
+    drawList->instances[recordIndex] = drawList->recordedInstances[record.instanceIndex];
+  }
+}
+
+// NOTE: The instance buffer is orphaned before each upload so a draw list can be submitted multiple times a frame without stalling
+void submitDrawList(const DrawList* drawList) {
+  if(drawList->commandCount == 0) { return; }
+
+  glBindBuffer(GL_TEXTURE_BUFFER, drawList->instancesBuffer.bufferId);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(drawList->instances), NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, drawList->recordCount * sizeof(DrawInstance), drawList->instances);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+  bindActiveTexture(drawInstancesActiveTextureIndex, drawList->instancesBuffer.textureId, GL_TEXTURE_BUFFER);
+
+  GLuint boundProgramId = 0;
+  GLuint boundAlbedoTextureId = TEXTURE_ID_NO_TEXTURE;
+  GLuint boundNormalTextureId = TEXTURE_ID_NO_TEXTURE;
+  for(u32 commandIndex = 0; commandIndex < drawList->commandCount; ++commandIndex) {
+    const DrawCommand* command = drawList->commands + commandIndex;
+    const TextureData& textureData = command->mesh->textureData;
+
+    if(command->programId != boundProgramId) {
+      glUseProgram(command->programId);
+      if(command->shader->noiseTextureId != TEXTURE_ID_NO_TEXTURE) {
+        bindActiveTextureSampler2d(noiseActiveTextureIndex, command->shader->noiseTextureId);
+        setSampler2D(command->programId, noiseTexUniformName, noiseActiveTextureIndex);
+      }
+      setSampler2D(command->programId, albedoTexUniformName, albedoActiveTextureIndex);
+      setSampler2D(command->programId, normalTexUniformName, normalActiveTextureIndex);
+      setSamplerBuffer(command->programId, drawInstancesTexUniformName, drawInstancesActiveTextureIndex);
+      setLightClusterSamplers(command->programId);
+      boundProgramId = command->programId;
+    }
+
+    if(textureData.baseColor.a != 0.0f) {
+      setUniform(command->programId, baseColorUniformName, textureData.baseColor.rgb);
+    }
+    if(textureData.albedoTextureId != TEXTURE_ID_NO_TEXTURE && textureData.albedoTextureId != boundAlbedoTextureId) {
+      bindActiveTextureSampler2d(albedoActiveTextureIndex, textureData.albedoTextureId);
+      boundAlbedoTextureId = textureData.albedoTextureId;
+    }
+    if(textureData.normalTextureId != TEXTURE_ID_NO_TEXTURE && textureData.normalTextureId != boundNormalTextureId) {
+      bindActiveTextureSampler2d(normalActiveTextureIndex, textureData.normalTextureId);
+      boundNormalTextureId = textureData.normalTextureId;
+    }
+
+    setUniform(command->programId, firstDrawInstanceUniformName, (s32)command->firstInstance);
+    drawTrianglesInstanced(command->vertexAtt, command->instanceCount);
+  }
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Flythrough paths for reproducible benchmarks
+ * - A path is a list of keyframes of the player's view position and camera angles at increasing times. Positions are
+ *   interpolated along a Catmull-Rom spline through the keyframes, angles linearly along their shortest turn.
+ * - Paths are sampled at a fixed simulated timestep, so every run visits the same poses on the same frames whatever
+ *   the frame rate. Portal crossings happen wherever the path crosses a portal, as they do while walking.
+ */
+
+#define FLYTHROUGH_RECORD_INTERVAL 0.25f // NOTE: seconds between keyframes while recording
+#define FLYTHROUGH_DEFAULT_TIMESTEP (1.0f / 60.0f)
+#define FLYTHROUGH_DEFAULT_WARMUP_FRAMES 60
+#define BENCHMARK_WORST_FRAME_COUNT 10
+
+struct FlythroughKeyframe {
+  f32 time; // NOTE: seconds
+  vec3 viewPosition;
+  f32 pitch; // NOTE: radians, as in Camera
+  f32 yaw;
+};
+
+struct FlythroughPose {
+  vec3 viewPosition;
+  f32 pitch;
+  f32 yaw;
+};
+
+// NOTE: Catmull-Rom segment from p1 to p2, t in [0, 1]
+internal_func vec3 catmullRom(const vec3& p0, const vec3& p1, const vec3& p2, const vec3& p3, f32 t) {
+  f32 t2 = t * t;
+  f32 t3 = t2 * t;
+  return 0.5f * ((2.0f * p1) + ((p2 - p0) * t) + (((2.0f * p0) - (5.0f * p1) + (4.0f * p2) - p3) * t2) +
+                 (((3.0f * p1) - p0 - (3.0f * p2) + p3) * t3));
+}
+
+/*
+ * Samples the path at time, clamped to the path's first and last keyframes
+ * Keyframe times must be increasing
+ */
+FlythroughPose sampleFlythrough(const FlythroughKeyframe* keyframes, u32 keyframeCount, f32 time) {
+  Assert(keyframeCount > 0);
+  FlythroughPose pose;
+  if(keyframeCount == 1 || time <= keyframes[0].time) {
+    pose = {keyframes[0].viewPosition, keyframes[0].pitch, keyframes[0].yaw};
+    return pose;
+  }
+  const FlythroughKeyframe& last = keyframes[keyframeCount - 1];
+  if(time >= last.time) {
+    pose = {last.viewPosition, last.pitch, last.yaw};
+    return pose;
+  }
+
+  u32 next = 1;
+  while(keyframes[next].time <= time) { next++; }
+  const FlythroughKeyframe& from = keyframes[next - 1];
+  const FlythroughKeyframe& to = keyframes[next];
+  // NOTE: the ends of the path repeat their keyframe as the outer control point
+  const vec3& before = keyframes[next > 1 ? next - 2 : next - 1].viewPosition;
+  const vec3& after = keyframes[next + 1 < keyframeCount ? next + 1 : next].viewPosition;
+  f32 t = (time - from.time) / (to.time - from.time);
+
+  pose.viewPosition = catmullRom(before, from.viewPosition, to.viewPosition, after, t);
+  pose.pitch = lerp(from.pitch, to.pitch, t);
+  pose.yaw = lerpAngle(from.yaw, to.yaw, t);
+  return pose;
+}
+
+struct FlythroughRecorder {
+  b32 recording;
+  f32 time; // NOTE: seconds since recording began
+  u32 startingSceneIndex;
+  std::vector<FlythroughKeyframe> keyframes;
+};
+
+// benchmark report
+struct BenchmarkFrame {
+  u32 frameIndex; // NOTE: counted from the first measured frame, warm up frames aren't measured
+  f32 cpuMs;
+  vec3 viewPosition;
+  u32 sceneIndex;
+};
+
+struct FrameTimeStats {
+  u32 frameCount;
+  f32 meanMs;
+  f32 p50Ms;
+  f32 p95Ms;
+  f32 p99Ms;
+  f32 maxMs;
+};
+
+struct BenchmarkReport {
+  FrameTimeStats cpu;
+  FrameTimeStats gpu; // NOTE: GPU results are read back frames late and may skip frames, so they aren't per frame
+  BenchmarkFrame worstFrames[BENCHMARK_WORST_FRAME_COUNT]; // NOTE: slowest first
+  u32 worstFrameCount;
+};
+
+FrameTimeStats frameTimeStats(const f32* frameMs, u32 frameCount) {
+  FrameTimeStats stats{};
+  if(frameCount == 0) { return stats; }
+  std::vector<f32> sortedMs(frameMs, frameMs + frameCount);
+  std::sort(sortedMs.begin(), sortedMs.end());
+  f64 totalMs = 0.0;
+  for(f32 ms : sortedMs) { totalMs += ms; }
+  auto percentile = [&sortedMs, frameCount](f32 fraction) {
+    u32 rank = (u32)ceilf(fraction * frameCount);
+    return sortedMs[rank > 0 ? rank - 1 : 0];
+  };
+  stats.frameCount = frameCount;
+  stats.meanMs = (f32)(totalMs / frameCount);
+  stats.p50Ms = percentile(0.50f);
+  stats.p95Ms = percentile(0.95f);
+  stats.p99Ms = percentile(0.99f);
+  stats.maxMs = sortedMs[frameCount - 1];
+  return stats;
+}
+
+BenchmarkReport buildBenchmarkReport(const std::vector<BenchmarkFrame>& frames, const std::vector<f32>& gpuFrameMs) {
+  BenchmarkReport report{};
+  std::vector<f32> cpuFrameMs;
+  cpuFrameMs.reserve(frames.size());
+  for(const BenchmarkFrame& frame : frames) { cpuFrameMs.push_back(frame.cpuMs); }
+  report.cpu = frameTimeStats(cpuFrameMs.data(), (u32)cpuFrameMs.size());
+  report.gpu = frameTimeStats(gpuFrameMs.data(), (u32)gpuFrameMs.size());
+
+  std::vector<BenchmarkFrame> slowestFrames = frames;
+  report.worstFrameCount = Min((u32)slowestFrames.size(), (u32)BENCHMARK_WORST_FRAME_COUNT);
+  std::partial_sort(slowestFrames.begin(), slowestFrames.begin() + report.worstFrameCount, slowestFrames.end(),
+                    [](const BenchmarkFrame& a, const BenchmarkFrame& b) { return a.cpuMs > b.cpuMs; });
+  std::copy(slowestFrames.begin(), slowestFrames.begin() + report.worstFrameCount, report.worstFrames);
+  return report;
+}
+
+internal_func void writeFrameTimeStatsJson(FILE* file, const char* name, const FrameTimeStats& stats) {
+  fprintf(file, "  \"%s\": {\"frames\": %d, \"meanMs\": %.3f, \"p50Ms\": %.3f, \"p95Ms\": %.3f, \"p99Ms\": %.3f, \"maxMs\": %.3f},\n",
+          name, stats.frameCount, stats.meanMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+}
+
+b32 writeBenchmarkReport(const BenchmarkReport& report, const char* flythroughFileName, const char* reportFileName) {
+  FILE* file = fopen(reportFileName, "w");
+  if(file == nullptr) { return false; }
+  fprintf(file, "{\n  \"flythrough\": \"");
+  for(const char* c = flythroughFileName; *c != '\0'; c++) {
+    if(*c == '"' || *c == '\\') { fputc('\\', file); }
+    fputc(*c, file);
+  }
+  fprintf(file, "\",\n");
+  writeFrameTimeStatsJson(file, "cpu", report.cpu);
+  writeFrameTimeStatsJson(file, "gpu", report.gpu);
+  fprintf(file, "  \"worstFrames\": [");
+  for(u32 i = 0; i < report.worstFrameCount; i++) {
+    const BenchmarkFrame& frame = report.worstFrames[i];
+    fprintf(file, "%s\n    {\"frame\": %d, \"cpuMs\": %.3f, \"scene\": %d, \"viewPosition\": [%.3f, %.3f, %.3f]}", i == 0 ? "" : ",",
+            frame.frameIndex, frame.cpuMs, frame.sceneIndex, frame.viewPosition.x, frame.viewPosition.y, frame.viewPosition.z);
+  }
+  fprintf(file, "\n  ]\n}\n");
+  fclose(file);
+  return true;
+}
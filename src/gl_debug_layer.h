@@ -0,0 +1,366 @@
+#pragma once
+
+/*
+ * GL debug layer
+ * - installGlDebugLayer() swaps the glad function pointers listed in gl_debug_call_list.inc for wrappers that count
+ *   every call per entry point per frame, then forward to the driver. It never skips or alters a call.
+ * - State changing calls are compared against a shadow of the GL state. A call that sets state to the value it
+ *   already had is counted as redundant.
+ * - Shadowed state starts unknown, so the first call setting any of it is never redundant. State changed outside
+ *   of the wrapped entry points is not seen; restoring it afterwards (as ImGui's renderer does) keeps the shadow valid.
+ * - Counts aren't synchronized. GL is only ever called by the one thread holding the context, which must also be the
+ *   thread ending the frame. Others read the counts from a copy of lastFrame.
+ * - Compiles out entirely when GL_DEBUG_LAYER_ON is 0, which it is by default in release (NDEBUG) builds.
+ */
+
+#ifndef GL_DEBUG_LAYER_ON
+#ifdef NDEBUG
+#define GL_DEBUG_LAYER_ON 0
+#else
+#define GL_DEBUG_LAYER_ON 1
+#endif
+#endif
+
+#if GL_DEBUG_LAYER_ON
+
+#define GL_SHADOW_UNKNOWN U32_MAX
+#define GL_SHADOW_TEXTURE_UNITS 16
+#define GL_SHADOW_UNIFORM_BUFFER_BINDINGS 16
+
+enum GlDebugCallType {
+#define GlCall(name, params, args) GlDebugCall_##name,
+#define GlStateCall(name, params, args) GlDebugCall_##name,
+#include "gl_debug_call_list.inc"
+#undef GlCall
+#undef GlStateCall
+  GlDebugCall_Count
+};
+
+const char* glDebugCallNames[] = {
+#define GlCall(name, params, args) "gl" #name,
+#define GlStateCall(name, params, args) "gl" #name,
+#include "gl_debug_call_list.inc"
+#undef GlCall
+#undef GlStateCall
+};
+
+enum GlShadowBufferTarget {
+  GlShadowBuffer_Array, GlShadowBuffer_ElementArray, GlShadowBuffer_Uniform, GlShadowBuffer_Texture,
+  GlShadowBuffer_CopyRead, GlShadowBuffer_CopyWrite,
+  GlShadowBuffer_Count
+};
+
+enum GlShadowTextureTarget {
+  GlShadowTexture_2D, GlShadowTexture_CubeMap, GlShadowTexture_Buffer,
+  GlShadowTexture_Count
+};
+
+enum GlShadowCapability {
+  GlShadowCapability_DepthTest, GlShadowCapability_CullFace, GlShadowCapability_StencilTest, GlShadowCapability_Blend,
+  GlShadowCapability_ScissorTest, GlShadowCapability_Multisample, GlShadowCapability_FramebufferSRGB,
+  GlShadowCapability_Count
+};
+
+// NOTE: Every field is initialized to all bits set, a value GL never holds (NaN for floats) so it reads as unknown
+struct GlShadowState {
+  GLuint buffers[GlShadowBuffer_Count];
+  struct {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+  } uniformBufferBindings[GL_SHADOW_UNIFORM_BUFFER_BINDINGS];
+  GLuint vertexArray;
+  GLuint program;
+  GLuint activeTextureUnit;
+  GLuint textures[GL_SHADOW_TEXTURE_UNITS][GlShadowTexture_Count];
+  GLuint drawFramebuffer;
+  GLuint readFramebuffer;
+  GLuint capabilities[GlShadowCapability_Count]; // NOTE: GL_TRUE/GL_FALSE
+  GLenum polygonMode;
+  GLuint stencilMask;
+  GLenum stencilFunc;
+  GLint stencilRef;
+  GLuint stencilFuncMask;
+  GLenum stencilFail, stencilDepthFail, stencilDepthPass;
+  GLenum depthFunc;
+  GLenum cullFace;
+  GLenum frontFace;
+  GLfloat lineWidth;
+};
+
+struct GlDebugFrameCounts {
+  u32 callCounts[GlDebugCall_Count];
+  u32 redundantCounts[GlDebugCall_Count];
+  u32 callCount;
+  u32 redundantCount;
+};
+
+struct GlDebugLayer {
+  b32 installed;
+  GlShadowState shadow;
+  u32 callCounts[GlDebugCall_Count];
+  u32 redundantCounts[GlDebugCall_Count];
+  GlDebugFrameCounts lastFrame; // NOTE: the last frame ended
+};
+
+global_variable GlDebugLayer globalGlDebugLayer;
+
+// NOTE: returns true if the shadowed value already matched
+internal_func b32 glShadowSet(GLuint* shadow, GLuint value) {
+  b32 redundant = *shadow == value;
+  *shadow = value;
+  return redundant;
+}
+
+internal_func b32 glShadowSet(GLint* shadow, GLint value) {
+  b32 redundant = *shadow == value;
+  *shadow = value;
+  return redundant;
+}
+
+internal_func b32 glShadowSet(GLfloat* shadow, GLfloat value) {
+  b32 redundant = *shadow == value; // NOTE: NaN (unknown) never compares equal
+  *shadow = value;
+  return redundant;
+}
+
+internal_func u32 glShadowBufferTarget(GLenum target) {
+  switch(target) {
+    case GL_ARRAY_BUFFER: return GlShadowBuffer_Array;
+    case GL_ELEMENT_ARRAY_BUFFER: return GlShadowBuffer_ElementArray;
+    case GL_UNIFORM_BUFFER: return GlShadowBuffer_Uniform;
+    case GL_TEXTURE_BUFFER: return GlShadowBuffer_Texture;
+    case GL_COPY_READ_BUFFER: return GlShadowBuffer_CopyRead;
+    case GL_COPY_WRITE_BUFFER: return GlShadowBuffer_CopyWrite;
+    default: return GlShadowBuffer_Count;
+  }
+}
+
+internal_func u32 glShadowTextureTarget(GLenum target) {
+  switch(target) {
+    case GL_TEXTURE_2D: return GlShadowTexture_2D;
+    case GL_TEXTURE_CUBE_MAP: return GlShadowTexture_CubeMap;
+    case GL_TEXTURE_BUFFER: return GlShadowTexture_Buffer;
+    default: return GlShadowTexture_Count;
+  }
+}
+
+internal_func u32 glShadowCapability(GLenum cap) {
+  switch(cap) {
+    case GL_DEPTH_TEST: return GlShadowCapability_DepthTest;
+    case GL_CULL_FACE: return GlShadowCapability_CullFace;
+    case GL_STENCIL_TEST: return GlShadowCapability_StencilTest;
+    case GL_BLEND: return GlShadowCapability_Blend;
+    case GL_SCISSOR_TEST: return GlShadowCapability_ScissorTest;
+    case GL_MULTISAMPLE: return GlShadowCapability_Multisample;
+    case GL_FRAMEBUFFER_SRGB: return GlShadowCapability_FramebufferSRGB;
+    default: return GlShadowCapability_Count;
+  }
+}
+
+// NOTE: Deleting a bound object reverts its binding to 0
+internal_func void glShadowUnbindDeleted(GLuint* binding, GLsizei n, const GLuint* names) {
+  for(GLsizei nameIndex = 0; nameIndex < n; nameIndex++) {
+    if(names[nameIndex] != 0 && *binding == names[nameIndex]) { *binding = 0; }
+  }
+}
+
+// NOTE: Shadow state updates for GlStateCall entry points, each returns true if the call was redundant
+internal_func b32 glShadowBindBuffer(GLenum target, GLuint buffer) {
+  u32 bufferTarget = glShadowBufferTarget(target);
+  if(bufferTarget == GlShadowBuffer_Count) { return false; }
+  return glShadowSet(globalGlDebugLayer.shadow.buffers + bufferTarget, buffer);
+}
+
+internal_func b32 glShadowBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  // NOTE: binding an indexed target also binds the buffer to the generic target
+  u32 bufferTarget = glShadowBufferTarget(target);
+  if(bufferTarget != GlShadowBuffer_Count) { shadow->buffers[bufferTarget] = buffer; }
+  if(target != GL_UNIFORM_BUFFER || index >= GL_SHADOW_UNIFORM_BUFFER_BINDINGS) { return false; }
+  auto* binding = shadow->uniformBufferBindings + index;
+  b32 redundant = binding->buffer == buffer && binding->offset == offset && binding->size == size;
+  binding->buffer = buffer;
+  binding->offset = offset;
+  binding->size = size;
+  return redundant;
+}
+
+internal_func b32 glShadowDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  for(u32 bufferTarget = 0; bufferTarget < GlShadowBuffer_Count; bufferTarget++) {
+    glShadowUnbindDeleted(shadow->buffers + bufferTarget, n, buffers);
+  }
+  for(u32 index = 0; index < GL_SHADOW_UNIFORM_BUFFER_BINDINGS; index++) {
+    glShadowUnbindDeleted(&shadow->uniformBufferBindings[index].buffer, n, buffers);
+  }
+  return false;
+}
+
+internal_func b32 glShadowBindVertexArray(GLuint array) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  if(glShadowSet(&shadow->vertexArray, array)) { return true; }
+  // NOTE: the element array buffer binding belongs to the vertex array
+  shadow->buffers[GlShadowBuffer_ElementArray] = GL_SHADOW_UNKNOWN;
+  return false;
+}
+
+internal_func b32 glShadowDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  GLuint previousVertexArray = shadow->vertexArray;
+  glShadowUnbindDeleted(&shadow->vertexArray, n, arrays);
+  if(shadow->vertexArray != previousVertexArray) { shadow->buffers[GlShadowBuffer_ElementArray] = 0; }
+  return false;
+}
+
+internal_func b32 glShadowUseProgram(GLuint program) {
+  return glShadowSet(&globalGlDebugLayer.shadow.program, program);
+}
+
+internal_func b32 glShadowActiveTexture(GLenum texture) {
+  return glShadowSet(&globalGlDebugLayer.shadow.activeTextureUnit, texture - GL_TEXTURE0);
+}
+
+internal_func b32 glShadowBindTexture(GLenum target, GLuint texture) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  u32 textureTarget = glShadowTextureTarget(target);
+  if(shadow->activeTextureUnit >= GL_SHADOW_TEXTURE_UNITS || textureTarget == GlShadowTexture_Count) { return false; }
+  return glShadowSet(&shadow->textures[shadow->activeTextureUnit][textureTarget], texture);
+}
+
+internal_func b32 glShadowDeleteTextures(GLsizei n, const GLuint* textures) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  for(u32 unit = 0; unit < GL_SHADOW_TEXTURE_UNITS; unit++) {
+    for(u32 textureTarget = 0; textureTarget < GlShadowTexture_Count; textureTarget++) {
+      glShadowUnbindDeleted(&shadow->textures[unit][textureTarget], n, textures);
+    }
+  }
+  return false;
+}
+
+internal_func b32 glShadowBindFramebuffer(GLenum target, GLuint framebuffer) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  switch(target) {
+    case GL_DRAW_FRAMEBUFFER: return glShadowSet(&shadow->drawFramebuffer, framebuffer);
+    case GL_READ_FRAMEBUFFER: return glShadowSet(&shadow->readFramebuffer, framebuffer);
+    default: {
+      b32 redundantDraw = glShadowSet(&shadow->drawFramebuffer, framebuffer);
+      b32 redundantRead = glShadowSet(&shadow->readFramebuffer, framebuffer);
+      return redundantDraw && redundantRead;
+    }
+  }
+}
+
+internal_func b32 glShadowDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  glShadowUnbindDeleted(&shadow->drawFramebuffer, n, framebuffers);
+  glShadowUnbindDeleted(&shadow->readFramebuffer, n, framebuffers);
+  return false;
+}
+
+internal_func b32 glShadowEnable(GLenum cap) {
+  u32 capability = glShadowCapability(cap);
+  if(capability == GlShadowCapability_Count) { return false; }
+  return glShadowSet(globalGlDebugLayer.shadow.capabilities + capability, (GLuint)GL_TRUE);
+}
+
+internal_func b32 glShadowDisable(GLenum cap) {
+  u32 capability = glShadowCapability(cap);
+  if(capability == GlShadowCapability_Count) { return false; }
+  return glShadowSet(globalGlDebugLayer.shadow.capabilities + capability, (GLuint)GL_FALSE);
+}
+
+internal_func b32 glShadowPolygonMode(GLenum face, GLenum mode) {
+  // NOTE: core profile only accepts GL_FRONT_AND_BACK
+  if(face != GL_FRONT_AND_BACK) { return false; }
+  return glShadowSet(&globalGlDebugLayer.shadow.polygonMode, mode);
+}
+
+internal_func b32 glShadowStencilMask(GLuint mask) {
+  return glShadowSet(&globalGlDebugLayer.shadow.stencilMask, mask);
+}
+
+internal_func b32 glShadowStencilFunc(GLenum func, GLint ref, GLuint mask) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  b32 redundantFunc = glShadowSet(&shadow->stencilFunc, func);
+  b32 redundantRef = glShadowSet(&shadow->stencilRef, ref);
+  b32 redundantMask = glShadowSet(&shadow->stencilFuncMask, mask);
+  return redundantFunc && redundantRef && redundantMask;
+}
+
+internal_func b32 glShadowStencilOp(GLenum fail, GLenum zfail, GLenum zpass) {
+  GlShadowState* shadow = &globalGlDebugLayer.shadow;
+  b32 redundantFail = glShadowSet(&shadow->stencilFail, fail);
+  b32 redundantDepthFail = glShadowSet(&shadow->stencilDepthFail, zfail);
+  b32 redundantDepthPass = glShadowSet(&shadow->stencilDepthPass, zpass);
+  return redundantFail && redundantDepthFail && redundantDepthPass;
+}
+
+internal_func b32 glShadowDepthFunc(GLenum func) {
+  return glShadowSet(&globalGlDebugLayer.shadow.depthFunc, func);
+}
+
+internal_func b32 glShadowCullFace(GLenum mode) {
+  return glShadowSet(&globalGlDebugLayer.shadow.cullFace, mode);
+}
+
+internal_func b32 glShadowFrontFace(GLenum mode) {
+  return glShadowSet(&globalGlDebugLayer.shadow.frontFace, mode);
+}
+
+internal_func b32 glShadowLineWidth(GLfloat width) {
+  return glShadowSet(&globalGlDebugLayer.shadow.lineWidth, width);
+}
+
+// NOTE: The wrappers forward to the saved driver pointers, calling through glad's names would call the wrapper again
+#define GlCall(name, params, args) \
+  global_variable decltype(glad_gl##name) glDebugDriver##name; \
+  internal_func void APIENTRY glDebugWrapper##name params { \
+    globalGlDebugLayer.callCounts[GlDebugCall_##name]++; \
+    glDebugDriver##name args; \
+  }
+#define GlStateCall(name, params, args) \
+  global_variable decltype(glad_gl##name) glDebugDriver##name; \
+  internal_func void APIENTRY glDebugWrapper##name params { \
+    globalGlDebugLayer.callCounts[GlDebugCall_##name]++; \
+    if(glShadow##name args) { globalGlDebugLayer.redundantCounts[GlDebugCall_##name]++; } \
+    glDebugDriver##name args; \
+  }
+#include "gl_debug_call_list.inc"
+#undef GlCall
+#undef GlStateCall
+
+// NOTE: Call once, directly after glad has loaded the GL function pointers and before any other GL call
+void installGlDebugLayer() {
+  Assert(!globalGlDebugLayer.installed);
+  memset(&globalGlDebugLayer.shadow, 0xFF, sizeof(globalGlDebugLayer.shadow));
+#define GlCall(name, params, args) \
+  glDebugDriver##name = glad_gl##name; \
+  glad_gl##name = glDebugWrapper##name;
+#define GlStateCall(name, params, args) GlCall(name, params, args)
+#include "gl_debug_call_list.inc"
+#undef GlCall
+#undef GlStateCall
+  globalGlDebugLayer.installed = true;
+}
+
+void glDebugLayerEndFrame() {
+  GlDebugLayer* layer = &globalGlDebugLayer;
+  layer->lastFrame.callCount = 0;
+  layer->lastFrame.redundantCount = 0;
+  for(u32 callType = 0; callType < GlDebugCall_Count; callType++) {
+    layer->lastFrame.callCounts[callType] = layer->callCounts[callType];
+    layer->lastFrame.redundantCounts[callType] = layer->redundantCounts[callType];
+    layer->lastFrame.callCount += layer->callCounts[callType];
+    layer->lastFrame.redundantCount += layer->redundantCounts[callType];
+  }
+  memset(layer->callCounts, 0, sizeof(layer->callCounts));
+  memset(layer->redundantCounts, 0, sizeof(layer->redundantCounts));
+}
+
+#else
+
+inline void installGlDebugLayer() {}
+inline void glDebugLayerEndFrame() {}
+
+#endif
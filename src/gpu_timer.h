@@ -0,0 +1,140 @@
+#pragma once
+
+/*
+ * GPU pass timing with GL_TIMESTAMP queries
+ * - Every pass writes a timestamp when it begins and when it ends, so passes may nest (GL_TIME_ELAPSED queries can't).
+ * - Each frame's queries are only read back GPU_TIMER_FRAMES_IN_FLIGHT frames later, once they're available. If they
+ *   still aren't, that frame isn't timed rather than waiting on the GPU.
+ * - Pass 0 of every frame spans the whole frame.
+ */
+
+#define GPU_TIMER_MAX_PASSES 32
+#define GPU_TIMER_FRAMES_IN_FLIGHT 4
+#define GPU_TIMER_HISTORY_FRAMES 128
+#define GPU_TIMER_NAME_SIZE 32
+#define GPU_TIMER_NO_PASS U32_MAX
+
+#define GPU_TIMER_CONCAT_INNER(a, b) a##b
+#define GPU_TIMER_CONCAT(a, b) GPU_TIMER_CONCAT_INNER(a, b)
+
+struct GpuTimerPass {
+  char name[GPU_TIMER_NAME_SIZE]; // NOTE: copied, names like scene titles may not outlive the queries
+  u32 depth;
+};
+
+struct GpuTimerFrame {
+  GLuint queries[GPU_TIMER_MAX_PASSES * 2]; // NOTE: begin & end timestamp of each pass
+  GpuTimerPass passes[GPU_TIMER_MAX_PASSES];
+  u32 passCount;
+  b32 pending; // NOTE: queries issued and not yet read back
+};
+
+struct GpuTimers {
+  GpuTimerFrame frames[GPU_TIMER_FRAMES_IN_FLIGHT];
+  u32 currentFrame;
+  b32 recording; // NOTE: false while the current frame's queries are still in flight
+  u32 depth;
+
+  // NOTE: the latest frame read back
+  GpuTimerPass resultPasses[GPU_TIMER_MAX_PASSES];
+  f32 resultMs[GPU_TIMER_MAX_PASSES];
+  GLuint64 resultBeginNs[GPU_TIMER_MAX_PASSES]; // NOTE: raw GL_TIMESTAMP values
+  GLuint64 resultEndNs[GPU_TIMER_MAX_PASSES];
+  u32 resultPassCount;
+  u32 resultFrameCount; // NOTE: frames read back so far, changes whenever the results do
+  u32 skippedFrameCount;
+
+  f32 gpuFrameMsHistory[GPU_TIMER_HISTORY_FRAMES];
+  u32 gpuFrameMsHistoryNext;
+  f32 cpuFrameMsHistory[GPU_TIMER_HISTORY_FRAMES];
+  u32 cpuFrameMsHistoryNext;
+};
+
+void initGpuTimers(GpuTimers* timers) {
+  *timers = {};
+  for(u32 frameIndex = 0; frameIndex < GPU_TIMER_FRAMES_IN_FLIGHT; frameIndex++) {
+    glGenQueries(ArrayCount(timers->frames[frameIndex].queries), timers->frames[frameIndex].queries);
+  }
+}
+
+void deleteGpuTimers(GpuTimers* timers) {
+  for(u32 frameIndex = 0; frameIndex < GPU_TIMER_FRAMES_IN_FLIGHT; frameIndex++) {
+    glDeleteQueries(ArrayCount(timers->frames[frameIndex].queries), timers->frames[frameIndex].queries);
+  }
+  *timers = {};
+}
+
+internal_func void readBackGpuTimerFrame(GpuTimers* timers, GpuTimerFrame* frame) {
+  for(u32 passIndex = 0; passIndex < frame->passCount; passIndex++) {
+    GLuint64 begin, end;
+    glGetQueryObjectui64v(frame->queries[passIndex * 2], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(frame->queries[(passIndex * 2) + 1], GL_QUERY_RESULT, &end);
+    timers->resultPasses[passIndex] = frame->passes[passIndex];
+    timers->resultBeginNs[passIndex] = begin;
+    timers->resultEndNs[passIndex] = end;
+    timers->resultMs[passIndex] = end > begin ? (f32)((end - begin) / 1000000.0) : 0.0f; // NOTE: nanoseconds
+  }
+  timers->resultPassCount = frame->passCount;
+  timers->resultFrameCount++;
+  timers->gpuFrameMsHistory[timers->gpuFrameMsHistoryNext] = timers->resultMs[0];
+  timers->gpuFrameMsHistoryNext = (timers->gpuFrameMsHistoryNext + 1) % GPU_TIMER_HISTORY_FRAMES;
+}
+
+u32 beginGpuPass(GpuTimers* timers, const char* name) {
+  GpuTimerFrame* frame = timers->frames + timers->currentFrame;
+  if(!timers->recording || frame->passCount == GPU_TIMER_MAX_PASSES) { return GPU_TIMER_NO_PASS; }
+  u32 passIndex = frame->passCount++;
+  snprintf(frame->passes[passIndex].name, GPU_TIMER_NAME_SIZE, "%s", name);
+  frame->passes[passIndex].depth = timers->depth++;
+  glQueryCounter(frame->queries[passIndex * 2], GL_TIMESTAMP);
+  return passIndex;
+}
+
+void endGpuPass(GpuTimers* timers, u32 passIndex) {
+  if(passIndex == GPU_TIMER_NO_PASS) { return; }
+  timers->depth--;
+  glQueryCounter(timers->frames[timers->currentFrame].queries[(passIndex * 2) + 1], GL_TIMESTAMP);
+}
+
+// NOTE: Reads back the oldest frame in flight if its results are ready, then starts timing the new frame
+void beginGpuTimerFrame(GpuTimers* timers) {
+  GpuTimerFrame* frame = timers->frames + timers->currentFrame;
+  if(frame->pending) {
+    GLint available = GL_FALSE;
+    // NOTE: queries complete in the order issued, the end of pass 0 is issued last
+    glGetQueryObjectiv(frame->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if(available) {
+      readBackGpuTimerFrame(timers, frame);
+      frame->pending = false;
+    }
+  }
+
+  timers->recording = !frame->pending;
+  if(!timers->recording) {
+    timers->skippedFrameCount++;
+    return;
+  }
+  frame->passCount = 0;
+  timers->depth = 0;
+  beginGpuPass(timers, "Frame");
+}
+
+void endGpuTimerFrame(GpuTimers* timers, f32 cpuFrameMs) {
+  timers->cpuFrameMsHistory[timers->cpuFrameMsHistoryNext] = cpuFrameMs;
+  timers->cpuFrameMsHistoryNext = (timers->cpuFrameMsHistoryNext + 1) % GPU_TIMER_HISTORY_FRAMES;
+  if(!timers->recording) { return; }
+  endGpuPass(timers, 0);
+  timers->frames[timers->currentFrame].pending = true;
+  timers->currentFrame = (timers->currentFrame + 1) % GPU_TIMER_FRAMES_IN_FLIGHT;
+}
+
+// NOTE: Times the rest of the enclosing scope as a GPU pass
+struct GpuPassScope {
+  GpuTimers* timers;
+  u32 passIndex;
+
+  GpuPassScope(GpuTimers* timers, const char* name): timers(timers), passIndex(beginGpuPass(timers, name)) {}
+  ~GpuPassScope() { endGpuPass(timers, passIndex); }
+};
+
+#define GPU_PASS_SCOPE(timers, name) GpuPassScope GPU_TIMER_CONCAT(gpuPassScope, __LINE__)(timers, name)
@@ -1,14 +1,54 @@
-internal_func void setKeyState(InputType keyboardInput, s32 glfwKey, GLFWwindow* window);
-internal_func void setMouseState(InputType mouseInput, s32 glfwKey, GLFWwindow* window);
+#include <atomic>
+
 internal_func void setControllerState(InputType controllerInput, u16 xInputButtonFlag, s16 gamepadFlags);
 internal_func void loadXInput();
 
+internal_func void glfw_key_callback(GLFWwindow* window, s32 key, s32 scancode, s32 action, s32 mods);
+internal_func void glfw_mouse_button_callback(GLFWwindow* window, s32 button, s32 action, s32 mods);
+internal_func void glfw_cursor_position_callback(GLFWwindow* window, f64 x, f64 y);
 internal_func void glfw_mouse_scroll_callback(GLFWwindow* window, f64 xOffset, f64 yOffset);
 internal_func void glfw_framebuffer_size_callback(GLFWwindow* window, s32 width, s32 height);
 
+/*
+ * Keyboard and mouse input arrive as timestamped events from GLFW callbacks, pushed onto a lock free single producer,
+ * single consumer queue and drained once per frame by loadInputStateForFrame(). A frame's input states are derived
+ * from the events, so a press released within the same frame is still seen. Each mouse movement in a frame is kept.
+ * XInput has no events and is still polled, but a disconnected controller is only checked for periodically.
+ */
+#define INPUT_EVENT_QUEUE_CAPACITY 1024 // NOTE: must be a power of two
+#define INPUT_MAX_MOUSE_MOTION_SAMPLES 64
+#define INPUT_CONTROLLER_RECONNECT_SECONDS 1.0 // NOTE: XInputGetState() is slow for controllers that aren't connected
+
+enum InputEventType {
+  InputEvent_Button,
+  InputEvent_CursorPosition,
+  InputEvent_Scroll
+};
+
+struct InputEvent {
+  u64 ticks;
+  InputEventType type;
+  InputType inputType; // NOTE: button events only
+  b32 pressed; // NOTE: button events only
+  vec2_f64 value; // NOTE: cursor position or scroll offset
+};
+
+global_variable struct {
+  InputEvent events[INPUT_EVENT_QUEUE_CAPACITY];
+  std::atomic<u32> writeIndex; // NOTE: only written by the producer (callbacks)
+  std::atomic<u32> readIndex; // NOTE: only written by the consumer (loadInputStateForFrame)
+  u32 droppedEventCount; // NOTE: only accessed by the producer (callbacks), which run on the consumer's thread in glfwPollEvents()
+} globalInputEventQueue{};
+
+global_variable InputType globalGlfwKeyInputTypes[GLFW_KEY_LAST + 1]; // NOTE: InputType_NumTypes for keys without one
+global_variable b32 globalButtonsDown[InputType_NumTypes] = {}; // NOTE: as of the latest button event
+global_variable MouseMotionSample globalMouseMotionSamples[INPUT_MAX_MOUSE_MOTION_SAMPLES];
+global_variable u32 globalMouseMotionSampleCount = 0;
+global_variable b32 globalControllerConnected = true;
+global_variable u64 globalControllerLastCheckTicks = 0;
+
 global_variable b32 globalWindowModeChangeTossNextInput = false;
 global_variable vec2_u32 globalWindowExtent = vec2_u32{0, 0 };
-global_variable vec2_f64 globalMouseScroll = vec2_f64{0.0, 0.0 };
 global_variable vec2_f64 globaleMousePosition = {0.0, 0.0 };
 global_variable vec2_f64 globalMouseDelta = {0.0, 0.0 };
 global_variable vec2_s16 globalAnalogStickLeft = {0, 0 };
@@ -22,6 +62,31 @@ global_variable windows_size_callback* globalWindowSizeCallback = NULL;
 // indices of this array will be accessed through InputType enums
 global_variable InputState inputStates[InputType_NumTypes] = {};
 
+enum InputLogMode {
+  InputLogMode_Off,
+  InputLogMode_Recording,
+  InputLogMode_Replaying
+};
+
+// NOTE: Written to the log as is every frame, followed by changedInputCount pairs of (InputType, InputState) bytes
+struct InputLogFrame {
+  f32 frameDelta;
+  f32 mouseScrollY;
+  vec2_f64 mousePosition;
+  vec2_f64 mouseDelta;
+  vec2_s16 analogStickLeft;
+  vec2_s16 analogStickRight;
+  s8 triggerLeftValue;
+  s8 triggerRightValue;
+  u8 changedInputCount;
+};
+
+global_variable struct {
+  InputLogMode mode;
+  FILE* file;
+  InputState loggedStates[InputType_NumTypes]; // NOTE: input states as of the last logged frame
+} globalInputLog = {};
+
 // NOTE: Casey Muratori's efficient way of handling function pointers, Handmade Hero episode 6 @ 22:06 & 1:00:21
 // NOTE: Allows us to quickly change the function parameters & return type in one place and cascade throughout the rest
 // NOTE: of the code if need be.
@@ -36,6 +101,14 @@ global_variable x_input_get_state* XInputGetState_ = XInputGetStateStub; // Use
 
 void initializeInput(GLFWwindow* window)
 {
+  for(u32 key = 0; key < ArrayCount(globalGlfwKeyInputTypes); key++) { globalGlfwKeyInputTypes[key] = InputType_NumTypes; }
+#define KeyboardInput(name, input_code) globalGlfwKeyInputTypes[input_code] = KeyboardInput_##name;
+#include "keyboard_input_list.inc"
+#undef KeyboardInput
+
+  glfwSetKeyCallback(window, glfw_key_callback);
+  glfwSetMouseButtonCallback(window, glfw_mouse_button_callback);
+  glfwSetCursorPosCallback(window, glfw_cursor_position_callback);
   glfwSetScrollCallback(window, glfw_mouse_scroll_callback);
   glfwSetFramebufferSizeCallback(window, glfw_framebuffer_size_callback);
 
@@ -44,6 +117,7 @@ void initializeInput(GLFWwindow* window)
   framebufferWidth = Max(0, framebufferWidth);
   framebufferHeight = Max(0, framebufferHeight);
   globalWindowExtent = vec2_u32{(u32)framebufferWidth, (u32)framebufferHeight};
+  glfwGetCursorPos(window, &globaleMousePosition.x, &globaleMousePosition.y);
 
   loadXInput();
 }
@@ -78,6 +152,15 @@ vec2_f64 getMouseDelta() {
   return globalMouseDelta;
 }
 
+u32 getMouseMotionSamples(Out const MouseMotionSample** samples) {
+  *samples = globalMouseMotionSamples;
+  return globalMouseMotionSampleCount;
+}
+
+u32 getDroppedInputEventCount() {
+  return globalInputEventQueue.droppedEventCount;
+}
+
 f32 getMouseScrollY() {
   return globalMouseScrollY;
 }
@@ -129,16 +212,46 @@ void setInputState(InputType inputType, b32 inputIsCurrentlyActive) {
     }
 }
 
-void setKeyState(InputType keyboardInput, s32 glfwKey, GLFWwindow* window)
-{
-    b32 keyIsCurrentlyActive = glfwGetKey(window, glfwKey) == GLFW_PRESS;
-    setInputState(keyboardInput, keyIsCurrentlyActive);
+// NOTE: Called by the producer only, events are dropped if the queue is full
+internal_func void pushInputEvent(const InputEvent& event) {
+  u32 writeIndex = globalInputEventQueue.writeIndex.load(std::memory_order_relaxed);
+  u32 readIndex = globalInputEventQueue.readIndex.load(std::memory_order_acquire);
+  if(writeIndex - readIndex == INPUT_EVENT_QUEUE_CAPACITY) {
+    globalInputEventQueue.droppedEventCount++;
+    return;
+  }
+  globalInputEventQueue.events[writeIndex & (INPUT_EVENT_QUEUE_CAPACITY - 1)] = event;
+  globalInputEventQueue.writeIndex.store(writeIndex + 1, std::memory_order_release);
 }
 
-void setMouseState(InputType mouseInput, s32 glfwKey, GLFWwindow* window)
-{
-    b32 mouseInputIsCurrentlyActive = glfwGetMouseButton(window, glfwKey) == GLFW_PRESS;
-    setInputState(mouseInput, mouseInputIsCurrentlyActive);
+// NOTE: Called by the consumer only
+internal_func b32 popInputEvent(InputEvent* event) {
+  u32 readIndex = globalInputEventQueue.readIndex.load(std::memory_order_relaxed);
+  u32 writeIndex = globalInputEventQueue.writeIndex.load(std::memory_order_acquire);
+  if(readIndex == writeIndex) { return false; }
+  *event = globalInputEventQueue.events[readIndex & (INPUT_EVENT_QUEUE_CAPACITY - 1)];
+  globalInputEventQueue.readIndex.store(readIndex + 1, std::memory_order_release);
+  return true;
+}
+
+internal_func void pushButtonEvent(InputType inputType, s32 action) {
+  if(action == GLFW_REPEAT) { return; }
+  InputEvent event{};
+  event.ticks = getTicks();
+  event.type = InputEvent_Button;
+  event.inputType = inputType;
+  event.pressed = action == GLFW_PRESS;
+  pushInputEvent(event);
+}
+
+internal_func void addMouseMotionSample(u64 ticks, vec2_f64 delta) {
+  if(globalMouseMotionSampleCount == INPUT_MAX_MOUSE_MOTION_SAMPLES) { // NOTE: merge into the last sample
+    MouseMotionSample* lastSample = globalMouseMotionSamples + (INPUT_MAX_MOUSE_MOTION_SAMPLES - 1);
+    lastSample->ticks = ticks;
+    lastSample->delta = {lastSample->delta.x + delta.x, lastSample->delta.y + delta.y};
+    return;
+  }
+  globalMouseMotionSamples[globalMouseMotionSampleCount++] = {ticks, delta};
 }
 
 void setControllerState(InputType controllerInput, u16 xInputButtonFlag, s16 gamepadFlags)
@@ -147,45 +260,192 @@ void setControllerState(InputType controllerInput, u16 xInputButtonFlag, s16 gam
     setInputState(controllerInput, controllerInputIsCurrentlyActive);
 }
 
-void loadInputStateForFrame(GLFWwindow* window) {
-  // keyboard state
-#define KeyboardInput(name, input_code) setKeyState(KeyboardInput_##name, input_code, window);
+internal_func void writeInputLogFrame(f32 frameDelta) {
+  static_assert(InputType_NumTypes <= 256, "Input types are logged as bytes");
+  u8 changedInputs[InputType_NumTypes * 2];
+  u32 changedInputCount = 0;
+  for(u32 inputType = 0; inputType < InputType_NumTypes; inputType++) {
+    if(inputStates[inputType] == globalInputLog.loggedStates[inputType]) { continue; }
+    changedInputs[changedInputCount * 2] = (u8)inputType;
+    changedInputs[(changedInputCount * 2) + 1] = (u8)inputStates[inputType];
+    globalInputLog.loggedStates[inputType] = inputStates[inputType];
+    changedInputCount++;
+  }
+
+  InputLogFrame frame;
+  frame.frameDelta = frameDelta;
+  frame.mouseScrollY = globalMouseScrollY;
+  frame.mousePosition = globaleMousePosition;
+  frame.mouseDelta = globalMouseDelta;
+  frame.analogStickLeft = globalAnalogStickLeft;
+  frame.analogStickRight = globalAnalogStickRight;
+  frame.triggerLeftValue = globalController1TriggerLeftValue;
+  frame.triggerRightValue = globalController1TriggerRightValue;
+  frame.changedInputCount = (u8)changedInputCount;
+  fwrite(&frame, sizeof(frame), 1, globalInputLog.file);
+  fwrite(changedInputs, 2, changedInputCount, globalInputLog.file);
+}
+
+// NOTE: returns false at the end of the log
+internal_func b32 readInputLogFrame(f32* frameDelta) {
+  InputLogFrame frame;
+  u8 changedInputs[InputType_NumTypes * 2];
+  if(fread(&frame, sizeof(frame), 1, globalInputLog.file) != 1 || frame.changedInputCount > InputType_NumTypes ||
+     fread(changedInputs, 2, frame.changedInputCount, globalInputLog.file) != frame.changedInputCount) {
+    return false;
+  }
+
+  for(u32 changedInput = 0; changedInput < frame.changedInputCount; changedInput++) {
+    u8 inputType = changedInputs[changedInput * 2];
+    if(inputType >= InputType_NumTypes) { return false; }
+    globalInputLog.loggedStates[inputType] = (InputState)changedInputs[(changedInput * 2) + 1];
+  }
+  memcpy(inputStates, globalInputLog.loggedStates, sizeof(inputStates));
+  *frameDelta = frame.frameDelta;
+  globalMouseScrollY = frame.mouseScrollY;
+  globaleMousePosition = frame.mousePosition;
+  globalMouseDelta = frame.mouseDelta;
+  globalAnalogStickLeft = frame.analogStickLeft;
+  globalAnalogStickRight = frame.analogStickRight;
+  globalController1TriggerLeftValue = frame.triggerLeftValue;
+  globalController1TriggerRightValue = frame.triggerRightValue;
+  return true;
+}
+
+internal_func void closeInputLog() {
+  if(globalInputLog.file != NULL) { fclose(globalInputLog.file); }
+  globalInputLog.file = NULL;
+  globalInputLog.mode = InputLogMode_Off;
+}
+
+b32 beginInputRecording(const char* fileName, const char* worldFile, b32 cursorEnabled) {
+  closeInputLog();
+  globalInputLog.file = fopen(fileName, "wb");
+  if(globalInputLog.file == NULL) { return false; }
+
+  InputLogHeader header{};
+  header.magic = INPUT_LOG_MAGIC;
+  header.version = INPUT_LOG_VERSION;
+  header.inputTypeCount = InputType_NumTypes;
+  snprintf(header.worldFile, sizeof(header.worldFile), "%s", worldFile);
+  header.cursorEnabled = cursorEnabled;
+  fwrite(&header, sizeof(header), 1, globalInputLog.file);
+
+  // NOTE: the first frame logs every input state that isn't inactive
+  memset(globalInputLog.loggedStates, 0, sizeof(globalInputLog.loggedStates));
+  globalInputLog.mode = InputLogMode_Recording;
+  return true;
+}
+
+void endInputRecording() {
+  if(globalInputLog.mode == InputLogMode_Recording) { closeInputLog(); }
+}
+
+b32 beginInputReplay(const char* fileName, Out InputLogHeader* header) {
+  closeInputLog();
+  globalInputLog.file = fopen(fileName, "rb");
+  if(globalInputLog.file == NULL) { return false; }
+  if(fread(header, sizeof(*header), 1, globalInputLog.file) != 1 || header->magic != INPUT_LOG_MAGIC ||
+     header->version != INPUT_LOG_VERSION || header->inputTypeCount != InputType_NumTypes) {
+    std::cout << "Input log is from an incompatible build: " << fileName << std::endl;
+    closeInputLog();
+    return false;
+  }
+  header->worldFile[sizeof(header->worldFile) - 1] = '\0';
+
+  memset(globalInputLog.loggedStates, 0, sizeof(globalInputLog.loggedStates));
+  globalInputLog.mode = InputLogMode_Replaying;
+  return true;
+}
+
+b32 isRecordingInput() {
+  return globalInputLog.mode == InputLogMode_Recording;
+}
+
+b32 isReplayingInput() {
+  return globalInputLog.mode == InputLogMode_Replaying;
+}
+
+void loadInputStateForFrame(GLFWwindow* window, f32* frameDelta) {
+  // NOTE: every button pressed at some point during the frame, even if released again before its end
+  b32 pressedDuringFrame[InputType_NumTypes] = {};
+  vec2_f64 mouseDelta{0.0, 0.0};
+  f64 mouseScrollY = 0.0;
+  globalMouseMotionSampleCount = 0;
+  InputEvent event;
+  while(popInputEvent(&event)) {
+    switch(event.type) {
+      case InputEvent_Button: {
+        globalButtonsDown[event.inputType] = event.pressed;
+        pressedDuringFrame[event.inputType] |= event.pressed;
+        break;
+      }
+      case InputEvent_CursorPosition: {
+        vec2_f64 delta{event.value.x - globaleMousePosition.x, event.value.y - globaleMousePosition.y};
+        globaleMousePosition = event.value;
+        mouseDelta = {mouseDelta.x + delta.x, mouseDelta.y + delta.y};
+        addMouseMotionSample(event.ticks, delta);
+        break;
+      }
+      case InputEvent_Scroll: {
+        mouseScrollY += event.value.y;
+        break;
+      }
+    }
+  }
+
+  if(globalInputLog.mode == InputLogMode_Replaying) {
+    if(readInputLogFrame(frameDelta)) {
+      // NOTE: logs only hold the frame's total mouse movement
+      globalMouseMotionSampleCount = 0;
+      if(globalMouseDelta.x != 0.0 || globalMouseDelta.y != 0.0) { addMouseMotionSample(getTicks(), globalMouseDelta); }
+      return;
+    }
+    closeInputLog();
+    globalWindowModeChangeTossNextInput = true; // NOTE: the live mouse position is wherever it was left
+  }
+
+  // keyboard & mouse button state
+  {
+#define KeyboardInput(name, input_code) setInputState(KeyboardInput_##name, globalButtonsDown[KeyboardInput_##name] || pressedDuringFrame[KeyboardInput_##name]);
 #include "keyboard_input_list.inc"
 #undef KeyboardInput
+    const InputType mouseButtons[] = { MouseInput_Left, MouseInput_Right, MouseInput_Middle, MouseInput_Back, MouseInput_Forward };
+    for(InputType mouseButton : mouseButtons) {
+      setInputState(mouseButton, globalButtonsDown[mouseButton] || pressedDuringFrame[mouseButton]);
+    }
+  }
 
-  // mouse state
+  // mouse movement state management
   {
-    setMouseState(MouseInput_Left, GLFW_MOUSE_BUTTON_LEFT, window);
-    setMouseState(MouseInput_Right, GLFW_MOUSE_BUTTON_RIGHT, window);
-    setMouseState(MouseInput_Middle, GLFW_MOUSE_BUTTON_MIDDLE, window);
-    setMouseState(MouseInput_Back, GLFW_MOUSE_BUTTON_4, window);
-    setMouseState(MouseInput_Forward, GLFW_MOUSE_BUTTON_5, window);
-
-    // mouse movement state management
-    {
-      vec2_f64 newMouseCoord;
-      glfwGetCursorPos(window, &newMouseCoord.x, &newMouseCoord.y);
-
-      // NOTE: We do not consume mouse input on window size changes as it results in unwanted values
-      globalMouseDelta = consumabool(&globalWindowModeChangeTossNextInput) ? vec2_f64{0.0f, 0.0f} : vec2_f64{newMouseCoord.x - globaleMousePosition.x, newMouseCoord.y - globaleMousePosition.y};
-      globaleMousePosition = newMouseCoord;
-      b32 mouseMovementIsCurrentlyActive = globalMouseDelta.x != 0.0f || globalMouseDelta.y != 0.0f;
-      setInputState(MouseInput_Movement, mouseMovementIsCurrentlyActive);
+    // NOTE: We do not consume mouse input on window size changes as it results in unwanted values
+    if(consumabool(&globalWindowModeChangeTossNextInput)) {
+      mouseDelta = {0.0, 0.0};
+      globalMouseMotionSampleCount = 0;
     }
+    globalMouseDelta = mouseDelta;
+    b32 mouseMovementIsCurrentlyActive = globalMouseDelta.x != 0.0f || globalMouseDelta.y != 0.0f;
+    setInputState(MouseInput_Movement, mouseMovementIsCurrentlyActive);
+  }
 
-    // mouse scroll state management
-    {
-      globalMouseScrollY = (f32)globalMouseScroll.y;
-      globalMouseScroll.y = 0.0f; // NOTE: Set to 0.0f to signify that the result has been consumed
-      b32 mouseScrollIsCurrentlyActive = globalMouseScrollY != 0.0f;
-      setInputState(MouseInput_Scroll, mouseScrollIsCurrentlyActive);
-    }
+  // mouse scroll state management
+  {
+    globalMouseScrollY = (f32)mouseScrollY;
+    b32 mouseScrollIsCurrentlyActive = globalMouseScrollY != 0.0f;
+    setInputState(MouseInput_Scroll, mouseScrollIsCurrentlyActive);
   }
 
   // TODO: Add support for multiple controllers?
   const u32 controllerIndex = 0;
   XINPUT_STATE controllerState;
-  if (XInputGetState(controllerIndex, &controllerState) == ERROR_SUCCESS)
+  u64 ticks = getTicks();
+  b32 checkController = globalControllerConnected ||
+                        ticksToSeconds(ticks - globalControllerLastCheckTicks) >= INPUT_CONTROLLER_RECONNECT_SECONDS;
+  if(checkController) {
+    globalControllerLastCheckTicks = ticks;
+    globalControllerConnected = XInputGetState(controllerIndex, &controllerState) == ERROR_SUCCESS;
+  }
+  if (globalControllerConnected && checkController)
   {
     // the controller is plugged in
     s16 gamepadButtonFlags = controllerState.Gamepad.wButtons;
@@ -234,12 +494,47 @@ void loadInputStateForFrame(GLFWwindow* window) {
     setInputState(Controller1Input_Trigger_Right, rightTriggerIsCurrentlyActive);
     globalController1TriggerRightValue = rightTriggerIsCurrentlyActive ? controllerState.Gamepad.bRightTrigger - XINPUT_GAMEPAD_TRIGGER_THRESHOLD : 0;
   }
+
+  if(globalInputLog.mode == InputLogMode_Recording) { writeInputLogFrame(*frameDelta); }
+}
+
+void glfw_key_callback(GLFWwindow* window, s32 key, s32 scancode, s32 action, s32 mods)
+{
+  if(key < 0 || key > GLFW_KEY_LAST || globalGlfwKeyInputTypes[key] == InputType_NumTypes) { return; }
+  pushButtonEvent(globalGlfwKeyInputTypes[key], action);
+}
+
+void glfw_mouse_button_callback(GLFWwindow* window, s32 button, s32 action, s32 mods)
+{
+  InputType mouseInput;
+  switch(button) {
+    case GLFW_MOUSE_BUTTON_LEFT: mouseInput = MouseInput_Left; break;
+    case GLFW_MOUSE_BUTTON_RIGHT: mouseInput = MouseInput_Right; break;
+    case GLFW_MOUSE_BUTTON_MIDDLE: mouseInput = MouseInput_Middle; break;
+    case GLFW_MOUSE_BUTTON_4: mouseInput = MouseInput_Back; break;
+    case GLFW_MOUSE_BUTTON_5: mouseInput = MouseInput_Forward; break;
+    default: return;
+  }
+  pushButtonEvent(mouseInput, action);
+}
+
+void glfw_cursor_position_callback(GLFWwindow* window, f64 x, f64 y)
+{
+  InputEvent event{};
+  event.ticks = getTicks();
+  event.type = InputEvent_CursorPosition;
+  event.value = {x, y};
+  pushInputEvent(event);
 }
 
 // Callback function for when user scrolls with mouse wheel
 void glfw_mouse_scroll_callback(GLFWwindow* window, f64 xOffset, f64 yOffset)
 {
-  globalMouseScroll.y = yOffset;
+  InputEvent event{};
+  event.ticks = getTicks();
+  event.type = InputEvent_Scroll;
+  event.value = {xOffset, yOffset};
+  pushInputEvent(event);
 }
 
 void subscribeWindowSizeCallback(windows_size_callback* callback)
@@ -34,9 +34,38 @@ enum InputState
     INPUT_HOT_RELEASE = 1 << 2,
 };
 
+/*
+ * Input logs record every frame's input (input states, mouse, scroll, controller) and elapsed time to a binary file,
+ * then replay it in place of polling. Only changed input states are written each frame.
+ * A log is only valid for the build's InputType list and should start from the state named in its header.
+ */
+#define INPUT_LOG_MAGIC 0x474F4C4E // NOTE: "NLOG"
+#define INPUT_LOG_VERSION 1
+
+struct InputLogHeader {
+  u32 magic;
+  u32 version;
+  u32 inputTypeCount; // NOTE: InputType_NumTypes of the recording build
+  char worldFile[256]; // NOTE: world loaded when the recording began, empty if none
+  b32 cursorEnabled;
+};
+
+// NOTE: one cursor movement reported by the platform, a frame may hold several
+struct MouseMotionSample {
+  u64 ticks; // NOTE: as returned by getTicks() when the movement arrived
+  vec2_f64 delta;
+};
+
 void initializeInput(GLFWwindow* window);
 void deinitializeInput(GLFWwindow* window);
-void loadInputStateForFrame(GLFWwindow* window);
+// NOTE: frameDelta is written to the log while recording and replaced by the logged value while replaying
+void loadInputStateForFrame(GLFWwindow* window, f32* frameDelta);
+
+b32 beginInputRecording(const char* fileName, const char* worldFile, b32 cursorEnabled);
+void endInputRecording();
+b32 beginInputReplay(const char* fileName, Out InputLogHeader* header);
+b32 isRecordingInput();
+b32 isReplayingInput(); // NOTE: false once the log has been replayed to its end
 
 b32 hotPress(InputType key); // returns true if input was just activated
 b32 hotRelease(InputType key); // returns true if input was just deactivated
@@ -44,7 +73,9 @@ b32 isActive(InputType key); // returns true if key is pressed or held down
 InputState getInputState(InputType key); // Note: for special use cases (ex: double click), use hotPress/hotRelease/isActive in most cases
 
 vec2_f64 getMousePosition();
-vec2_f64 getMouseDelta();
+vec2_f64 getMouseDelta(); // NOTE: sum of the frame's mouse motion samples
+u32 getMouseMotionSamples(Out const MouseMotionSample** samples); // NOTE: oldest first, valid until the next frame
+u32 getDroppedInputEventCount(); // NOTE: events lost to a full event queue since startup
 f32 getMouseScrollY();
 s8 getControllerTriggerRaw_Left(); // NOTE: values range from 0 - 225 (255 minus trigger threshold)
 s8 getControllerTriggerRaw_Right(); // NOTE: values range from 0 - 225 (255 minus trigger threshold)
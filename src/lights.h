@@ -0,0 +1,216 @@
+#pragma once
+
+/*
+ * Clustered forward lighting
+ * - The view frustum is split into LIGHT_CLUSTER_COUNT_X * LIGHT_CLUSTER_COUNT_Y screen space tiles and
+ *   LIGHT_CLUSTER_COUNT_Z exponentially spaced depth slices.
+ * - Every frame (and for every scene seen through a portal), positional lights are binned on the CPU into every cluster
+ *   their sphere of influence may touch. Fragments then only evaluate the lights of the cluster they fall in.
+ * - Results are stored in texture buffers as GL 3.3 offers no shader storage buffers.
+ */
+
+// NOTE: Intensity at which a positional light is considered to no longer contribute. Determines the light's radius.
+#define POS_LIGHT_INTENSITY_CUTOFF 0.01f
+#define LIGHT_CLUSTER_COUNT (LIGHT_CLUSTER_COUNT_X * LIGHT_CLUSTER_COUNT_Y * LIGHT_CLUSTER_COUNT_Z)
+// NOTE: Room for an average of 16 lights per cluster. Light indices past this limit are dropped.
+#define MAX_LIGHT_CLUSTER_INDICES (LIGHT_CLUSTER_COUNT * 16)
+
+struct Light {
+  vec4 color;
+  // NOTE: For directional lights, this is the direction to the source
+  vec3 pos;
+};
+
+struct LightClusterGrid {
+  vec4 posLights[MAX_POS_LIGHTS * 2]; // NOTE: two texels per light: (color.rgb, power) & (pos.xyz, radius)
+  u32 clusters[LIGHT_CLUSTER_COUNT * 2]; // NOTE: (first index into lightIndices, light count) per cluster
+  u16 lightIndices[MAX_LIGHT_CLUSTER_INDICES];
+  u32 posLightCount;
+  u32 lightIndexCount;
+  u32 droppedLightIndexCount; // NOTE: non-zero means clusters are missing lights, consider raising MAX_LIGHT_CLUSTER_INDICES
+  f32 sliceScale;
+  f32 sliceBias;
+
+  TextureBuffer posLightsBuffer;
+  TextureBuffer clustersBuffer;
+  TextureBuffer lightIndicesBuffer;
+};
+
+// NOTE: Falloff used in shaders is power / (1 + distance^2), windowed to reach zero at the radius
+inline f32 positionalLightRadius(f32 power) {
+  f32 radiusSquared = (power / POS_LIGHT_INTENSITY_CUTOFF) - 1.0f;
+  return radiusSquared > 0.0f ? sqrtf(radiusSquared) : 0.0f;
+}
+
+// NOTE: slice = log(depth) * sliceScale - sliceBias
+inline void lightClusterSliceScaleBias(f32 near, f32 far, Out f32* sliceScale, Out f32* sliceBias) {
+  f32 logFarOverNear = logf(far / near);
+  *sliceScale = LIGHT_CLUSTER_COUNT_Z / logFarOverNear;
+  *sliceBias = (LIGHT_CLUSTER_COUNT_Z * logf(near)) / logFarOverNear;
+}
+
+inline u32 lightClusterSlice(f32 viewDepth, f32 sliceScale, f32 sliceBias) {
+  f32 slice = (logf(viewDepth) * sliceScale) - sliceBias;
+  return (u32)clamp(0.0f, LIGHT_CLUSTER_COUNT_Z - 1.0f, slice);
+}
+
+// NOTE: ndc in [-1, 1] to tile in [0, tileCount - 1]
+inline u32 lightClusterTile(f32 ndc, u32 tileCount) {
+  f32 tile = ((ndc * 0.5f) + 0.5f) * tileCount;
+  return (u32)clamp(0.0f, tileCount - 1.0f, tile);
+}
+
+inline vec2 lightClusterTileSize(vec2_u32 windowExtent) {
+  return vec2{f32(windowExtent.width) / LIGHT_CLUSTER_COUNT_X, f32(windowExtent.height) / LIGHT_CLUSTER_COUNT_Y};
+}
+
+/*
+ * Conservative ndc extent of the view space interval [viewMin, viewMax] over depths in [depthNear, depthFar]
+ * x/depth is smallest at the nearest depth when x is negative and at the furthest depth when x is positive
+ */
+inline void viewSpaceIntervalToNdc(f32 viewMin, f32 viewMax, f32 depthNear, f32 depthFar, f32 tanHalfFov,
+                                   Out f32* ndcMin, Out f32* ndcMax) {
+  *ndcMin = (viewMin < 0.0f ? viewMin / depthNear : viewMin / depthFar) / tanHalfFov;
+  *ndcMax = (viewMax > 0.0f ? viewMax / depthNear : viewMax / depthFar) / tanHalfFov;
+}
+
+/*
+ * Bins the positional lights into the clusters of the frustum defined by the view matrix, fovVert, aspect, near & far.
+ * Oblique projections (portals) are fine to shade with this grid, as they only differ from the standard perspective
+ * projection in depth.
+ */
+void buildLightClusters(LightClusterGrid* grid, const Light* posLights, u32 posLightCount,
+                        const mat4& viewMat, f32 fovVert, f32 aspect, f32 near, f32 far) {
+  Assert(posLightCount <= MAX_POS_LIGHTS);
+
+  struct {
+    u8 min[3];
+    u8 max[3];
+    b32 visible;
+  } lightClusterBounds[MAX_POS_LIGHTS];
+
+  lightClusterSliceScaleBias(near, far, &grid->sliceScale, &grid->sliceBias);
+  const f32 tanHalfFovY = tanf(fovVert * 0.5f);
+  const f32 tanHalfFovX = tanHalfFovY * aspect;
+
+  memset(grid->clusters, 0, sizeof(grid->clusters));
+  grid->posLightCount = posLightCount;
+  grid->lightIndexCount = 0;
+  grid->droppedLightIndexCount = 0;
+
+  // pass one: find the cluster bounds of each light and count the lights of each cluster
+  for(u32 lightIndex = 0; lightIndex < posLightCount; lightIndex++) {
+    const Light& light = posLights[lightIndex];
+    f32 radius = positionalLightRadius(light.color.a);
+    grid->posLights[lightIndex * 2] = light.color;
+    grid->posLights[(lightIndex * 2) + 1] = Vec4(light.pos, radius);
+
+    lightClusterBounds[lightIndex].visible = false;
+    if(radius == 0.0f) { continue; }
+
+    vec3 viewPos = (viewMat * Vec4(light.pos, 1.0f)).xyz;
+    f32 depth = -viewPos.z; // NOTE: OpenGL views down the negative z-axis
+    f32 depthNear = depth - radius;
+    f32 depthFar = depth + radius;
+    if(depthFar < near || depthNear > far) { continue; }
+    depthNear = clamp(near, far, depthNear);
+    depthFar = clamp(near, far, depthFar);
+
+    f32 ndcMinX, ndcMaxX, ndcMinY, ndcMaxY;
+    viewSpaceIntervalToNdc(viewPos.x - radius, viewPos.x + radius, depthNear, depthFar, tanHalfFovX, &ndcMinX, &ndcMaxX);
+    viewSpaceIntervalToNdc(viewPos.y - radius, viewPos.y + radius, depthNear, depthFar, tanHalfFovY, &ndcMinY, &ndcMaxY);
+    if(ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f) { continue; }
+
+    lightClusterBounds[lightIndex].visible = true;
+    u8* boundsMin = lightClusterBounds[lightIndex].min;
+    u8* boundsMax = lightClusterBounds[lightIndex].max;
+    boundsMin[0] = (u8)lightClusterTile(ndcMinX, LIGHT_CLUSTER_COUNT_X);
+    boundsMax[0] = (u8)lightClusterTile(ndcMaxX, LIGHT_CLUSTER_COUNT_X);
+    boundsMin[1] = (u8)lightClusterTile(ndcMinY, LIGHT_CLUSTER_COUNT_Y);
+    boundsMax[1] = (u8)lightClusterTile(ndcMaxY, LIGHT_CLUSTER_COUNT_Y);
+    boundsMin[2] = (u8)lightClusterSlice(depthNear, grid->sliceScale, grid->sliceBias);
+    boundsMax[2] = (u8)lightClusterSlice(depthFar, grid->sliceScale, grid->sliceBias);
+
+    for(u32 z = boundsMin[2]; z <= boundsMax[2]; z++) {
+      for(u32 y = boundsMin[1]; y <= boundsMax[1]; y++) {
+        for(u32 x = boundsMin[0]; x <= boundsMax[0]; x++) {
+          u32 clusterIndex = x + (LIGHT_CLUSTER_COUNT_X * (y + (LIGHT_CLUSTER_COUNT_Y * z)));
+          grid->clusters[(clusterIndex * 2) + 1]++;
+        }
+      }
+    }
+  }
+
+  // prefix sum of the counts to find each cluster's offset
+  for(u32 clusterIndex = 0; clusterIndex < LIGHT_CLUSTER_COUNT; clusterIndex++) {
+    u32* clusterOffset = grid->clusters + (clusterIndex * 2);
+    u32* clusterCount = clusterOffset + 1;
+    u32 remainingIndices = MAX_LIGHT_CLUSTER_INDICES - grid->lightIndexCount;
+    if(*clusterCount > remainingIndices) {
+      grid->droppedLightIndexCount += *clusterCount - remainingIndices;
+      *clusterCount = remainingIndices;
+    }
+    *clusterOffset = grid->lightIndexCount;
+    grid->lightIndexCount += *clusterCount;
+  }
+
+  // pass two: fill in the light indices of each cluster
+  u32 clusterCursors[LIGHT_CLUSTER_COUNT] = {};
+  for(u32 lightIndex = 0; lightIndex < posLightCount; lightIndex++) {
+    if(!lightClusterBounds[lightIndex].visible) { continue; }
+    u8* boundsMin = lightClusterBounds[lightIndex].min;
+    u8* boundsMax = lightClusterBounds[lightIndex].max;
+    for(u32 z = boundsMin[2]; z <= boundsMax[2]; z++) {
+      for(u32 y = boundsMin[1]; y <= boundsMax[1]; y++) {
+        for(u32 x = boundsMin[0]; x <= boundsMax[0]; x++) {
+          u32 clusterIndex = x + (LIGHT_CLUSTER_COUNT_X * (y + (LIGHT_CLUSTER_COUNT_Y * z)));
+          u32 clusterOffset = grid->clusters[clusterIndex * 2];
+          u32 clusterCount = grid->clusters[(clusterIndex * 2) + 1];
+          if(clusterCursors[clusterIndex] < clusterCount) {
+            grid->lightIndices[clusterOffset + clusterCursors[clusterIndex]++] = (u16)lightIndex;
+          }
+        }
+      }
+    }
+  }
+}
+
+void initLightClusterGrid(LightClusterGrid* grid) {
+  initTextureBuffer(&grid->posLightsBuffer, GL_RGBA32F, sizeof(grid->posLights));
+  initTextureBuffer(&grid->clustersBuffer, GL_RG32UI, sizeof(grid->clusters));
+  initTextureBuffer(&grid->lightIndicesBuffer, GL_R16UI, sizeof(grid->lightIndices));
+}
+
+void deleteLightClusterGrid(LightClusterGrid* grid) {
+  deleteTextureBuffer(&grid->posLightsBuffer);
+  deleteTextureBuffer(&grid->clustersBuffer);
+  deleteTextureBuffer(&grid->lightIndicesBuffer);
+}
+
+// NOTE: Buffers are orphaned before each upload so the grid can be rebuilt multiple times a frame without stalling
+void uploadLightClusterGrid(const LightClusterGrid* grid) {
+  glBindBuffer(GL_TEXTURE_BUFFER, grid->posLightsBuffer.bufferId);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(grid->posLights), NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, grid->posLightCount * 2 * sizeof(vec4), grid->posLights);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, grid->clustersBuffer.bufferId);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(grid->clusters), grid->clusters, GL_STREAM_DRAW);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, grid->lightIndicesBuffer.bufferId);
+  glBufferData(GL_TEXTURE_BUFFER, sizeof(grid->lightIndices), NULL, GL_STREAM_DRAW);
+  glBufferSubData(GL_TEXTURE_BUFFER, 0, grid->lightIndexCount * sizeof(u16), grid->lightIndices);
+
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void bindLightClusterGrid(const LightClusterGrid* grid) {
+  bindActiveTexture(posLightsActiveTextureIndex, grid->posLightsBuffer.textureId, GL_TEXTURE_BUFFER);
+  bindActiveTexture(lightClustersActiveTextureIndex, grid->clustersBuffer.textureId, GL_TEXTURE_BUFFER);
+  bindActiveTexture(lightIndicesActiveTextureIndex, grid->lightIndicesBuffer.textureId, GL_TEXTURE_BUFFER);
+}
+
+void setLightClusterSamplers(GLuint shaderId) {
+  setSamplerBuffer(shaderId, posLightsTexUniformName, posLightsActiveTextureIndex);
+  setSamplerBuffer(shaderId, lightClustersTexUniformName, lightClustersActiveTextureIndex);
+  setSamplerBuffer(shaderId, lightIndicesTexUniformName, lightIndicesActiveTextureIndex);
+}
\ No newline at end of file
@@ -0,0 +1,323 @@
+#pragma once
+
+/*
+ * Index & vertex reordering for meshes, run at load time
+ * - optimizeVertexCache(): Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" (2006)
+ * - optimizeOverdraw(): based on Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (2007)
+ *   The cache optimized order is split into clusters wherever the cache is effectively flushed, then clusters facing
+ *   away from the mesh's center are drawn first as they are the most likely to occlude the rest.
+ * - optimizeVertexFetch(): vertices are reordered to match their first use in the index buffer
+ * - generateIndices(): indexes non-indexed vertices, sharing binary identical vertices
+ *
+ * analyzeVertexCache() simulates a FIFO post-transform cache and reports:
+ * - ACMR (average cache miss ratio): transformed vertices per triangle. 3.0 is worst, ~0.5 is best for large meshes.
+ * - ATVR (average transformed vertex ratio): transformed vertices per vertex. 1.0 is optimal.
+ */
+
+#define VERTEX_CACHE_OPTIMIZE_SIZE 32
+// NOTE: Conservative FIFO cache size for reporting, post-transform caches vary by GPU
+#define VERTEX_CACHE_ANALYZE_SIZE 16
+
+struct VertexCacheStats {
+  u32 transformedVertexCount;
+  u32 triangleCount;
+  u32 vertexCount;
+};
+
+inline f32 acmr(const VertexCacheStats& stats) {
+  return stats.triangleCount != 0 ? f32(stats.transformedVertexCount) / stats.triangleCount : 0.0f;
+}
+
+inline f32 atvr(const VertexCacheStats& stats) {
+  return stats.vertexCount != 0 ? f32(stats.transformedVertexCount) / stats.vertexCount : 0.0f;
+}
+
+inline void operator+=(VertexCacheStats& stats1, const VertexCacheStats& stats2) {
+  stats1.transformedVertexCount += stats2.transformedVertexCount;
+  stats1.triangleCount += stats2.triangleCount;
+  stats1.vertexCount += stats2.vertexCount;
+}
+
+VertexCacheStats analyzeVertexCache(const u32* indices, u32 indexCount, u32 vertexCount, u32 cacheSize = VERTEX_CACHE_ANALYZE_SIZE) {
+  VertexCacheStats stats{};
+  stats.triangleCount = indexCount / 3;
+  stats.vertexCount = vertexCount;
+
+  // NOTE: A vertex is in the FIFO cache if fewer than cacheSize vertices have been transformed since it was
+  std::vector<u32> cacheTimestamps(vertexCount, 0);
+  u32 timestamp = cacheSize + 1;
+  for(u32 i = 0; i < indexCount; i++) {
+    u32 index = indices[i];
+    if(timestamp - cacheTimestamps[index] > cacheSize) {
+      cacheTimestamps[index] = timestamp++;
+      stats.transformedVertexCount++;
+    }
+  }
+  return stats;
+}
+
+internal_func f32 forsythVertexScore(s32 cachePosition, u32 remainingTriangleCount) {
+  if(remainingTriangleCount == 0) { return -1.0f; }
+
+  f32 score = 0.0f;
+  if(cachePosition >= 0) {
+    if(cachePosition < 3) {
+      // NOTE: Vertices of the last triangle are penalized slightly, strip-like orderings thrash larger caches
+      score = 0.75f;
+    } else {
+      const f32 scaler = 1.0f / (VERTEX_CACHE_OPTIMIZE_SIZE - 3);
+      score = powf(1.0f - ((cachePosition - 3) * scaler), 1.5f);
+    }
+  }
+  // NOTE: Boost vertices with few triangles remaining to finish them off rather than leave lone triangles behind
+  score += 2.0f * powf((f32)remainingTriangleCount, -0.5f);
+  return score;
+}
+
+void optimizeVertexCache(u32* indices, u32 indexCount, u32 vertexCount) {
+  u32 triangleCount = indexCount / 3;
+  if(triangleCount == 0) { return; }
+
+  // vertex to triangle adjacency, remaining triangles of each vertex are kept at the front of its range
+  std::vector<u32> remainingTriangleCounts(vertexCount, 0);
+  for(u32 i = 0; i < indexCount; i++) {
+    remainingTriangleCounts[indices[i]]++;
+  }
+  std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+    adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangleCounts[vertex];
+  }
+  std::vector<u32> adjacency(indexCount);
+  {
+    std::vector<u32> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(u32 i = 0; i < indexCount; i++) {
+      adjacency[adjacencyFill[indices[i]]++] = i / 3;
+    }
+  }
+
+  std::vector<s32> cachePositions(vertexCount, -1);
+  std::vector<f32> vertexScores(vertexCount);
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+    vertexScores[vertex] = forsythVertexScore(-1, remainingTriangleCounts[vertex]);
+  }
+
+  std::vector<f32> triangleScores(triangleCount);
+  std::vector<u8> triangleEmitted(triangleCount, false);
+  s32 bestTriangle = 0;
+  for(u32 triangle = 0; triangle < triangleCount; triangle++) {
+    const u32* triangleIndices = indices + (triangle * 3);
+    triangleScores[triangle] = vertexScores[triangleIndices[0]] + vertexScores[triangleIndices[1]] + vertexScores[triangleIndices[2]];
+    if(triangleScores[triangle] > triangleScores[bestTriangle]) { bestTriangle = triangle; }
+  }
+
+  std::vector<u32> optimizedIndices;
+  optimizedIndices.reserve(triangleCount * 3);
+  // NOTE: three extra slots hold the vertices pushed out of the cache by the latest triangle
+  u32 cache[VERTEX_CACHE_OPTIMIZE_SIZE + 3];
+  u32 cacheCount = 0;
+  u32 nextUnemittedTriangle = 0;
+  for(u32 emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+    if(bestTriangle < 0) { // nothing adjacent to the cache remains, fall back to the next triangle in the original order
+      while(triangleEmitted[nextUnemittedTriangle]) { nextUnemittedTriangle++; }
+      bestTriangle = nextUnemittedTriangle;
+    }
+
+    u32 triangle = (u32)bestTriangle;
+    triangleEmitted[triangle] = true;
+    const u32* triangleIndices = indices + (triangle * 3);
+
+    u32 newCache[VERTEX_CACHE_OPTIMIZE_SIZE + 3];
+    u32 newCacheCount = 0;
+    for(u32 i = 0; i < 3; i++) {
+      u32 vertex = triangleIndices[i];
+      optimizedIndices.push_back(vertex);
+
+      // remove the triangle from the vertex's remaining triangles
+      u32* vertexAdjacency = adjacency.data() + adjacencyOffsets[vertex];
+      u32 remainingTriangleCount = remainingTriangleCounts[vertex];
+      for(u32 j = 0; j < remainingTriangleCount; j++) {
+        if(vertexAdjacency[j] == triangle) {
+          vertexAdjacency[j] = vertexAdjacency[remainingTriangleCount - 1];
+          remainingTriangleCounts[vertex]--;
+          break;
+        }
+      }
+
+      if(std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount) {
+        newCache[newCacheCount++] = vertex;
+      }
+    }
+    for(u32 i = 0; i < cacheCount; i++) {
+      u32 vertex = cache[i];
+      if(vertex != triangleIndices[0] && vertex != triangleIndices[1] && vertex != triangleIndices[2]) {
+        newCache[newCacheCount++] = vertex;
+      }
+    }
+
+    // rescore every vertex whose cache position or remaining triangles changed & propagate to their triangles
+    for(u32 i = 0; i < newCacheCount; i++) {
+      u32 vertex = newCache[i];
+      cachePositions[vertex] = i < VERTEX_CACHE_OPTIMIZE_SIZE ? (s32)i : -1;
+      f32 newScore = forsythVertexScore(cachePositions[vertex], remainingTriangleCounts[vertex]);
+      f32 scoreDiff = newScore - vertexScores[vertex];
+      vertexScores[vertex] = newScore;
+      const u32* vertexAdjacency = adjacency.data() + adjacencyOffsets[vertex];
+      for(u32 j = 0; j < remainingTriangleCounts[vertex]; j++) {
+        triangleScores[vertexAdjacency[j]] += scoreDiff;
+      }
+    }
+
+    cacheCount = Min(newCacheCount, (u32)VERTEX_CACHE_OPTIMIZE_SIZE);
+    memcpy(cache, newCache, cacheCount * sizeof(u32));
+
+    // NOTE: Only triangles touching the cache are considered, the rest can only score through valence
+    bestTriangle = -1;
+    f32 bestScore = 0.0f;
+    for(u32 i = 0; i < cacheCount; i++) {
+      u32 vertex = cache[i];
+      const u32* vertexAdjacency = adjacency.data() + adjacencyOffsets[vertex];
+      for(u32 j = 0; j < remainingTriangleCounts[vertex]; j++) {
+        u32 adjacentTriangle = vertexAdjacency[j];
+        if(triangleScores[adjacentTriangle] > bestScore) {
+          bestScore = triangleScores[adjacentTriangle];
+          bestTriangle = adjacentTriangle;
+        }
+      }
+    }
+  }
+
+  memcpy(indices, optimizedIndices.data(), optimizedIndices.size() * sizeof(u32));
+}
+
+// NOTE: Expects indices already optimized for the vertex cache, clusters keep their internal order
+void optimizeOverdraw(u32* indices, u32 indexCount, const vec3* positions, u32 vertexCount) {
+  u32 triangleCount = indexCount / 3;
+  if(triangleCount == 0) { return; }
+
+  // split into clusters at hard boundaries, triangles where every vertex misses the cache
+  std::vector<u32> clusterFirstTriangles;
+  {
+    std::vector<u32> cacheTimestamps(vertexCount, 0);
+    u32 timestamp = VERTEX_CACHE_OPTIMIZE_SIZE + 1;
+    for(u32 triangle = 0; triangle < triangleCount; triangle++) {
+      u32 missCount = 0;
+      for(u32 i = 0; i < 3; i++) {
+        u32 index = indices[(triangle * 3) + i];
+        if(timestamp - cacheTimestamps[index] > VERTEX_CACHE_OPTIMIZE_SIZE) {
+          cacheTimestamps[index] = timestamp++;
+          missCount++;
+        }
+      }
+      if(missCount == 3) { clusterFirstTriangles.push_back(triangle); }
+    }
+  }
+  u32 clusterCount = (u32)clusterFirstTriangles.size();
+  if(clusterCount <= 1) { return; }
+  clusterFirstTriangles.push_back(triangleCount); // NOTE: sentinel to simplify cluster ranges
+
+  // NOTE: Centroids and normals are area weighted, unnormalized face normals have a magnitude of twice the area
+  std::vector<vec3> clusterCentroids(clusterCount, vec3{0.0f, 0.0f, 0.0f});
+  std::vector<vec3> clusterNormals(clusterCount, vec3{0.0f, 0.0f, 0.0f});
+  vec3 meshCentroid{0.0f, 0.0f, 0.0f};
+  f32 meshArea = 0.0f;
+  for(u32 cluster = 0; cluster < clusterCount; cluster++) {
+    f32 clusterArea = 0.0f;
+    for(u32 triangle = clusterFirstTriangles[cluster]; triangle < clusterFirstTriangles[cluster + 1]; triangle++) {
+      const vec3& p0 = positions[indices[(triangle * 3) + 0]];
+      const vec3& p1 = positions[indices[(triangle * 3) + 1]];
+      const vec3& p2 = positions[indices[(triangle * 3) + 2]];
+      vec3 faceNormal = cross(p1 - p0, p2 - p0);
+      f32 area = magnitude(faceNormal);
+      clusterCentroids[cluster] += ((p0 + p1 + p2) / 3.0f) * area;
+      clusterNormals[cluster] += faceNormal;
+      clusterArea += area;
+    }
+    meshCentroid += clusterCentroids[cluster];
+    meshArea += clusterArea;
+    clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : positions[indices[clusterFirstTriangles[cluster] * 3]];
+  }
+  meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+  std::vector<f32> clusterSortKeys(clusterCount);
+  for(u32 cluster = 0; cluster < clusterCount; cluster++) {
+    vec3 clusterNormal = clusterNormals[cluster];
+    clusterSortKeys[cluster] = degenerate(clusterNormal) ? 0.0f : dot(clusterCentroids[cluster] - meshCentroid, normalize(clusterNormal));
+  }
+
+  std::vector<u32> clusterOrder(clusterCount);
+  for(u32 cluster = 0; cluster < clusterCount; cluster++) { clusterOrder[cluster] = cluster; }
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&clusterSortKeys](u32 a, u32 b) {
+    return clusterSortKeys[a] > clusterSortKeys[b];
+  });
+
+  std::vector<u32> sortedIndices;
+  sortedIndices.reserve(triangleCount * 3);
+  for(u32 cluster : clusterOrder) {
+    sortedIndices.insert(sortedIndices.end(),
+                         indices + (clusterFirstTriangles[cluster] * 3),
+                         indices + (clusterFirstTriangles[cluster + 1] * 3));
+  }
+  memcpy(indices, sortedIndices.data(), sortedIndices.size() * sizeof(u32));
+}
+
+/*
+ * Reorders vertices to their first use in indices and remaps indices to match
+ * returns the number of vertices referenced by indices, unreferenced vertices are dropped from the end
+ */
+u32 optimizeVertexFetch(u32* indices, u32 indexCount, void* vertices, u32 vertexCount, u32 vertexSizeInBytes) {
+  const u32 unmapped = ~0u;
+  std::vector<u32> remap(vertexCount, unmapped);
+  std::vector<u8> reorderedVertices((size_t)vertexCount * vertexSizeInBytes);
+  u32 reorderedVertexCount = 0;
+  for(u32 i = 0; i < indexCount; i++) {
+    u32 index = indices[i];
+    if(remap[index] == unmapped) {
+      remap[index] = reorderedVertexCount;
+      memcpy(reorderedVertices.data() + ((size_t)reorderedVertexCount * vertexSizeInBytes),
+             (u8*)vertices + ((size_t)index * vertexSizeInBytes),
+             vertexSizeInBytes);
+      reorderedVertexCount++;
+    }
+    indices[i] = remap[index];
+  }
+  memcpy(vertices, reorderedVertices.data(), (size_t)reorderedVertexCount * vertexSizeInBytes);
+  return reorderedVertexCount;
+}
+
+/*
+ * Builds indices for non-indexed vertices, merging vertices that are binary identical
+ * Unique vertices are compacted to the front of vertices in order of first occurrence, so indices[i] <= i
+ * returns the number of unique vertices
+ */
+u32 generateIndices(void* vertices, u32 vertexCount, u32 vertexSizeInBytes, Out u32* indices) {
+  u8* vertexBytes = (u8*)vertices;
+  std::vector<u32> sortedVertices(vertexCount);
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) { sortedVertices[vertex] = vertex; }
+  // NOTE: stable so the first vertex of each run of identical vertices is its first occurrence
+  std::stable_sort(sortedVertices.begin(), sortedVertices.end(), [vertexBytes, vertexSizeInBytes](u32 a, u32 b) {
+    return memcmp(vertexBytes + ((size_t)a * vertexSizeInBytes), vertexBytes + ((size_t)b * vertexSizeInBytes), vertexSizeInBytes) < 0;
+  });
+
+  std::vector<u32> firstOccurrences(vertexCount);
+  for(u32 i = 0; i < vertexCount; i++) {
+    u32 vertex = sortedVertices[i];
+    b32 sameAsPrevious = i > 0 && memcmp(vertexBytes + ((size_t)vertex * vertexSizeInBytes),
+                                         vertexBytes + ((size_t)sortedVertices[i - 1] * vertexSizeInBytes),
+                                         vertexSizeInBytes) == 0;
+    firstOccurrences[vertex] = sameAsPrevious ? firstOccurrences[sortedVertices[i - 1]] : vertex;
+  }
+
+  std::vector<u32> remap(vertexCount);
+  u32 uniqueVertexCount = 0;
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+    if(firstOccurrences[vertex] == vertex) {
+      remap[vertex] = uniqueVertexCount;
+      memmove(vertexBytes + ((size_t)uniqueVertexCount * vertexSizeInBytes),
+              vertexBytes + ((size_t)vertex * vertexSizeInBytes),
+              vertexSizeInBytes);
+      uniqueVertexCount++;
+    }
+    indices[vertex] = remap[firstOccurrences[vertex]];
+  }
+  return uniqueVertexCount;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+/*
+ * Mesh simplification by iterative edge collapse, ordered by quadric error
+ * source: Garland & Heckbert "Surface Simplification Using Quadric Error Metrics" (1997)
+ * - Vertices only ever collapse onto existing vertices, so simplified indices share the original vertex data.
+ * - Vertices on borders and attribute seams (several vertices sharing a position) are locked in place to keep
+ *   silhouettes and texture/normal discontinuities intact.
+ * - Collapses that would flip a triangle are rejected.
+ */
+
+struct Quadric {
+  // NOTE: Upper triangle of the symmetric 4x4 matrix plane * plane^T, f64 as errors are tiny differences of large terms
+  f64 a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+};
+
+internal_func Quadric planeQuadric(const vec3& normal, f32 d) {
+  f64 a = normal.x, b = normal.y, c = normal.z;
+  return Quadric{a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, (f64)d * d};
+}
+
+internal_func void operator+=(Quadric& q1, const Quadric& q2) {
+  q1.a2 += q2.a2; q1.ab += q2.ab; q1.ac += q2.ac; q1.ad += q2.ad;
+  q1.b2 += q2.b2; q1.bc += q2.bc; q1.bd += q2.bd;
+  q1.c2 += q2.c2; q1.cd += q2.cd;
+  q1.d2 += q2.d2;
+}
+
+internal_func Quadric operator+(const Quadric& q1, const Quadric& q2) {
+  Quadric result = q1;
+  result += q2;
+  return result;
+}
+
+// NOTE: Sum of squared distances from p to every plane accumulated in the quadric
+internal_func f64 quadricError(const Quadric& q, const vec3& p) {
+  f64 x = p.x, y = p.y, z = p.z;
+  f64 error = (q.a2 * x * x) + (2.0 * q.ab * x * y) + (2.0 * q.ac * x * z) + (2.0 * q.ad * x) +
+              (q.b2 * y * y) + (2.0 * q.bc * y * z) + (2.0 * q.bd * y) +
+              (q.c2 * z * z) + (2.0 * q.cd * z) +
+              q.d2;
+  return error > 0.0 ? error : 0.0;
+}
+
+// NOTE: Returns true if moving vertex "from" onto vertex "to" would flip any triangle that survives the collapse
+internal_func b32 collapseFlipsTriangle(u32 from, u32 to, const u32* indices, const vec3* positions,
+                                        const u32* vertexTriangles, u32 vertexTriangleCount) {
+  for(u32 i = 0; i < vertexTriangleCount; i++) {
+    const u32* triangleIndices = indices + (vertexTriangles[i] * 3);
+    if(triangleIndices[0] == to || triangleIndices[1] == to || triangleIndices[2] == to) { continue; } // collapses to nothing
+
+    vec3 p[3], pCollapsed[3];
+    for(u32 j = 0; j < 3; j++) {
+      p[j] = positions[triangleIndices[j]];
+      pCollapsed[j] = triangleIndices[j] == from ? positions[to] : p[j];
+    }
+    vec3 normal = cross(p[1] - p[0], p[2] - p[0]);
+    vec3 collapsedNormal = cross(pCollapsed[1] - pCollapsed[0], pCollapsed[2] - pCollapsed[0]);
+    if(dot(normal, collapsedNormal) <= 0.0f) { return true; }
+  }
+  return false;
+}
+
+/*
+ * Simplifies indices in place until targetIndexCount is reached or no collapse remains under targetError
+ * parameters:
+ * targetError is a distance in the same units as positions
+ * resultError (optional) returns the largest error of any collapse performed, in the same units as positions
+ * returns the simplified index count
+ */
+u32 simplifyMesh(u32* indices, u32 indexCount, const vec3* positions, u32 vertexCount,
+                 u32 targetIndexCount, f32 targetError, Out f32* resultError = nullptr) {
+  // weld vertices by position, seams are where multiple vertices share one
+  std::vector<u32> positionIds(vertexCount);
+  {
+    std::vector<u32> sortedVertices(vertexCount);
+    for(u32 vertex = 0; vertex < vertexCount; vertex++) { sortedVertices[vertex] = vertex; }
+    std::sort(sortedVertices.begin(), sortedVertices.end(), [positions](u32 a, u32 b) {
+      const vec3& pA = positions[a];
+      const vec3& pB = positions[b];
+      if(pA.x != pB.x) { return pA.x < pB.x; }
+      if(pA.y != pB.y) { return pA.y < pB.y; }
+      return pA.z < pB.z;
+    });
+    for(u32 i = 0; i < vertexCount; i++) {
+      u32 vertex = sortedVertices[i];
+      b32 samePositionAsPrevious = i > 0 && memcmp(&positions[vertex], &positions[sortedVertices[i - 1]], sizeof(vec3)) == 0;
+      positionIds[vertex] = samePositionAsPrevious ? positionIds[sortedVertices[i - 1]] : vertex;
+    }
+  }
+
+  std::vector<u8> locked(vertexCount, false);
+  {
+    std::vector<u32> referencedVerticesWithPosition(vertexCount, 0);
+    std::vector<u8> referenced(vertexCount, false);
+    for(u32 i = 0; i < indexCount; i++) {
+      u32 vertex = indices[i];
+      if(!referenced[vertex]) {
+        referenced[vertex] = true;
+        referencedVerticesWithPosition[positionIds[vertex]]++;
+      }
+    }
+    for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+      if(referencedVerticesWithPosition[positionIds[vertex]] > 1) { locked[vertex] = true; } // seam
+    }
+
+    // NOTE: Border edges are used by a single triangle. Edges are keyed by position so seams aren't mistaken for borders.
+    std::vector<u64> edges;
+    edges.reserve(indexCount);
+    for(u32 i = 0; i < indexCount; i += 3) {
+      for(u32 j = 0; j < 3; j++) {
+        u32 a = positionIds[indices[i + j]];
+        u32 b = positionIds[indices[i + ((j + 1) % 3)]];
+        edges.push_back(((u64)Min(a, b) << 32) | Max(a, b));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::vector<u8> borderPositions(vertexCount, false); // NOTE: indexed by position id
+    for(size_t i = 0; i < edges.size();) {
+      size_t sameEdgeEnd = i + 1;
+      while(sameEdgeEnd < edges.size() && edges[sameEdgeEnd] == edges[i]) { sameEdgeEnd++; }
+      if(sameEdgeEnd - i == 1) {
+        borderPositions[(u32)(edges[i] >> 32)] = true;
+        borderPositions[(u32)(edges[i] & U32_MAX)] = true;
+      }
+      i = sameEdgeEnd;
+    }
+    for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+      if(borderPositions[positionIds[vertex]]) { locked[vertex] = true; }
+    }
+  }
+
+  std::vector<Quadric> quadrics(vertexCount, Quadric{});
+  for(u32 i = 0; i < indexCount; i += 3) {
+    const vec3& p0 = positions[indices[i]];
+    vec3 normal = cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+    if(degenerate(normal)) { continue; }
+    normal = normalize(normal);
+    Quadric quadric = planeQuadric(normal, -dot(normal, p0));
+    for(u32 j = 0; j < 3; j++) {
+      quadrics[indices[i + j]] += quadric;
+    }
+  }
+
+  struct Collapse {
+    u32 from;
+    u32 to;
+    f64 error;
+  };
+  std::vector<Collapse> collapses;
+  std::vector<u32> collapseRemap(vertexCount);
+  std::vector<u8> touched(vertexCount);
+  std::vector<u32> adjacencyOffsets(vertexCount + 1);
+  std::vector<u32> adjacency;
+  const f64 maxError = (f64)targetError * targetError;
+  f64 largestError = 0.0;
+
+  while(indexCount > targetIndexCount) {
+    // vertex to triangle adjacency of the current indices
+    std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+    for(u32 i = 0; i < indexCount; i++) { adjacencyOffsets[indices[i] + 1]++; }
+    for(u32 vertex = 0; vertex < vertexCount; vertex++) { adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex]; }
+    adjacency.resize(indexCount);
+    {
+      std::vector<u32> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+      for(u32 i = 0; i < indexCount; i++) { adjacency[adjacencyFill[indices[i]]++] = i / 3; }
+    }
+
+    collapses.clear();
+    for(u32 i = 0; i < indexCount; i += 3) {
+      for(u32 j = 0; j < 3; j++) {
+        u32 a = indices[i + j];
+        u32 b = indices[i + ((j + 1) % 3)];
+        if(a == b) { continue; }
+        Quadric edgeQuadric = quadrics[a] + quadrics[b];
+        if(!locked[a]) { collapses.push_back(Collapse{a, b, quadricError(edgeQuadric, positions[b])}); }
+        if(!locked[b]) { collapses.push_back(Collapse{b, a, quadricError(edgeQuadric, positions[a])}); }
+      }
+    }
+    std::sort(collapses.begin(), collapses.end(), [](const Collapse& c1, const Collapse& c2) { return c1.error < c2.error; });
+
+    for(u32 vertex = 0; vertex < vertexCount; vertex++) { collapseRemap[vertex] = vertex; }
+    std::fill(touched.begin(), touched.end(), false);
+    u32 collapseCount = 0;
+    u32 estimatedIndexCount = indexCount;
+    for(const Collapse& collapse : collapses) {
+      if(collapse.error > maxError || estimatedIndexCount <= targetIndexCount) { break; }
+      if(touched[collapse.from] || touched[collapse.to]) { continue; }
+
+      const u32* fromTriangles = adjacency.data() + adjacencyOffsets[collapse.from];
+      u32 fromTriangleCount = adjacencyOffsets[collapse.from + 1] - adjacencyOffsets[collapse.from];
+      if(collapseFlipsTriangle(collapse.from, collapse.to, indices, positions, fromTriangles, fromTriangleCount)) { continue; }
+
+      collapseRemap[collapse.from] = collapse.to;
+      quadrics[collapse.to] += quadrics[collapse.from];
+      largestError = Max(largestError, collapse.error);
+      collapseCount++;
+      // NOTE: Every triangle around "from" changes, their vertices can't collapse again until the next pass
+      for(u32 i = 0; i < fromTriangleCount; i++) {
+        const u32* triangleIndices = indices + (fromTriangles[i] * 3);
+        touched[triangleIndices[0]] = touched[triangleIndices[1]] = touched[triangleIndices[2]] = true;
+        if(triangleIndices[0] == collapse.to || triangleIndices[1] == collapse.to || triangleIndices[2] == collapse.to) {
+          estimatedIndexCount -= 3;
+        }
+      }
+    }
+    if(collapseCount == 0) { break; }
+
+    // apply collapses and remove the triangles that collapsed to nothing
+    u32 collapsedIndexCount = 0;
+    for(u32 i = 0; i < indexCount; i += 3) {
+      u32 a = collapseRemap[indices[i]];
+      u32 b = collapseRemap[indices[i + 1]];
+      u32 c = collapseRemap[indices[i + 2]];
+      if(a == b || b == c || c == a) { continue; }
+      indices[collapsedIndexCount++] = a;
+      indices[collapsedIndexCount++] = b;
+      indices[collapsedIndexCount++] = c;
+    }
+    indexCount = collapsedIndexCount;
+  }
+
+  if(resultError != nullptr) { *resultError = (f32)sqrt(largestError); }
+  return indexCount;
+}
+
+/*
+ * Coarsest level of detail whose error covers at most maxPixelError pixels on screen
+ * parameters:
+ * lodErrors are increasing by level, in the same units as pixelsPerUnit's
+ * pixelsPerUnit is the on-screen size in pixels of one unit
+ */
+u32 selectLod(const f32* lodErrors, u32 lodCount, f32 pixelsPerUnit, f32 maxPixelError) {
+  u32 lod = 0;
+  while((lod + 1) < lodCount && (lodErrors[lod + 1] * pixelsPerUnit) <= maxPixelError) { lod++; }
+  return lod;
+}
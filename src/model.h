@@ -8,9 +8,16 @@ struct TextureData {
   vec4 baseColor;
 };
 
+#define MAX_MESH_LODS 4
+#define MESH_LOD_MAX_ERROR 0.05f // NOTE: largest error of a single simplification step, relative to the mesh's bounding box diagonal
+#define MESH_LOD_MAX_PIXEL_ERROR 1.0f
+
 struct Mesh {
-  VertexAtt vertexAtt;
+  VertexAtt lods[MAX_MESH_LODS]; // NOTE: lods[0] is full detail, every level shares the vertex data of lods[0]
+  f32 lodErrors[MAX_MESH_LODS]; // NOTE: upper bound on each level's deviation from lods[0], in model space units
+  u32 lodCount;
   TextureData textureData;
+  BoundingBox boundingBox; // NOTE: PosNormTexVertex positions are quantized relative to these bounds
 };
 
 struct Model {
@@ -24,8 +31,16 @@ b32 baseColorValid(const TextureData& textureData) {
   return textureData.baseColor.w != 0.0f;
 }
 
+u32 shaderPermutationFlags(const TextureData& textureData) {
+  u32 flags = 0;
+  if(textureData.albedoTextureId != TEXTURE_ID_NO_TEXTURE) { flags |= ShaderPermutation_HasAlbedoMap; }
+  if(textureData.normalTextureId != TEXTURE_ID_NO_TEXTURE) { flags |= ShaderPermutation_HasNormalMap; }
+  return flags;
+}
+
 void loadModelTexture(u32* textureId, tinygltf::Image* image, b32 inputSRGB = false)
 {
+  PROFILE_SCOPE("loadModelTexture");
   glGenTextures(1, textureId);
   glBindTexture(GL_TEXTURE_2D, *textureId);
 
@@ -87,140 +102,236 @@ void initializeModelVertexData(tinygltf::Model* gltfModel, Model* model)
   struct gltfAttributeMetadata {
     u32 accessorIndex;
     u32 numComponents;
-    u32 bufferViewIndex;
-    u32 bufferIndex;
-    u64 bufferByteOffset;
-    u64 bufferByteLength;
+    u32 count;
+    u32 byteStride;
+    s32 componentType;
+    u8* data;
+  };
+
+  struct gltfPrimitiveRef {
+    s32 materialIndex;
+    const tinygltf::Primitive* primitive;
   };
 
   const char* positionIndexKeyString = "POSITION";
   const char* normalIndexKeyString = "NORMAL";
   const char* texture0IndexKeyString = "TEXCOORD_0";
 
-  model->meshCount = (u32)gltfModel->meshes.size();
-  Assert(model->meshCount != 0);
-  model->meshes = new Mesh[model->meshCount];
   std::vector<tinygltf::Accessor>* gltfAccessors = &gltfModel->accessors;
   std::vector<tinygltf::BufferView>* gltfBufferViews = &gltfModel->bufferViews;
 
-  auto populateAttributeMetadata = [gltfAccessors, gltfBufferViews](const char* keyString, const tinygltf::Primitive& gltfPrimitive) -> gltfAttributeMetadata {
+  auto populateAttributeMetadata = [gltfModel, gltfAccessors, gltfBufferViews](const char* keyString, const tinygltf::Primitive& gltfPrimitive) -> gltfAttributeMetadata {
     gltfAttributeMetadata result;
     result.accessorIndex = gltfPrimitive.attributes.at(keyString);
-    result.numComponents = tinygltf::GetNumComponentsInType(gltfAccessors->at(result.accessorIndex).type);
-    result.bufferViewIndex = gltfAccessors->at(result.accessorIndex).bufferView;
-    result.bufferIndex = gltfBufferViews->at(result.bufferViewIndex).buffer;
-    result.bufferByteOffset = gltfBufferViews->at(result.bufferViewIndex).byteOffset;
-    result.bufferByteLength = gltfBufferViews->at(result.bufferViewIndex).byteLength;
+    const tinygltf::Accessor& accessor = gltfAccessors->at(result.accessorIndex);
+    const tinygltf::BufferView& bufferView = gltfBufferViews->at(accessor.bufferView);
+    result.numComponents = tinygltf::GetNumComponentsInType(accessor.type);
+    // NOTE: glTF only allows integer components for the attributes we read when they are normalized
+    Assert(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.normalized);
+    result.componentType = accessor.componentType;
+    result.count = (u32)accessor.count;
+    result.byteStride = bufferView.byteStride != 0 ? (u32)bufferView.byteStride : result.numComponents * tinygltf::GetComponentSizeInBytes(accessor.componentType);
+    result.data = gltfModel->buffers[bufferView.buffer].data.data() + bufferView.byteOffset + accessor.byteOffset;
     return result;
   };
 
-  for(u32 i = 0; i < model->meshCount; ++i) {
-    Mesh* mesh = &model->meshes[i];
-
-    tinygltf::Mesh gltfMesh = gltfModel->meshes[i];
-    Assert(!gltfMesh.primitives.empty());
-    // TODO: handle meshes that have more than one primitive
-    tinygltf::Primitive gltfPrimitive = gltfMesh.primitives[0];
-    Assert(gltfPrimitive.indices > -1); // TODO: Should we deal with models that don't have indices?
-
-    // TODO: Allow variability in attributes beyond POSITION, NORMAL, TEXCOORD_0?
-    Assert(gltfPrimitive.attributes.find(positionIndexKeyString) != gltfPrimitive.attributes.end());
-    gltfAttributeMetadata positionAttribute = populateAttributeMetadata(positionIndexKeyString, gltfPrimitive);
-    f64* minValues = gltfModel->accessors[positionAttribute.accessorIndex].minValues.data();
-    f64* maxValues = gltfModel->accessors[positionAttribute.accessorIndex].maxValues.data();
-    model->boundingBox.min = {(f32)minValues[0], (f32)minValues[1], (f32)minValues[2]};
-    model->boundingBox.diagonal = vec3{(f32)maxValues[0], (f32)maxValues[1], (f32)maxValues[2]} - model->boundingBox.min;
-
-    b32 normalAttributesAvailable = gltfPrimitive.attributes.find(normalIndexKeyString) != gltfPrimitive.attributes.end();
-    gltfAttributeMetadata normalAttribute{};
-    if(normalAttributesAvailable) { // normal attribute data
-      normalAttribute = populateAttributeMetadata(normalIndexKeyString, gltfPrimitive);
-      Assert(positionAttribute.bufferIndex == normalAttribute.bufferIndex);
+  auto readAttributeComponent = [](const gltfAttributeMetadata& attribute, u32 vertexIndex, u32 component) -> f32 {
+    const u8* element = attribute.data + (vertexIndex * attribute.byteStride);
+    switch(attribute.componentType) {
+      case TINYGLTF_COMPONENT_TYPE_FLOAT: return ((const f32*)element)[component];
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: return ((const u8*)element)[component] / 255.0f;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: return ((const u16*)element)[component] / 65535.0f;
+      case TINYGLTF_COMPONENT_TYPE_BYTE: return Max(((const s8*)element)[component] / 127.0f, -1.0f);
+      case TINYGLTF_COMPONENT_TYPE_SHORT: return Max(((const s16*)element)[component] / 32767.0f, -1.0f);
+      default: Assert(false); return 0.0f;
     }
+  };
 
-    b32 texture0AttributesAvailable = gltfPrimitive.attributes.find(texture0IndexKeyString) != gltfPrimitive.attributes.end();
-    gltfAttributeMetadata texture0Attribute{};
-    if(texture0AttributesAvailable) { // texture 0 uv coord attribute data
-      texture0Attribute = populateAttributeMetadata(texture0IndexKeyString, gltfPrimitive);
-      Assert(positionAttribute.bufferIndex == texture0Attribute.bufferIndex);
+  // NOTE: The primitives of every glTF mesh are flattened and those sharing a material are merged into one Mesh,
+  // each Mesh is a single draw
+  // TODO: glTF node transforms are ignored, all meshes are assumed to be authored in model space
+  std::vector<gltfPrimitiveRef> primitives;
+  for(const tinygltf::Mesh& gltfMesh : gltfModel->meshes) {
+    for(const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+      if(gltfPrimitive.mode != TINYGLTF_MODE_TRIANGLES && gltfPrimitive.mode != -1) { // NOTE: -1 defaults to triangles
+        printf("Warning: Skipped glTF primitive with unsupported mode %d\n", gltfPrimitive.mode);
+        continue;
+      }
+      // TODO: Allow variability in attributes beyond POSITION, NORMAL, TEXCOORD_0?
+      if(gltfPrimitive.attributes.find(positionIndexKeyString) == gltfPrimitive.attributes.end()) {
+        printf("Warning: Skipped glTF primitive without POSITION attribute\n");
+        continue;
+      }
+      primitives.push_back(gltfPrimitiveRef{gltfPrimitive.material, &gltfPrimitive});
     }
+  }
+  std::stable_sort(primitives.begin(), primitives.end(), [](const gltfPrimitiveRef& a, const gltfPrimitiveRef& b) {
+    return a.materialIndex < b.materialIndex;
+  });
 
-    // TODO: Handle vertex attributes that don't share the same buffer?
-    u32 vertexAttBufferIndex = positionAttribute.bufferIndex;
-    Assert(gltfModel->buffers.size() > vertexAttBufferIndex);
-
-    u32 indicesAccessorIndex = gltfPrimitive.indices;
-    tinygltf::BufferView indicesGLTFBufferView = gltfBufferViews->at(gltfAccessors->at(indicesAccessorIndex).bufferView);
-    u32 indicesGLTFBufferIndex = indicesGLTFBufferView.buffer;
-    u64 indicesGLTFBufferByteOffset = indicesGLTFBufferView.byteOffset;
-    u64 indicesGLTFBufferByteLength = indicesGLTFBufferView.byteLength;
-
-    u64 minOffset = Min(positionAttribute.bufferByteOffset, Min(texture0Attribute.bufferByteOffset, normalAttribute.bufferByteOffset));
-    u8* vertexAttributeDataOffset = gltfModel->buffers[indicesGLTFBufferIndex].data.data() + minOffset;
-    u8* indicesDataOffset = gltfModel->buffers[indicesGLTFBufferIndex].data.data() + indicesGLTFBufferByteOffset;
-
-    mesh->vertexAtt.indexCount = u32(gltfAccessors->at(indicesAccessorIndex).count);
-    mesh->vertexAtt.indexTypeSizeInBytes = tinygltf::GetComponentSizeInBytes(gltfAccessors->at(indicesAccessorIndex).componentType);
-    // TODO: Handle the possibility of the three attributes not being side-by-side in the buffer
-    u64 sizeOfAttributeData = positionAttribute.bufferByteLength + normalAttribute.bufferByteLength + texture0Attribute.bufferByteLength;
-    Assert(gltfModel->buffers[vertexAttBufferIndex].data.size() >= sizeOfAttributeData);
-    const u32 positionAttributeIndex = 0;
-    const u32 normalAttributeIndex = 1;
-    const u32 texture0AttributeIndex = 2;
-
-    glGenVertexArrays(1, &mesh->vertexAtt.arrayObject);
-    glGenBuffers(1, &mesh->vertexAtt.bufferObject);
-    glGenBuffers(1, &mesh->vertexAtt.indexObject);
-
-    glBindVertexArray(mesh->vertexAtt.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh->vertexAtt.bufferObject);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeOfAttributeData,
-                 vertexAttributeDataOffset,
-                 GL_STATIC_DRAW);
-
-    // set the vertex attributes (position and texture)
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex,
-                          positionAttribute.numComponents, // attribute size
-                          GL_FLOAT, // type of data
-                          GL_FALSE, // should data be normalized
-                          positionAttribute.numComponents * sizeof(f32),// stride
-                          (void*)(positionAttribute.bufferByteOffset - minOffset)); // offset of first component
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    // normal attribute
-    if(normalAttributesAvailable) {
-      glVertexAttribPointer(normalAttributeIndex,
-                            normalAttribute.numComponents, // attribute size
-                            GL_FLOAT,
-                            GL_FALSE,
-                            normalAttribute.numComponents * sizeof(f32),
-                            (void*)(normalAttribute.bufferByteOffset - minOffset));
-      glEnableVertexAttribArray(normalAttributeIndex);
-    }
+  model->meshCount = 0;
+  for(u32 i = 0; i < primitives.size(); ++i) {
+    if(i == 0 || primitives[i].materialIndex != primitives[i - 1].materialIndex) { model->meshCount++; }
+  }
+  Assert(model->meshCount != 0);
+  model->meshes = new Mesh[model->meshCount];
+
+  u32 meshPrimitivesBegin = 0;
+  for(u32 i = 0; i < model->meshCount; ++i) {
+    Mesh* mesh = &model->meshes[i];
 
-    // texture 0 UV Coord attribute
-    if(texture0AttributesAvailable) {
-      glVertexAttribPointer(texture0AttributeIndex,
-                            texture0Attribute.numComponents, // attribute size
-                            GL_FLOAT,
-                            GL_FALSE,
-                            texture0Attribute.numComponents * sizeof(f32),
-                            (void*)(texture0Attribute.bufferByteOffset - minOffset));
-      glEnableVertexAttribArray(texture0AttributeIndex);
+    s32 gltfMaterialIndex = primitives[meshPrimitivesBegin].materialIndex;
+    u32 meshPrimitivesEnd = meshPrimitivesBegin + 1;
+    while(meshPrimitivesEnd < primitives.size() && primitives[meshPrimitivesEnd].materialIndex == gltfMaterialIndex) { meshPrimitivesEnd++; }
+
+    vec3 boundsMin{F32_MAX, F32_MAX, F32_MAX};
+    vec3 boundsMax{-F32_MAX, -F32_MAX, -F32_MAX};
+    // NOTE: Bounds of the decoded positions. Accessor min/max can't be used, they are in the accessor's component
+    // type and so are raw integers for normalized positions.
+    for(u32 primitiveIndex = meshPrimitivesBegin; primitiveIndex < meshPrimitivesEnd; primitiveIndex++) {
+      gltfAttributeMetadata positionAttribute = populateAttributeMetadata(positionIndexKeyString, *primitives[primitiveIndex].primitive);
+      Assert(positionAttribute.numComponents == 3);
+      for(u32 vertexIndex = 0; vertexIndex < positionAttribute.count; vertexIndex++) {
+        for(u32 axis = 0; axis < 3; axis++) {
+          f32 position = readAttributeComponent(positionAttribute, vertexIndex, axis);
+          boundsMin.val[axis] = Min(boundsMin.val[axis], position);
+          boundsMax.val[axis] = Max(boundsMax.val[axis], position);
+        }
+      }
     }
+    mesh->boundingBox.min = boundsMin;
+    mesh->boundingBox.diagonal = boundsMax - boundsMin;
+    model->boundingBox = i == 0 ? mesh->boundingBox : boundingBoxUnion(model->boundingBox, mesh->boundingBox);
+
+    // NOTE: All glTF primitives are repacked into quantized PosNormTexVertex, missing attributes are left zeroed
+    std::vector<PosNormTexVertex> vertices;
+    std::vector<vec3> positions;
+    std::vector<u32> indices;
+    vec3 quantizeScale;
+    for(u32 axis = 0; axis < 3; axis++) {
+      quantizeScale.val[axis] = mesh->boundingBox.diagonal.val[axis] > 0.0f ? 1.0f / mesh->boundingBox.diagonal.val[axis] : 0.0f;
+    }
+    for(u32 primitiveIndex = meshPrimitivesBegin; primitiveIndex < meshPrimitivesEnd; primitiveIndex++) {
+      const tinygltf::Primitive& gltfPrimitive = *primitives[primitiveIndex].primitive;
+      gltfAttributeMetadata positionAttribute = populateAttributeMetadata(positionIndexKeyString, gltfPrimitive);
+      Assert(positionAttribute.numComponents == 3);
+      u32 firstVertex = (u32)vertices.size();
+      u32 primitiveVertexCount = positionAttribute.count;
+      vertices.resize(firstVertex + primitiveVertexCount, PosNormTexVertex{});
+      positions.resize(firstVertex + primitiveVertexCount);
+      PosNormTexVertex* primitiveVertices = vertices.data() + firstVertex;
+      vec3* primitivePositions = positions.data() + firstVertex;
+
+      for(u32 vertexIndex = 0; vertexIndex < primitiveVertexCount; vertexIndex++) {
+        for(u32 axis = 0; axis < 3; axis++) {
+          f32 position = readAttributeComponent(positionAttribute, vertexIndex, axis);
+          primitivePositions[vertexIndex].val[axis] = position;
+          primitiveVertices[vertexIndex].position[axis] = quantizeUnorm16((position - mesh->boundingBox.min.val[axis]) * quantizeScale.val[axis]);
+        }
+      }
 
-    // bind element buffer object to give indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->vertexAtt.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesGLTFBufferByteLength, indicesDataOffset, GL_STATIC_DRAW);
+      b32 normalAttributesAvailable = gltfPrimitive.attributes.find(normalIndexKeyString) != gltfPrimitive.attributes.end();
+      if(normalAttributesAvailable) { // normal attribute data
+        gltfAttributeMetadata normalAttribute = populateAttributeMetadata(normalIndexKeyString, gltfPrimitive);
+        Assert(normalAttribute.numComponents == 3 && normalAttribute.count == primitiveVertexCount);
+        for(u32 vertexIndex = 0; vertexIndex < primitiveVertexCount; vertexIndex++) {
+          vec3 normal = {readAttributeComponent(normalAttribute, vertexIndex, 0),
+                         readAttributeComponent(normalAttribute, vertexIndex, 1),
+                         readAttributeComponent(normalAttribute, vertexIndex, 2)};
+          vec2 encodedNormal = octEncode(normal);
+          primitiveVertices[vertexIndex].normal[0] = quantizeSnorm16(encodedNormal.x);
+          primitiveVertices[vertexIndex].normal[1] = quantizeSnorm16(encodedNormal.y);
+        }
+      }
 
-    // unbind VBO & VAO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+      b32 texture0AttributesAvailable = gltfPrimitive.attributes.find(texture0IndexKeyString) != gltfPrimitive.attributes.end();
+      if(texture0AttributesAvailable) { // texture 0 uv coord attribute data
+        gltfAttributeMetadata texture0Attribute = populateAttributeMetadata(texture0IndexKeyString, gltfPrimitive);
+        Assert(texture0Attribute.numComponents == 2 && texture0Attribute.count == primitiveVertexCount);
+        for(u32 vertexIndex = 0; vertexIndex < primitiveVertexCount; vertexIndex++) {
+          primitiveVertices[vertexIndex].texCoord[0] = halfFloat(readAttributeComponent(texture0Attribute, vertexIndex, 0));
+          primitiveVertices[vertexIndex].texCoord[1] = halfFloat(readAttributeComponent(texture0Attribute, vertexIndex, 1));
+        }
+      }
+
+      if(gltfPrimitive.indices > -1) {
+        const tinygltf::Accessor& indicesAccessor = gltfAccessors->at(gltfPrimitive.indices);
+        const tinygltf::BufferView& indicesGLTFBufferView = gltfBufferViews->at(indicesAccessor.bufferView);
+        u8* indicesData = gltfModel->buffers[indicesGLTFBufferView.buffer].data.data() + indicesGLTFBufferView.byteOffset + indicesAccessor.byteOffset;
+        u32 primitiveIndexCount = u32(indicesAccessor.count);
+        u32 firstIndex = (u32)indices.size();
+        indices.resize(firstIndex + primitiveIndexCount);
+        switch(tinygltf::GetComponentSizeInBytes(indicesAccessor.componentType)) {
+          case 1: std::copy((u8*)indicesData, (u8*)indicesData + primitiveIndexCount, indices.begin() + firstIndex); break;
+          case 2: std::copy((u16*)indicesData, (u16*)indicesData + primitiveIndexCount, indices.begin() + firstIndex); break;
+          case 4: std::copy((u32*)indicesData, (u32*)indicesData + primitiveIndexCount, indices.begin() + firstIndex); break;
+          default: Assert(false);
+        }
+        for(u32 index = firstIndex; index < indices.size(); index++) { indices[index] += firstVertex; }
+      } else { // NOTE: non-indexed primitives get indices that share their identical vertices
+        std::vector<u32> primitiveIndices(primitiveVertexCount);
+        u32 uniqueVertexCount = generateIndices(primitiveVertices, primitiveVertexCount, sizeof(PosNormTexVertex), primitiveIndices.data());
+        for(u32 vertexIndex = 0; vertexIndex < primitiveVertexCount; vertexIndex++) {
+          primitivePositions[primitiveIndices[vertexIndex]] = primitivePositions[vertexIndex];
+          indices.push_back(firstVertex + primitiveIndices[vertexIndex]);
+        }
+        vertices.resize(firstVertex + uniqueVertexCount);
+        positions.resize(firstVertex + uniqueVertexCount);
+      }
+    }
+    u32 vertexCount = (u32)vertices.size();
+    u32 indexCount = (u32)indices.size();
+    Assert(indexCount % 3 == 0);
+
+    // mesh optimization & level of detail generation
+    optimizeVertexCache(indices.data(), indexCount, vertexCount);
+    optimizeOverdraw(indices.data(), indexCount, positions.data(), vertexCount);
+
+    // NOTE: Each level simplifies the previous one down to half its triangles, all levels are appended to indices
+    u32 lodFirstIndices[MAX_MESH_LODS] = {0};
+    u32 lodIndexCounts[MAX_MESH_LODS] = {indexCount};
+    mesh->lodErrors[0] = 0.0f;
+    mesh->lodCount = 1;
+    f32 maxLodError = MESH_LOD_MAX_ERROR * magnitude(mesh->boundingBox.diagonal);
+    while(mesh->lodCount < MAX_MESH_LODS) {
+      u32 previousLod = mesh->lodCount - 1;
+      std::vector<u32> lodIndices(indices.begin() + lodFirstIndices[previousLod],
+                                  indices.begin() + lodFirstIndices[previousLod] + lodIndexCounts[previousLod]);
+      u32 targetIndexCount = (lodIndexCounts[previousLod] / 6) * 3;
+      f32 lodError;
+      u32 lodIndexCount = simplifyMesh(lodIndices.data(), lodIndexCounts[previousLod], positions.data(), vertexCount,
+                                       targetIndexCount, maxLodError, &lodError);
+      if(lodIndexCount == 0 || lodIndexCount > (lodIndexCounts[previousLod] * 4) / 5) { break; } // NOTE: not worth another level
+      optimizeVertexCache(lodIndices.data(), lodIndexCount, vertexCount);
+
+      u32 lod = mesh->lodCount++;
+      lodFirstIndices[lod] = (u32)indices.size();
+      lodIndexCounts[lod] = lodIndexCount;
+      mesh->lodErrors[lod] = mesh->lodErrors[previousLod] + lodError;
+      indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + lodIndexCount);
+    }
+    u32 totalIndexCount = (u32)indices.size();
+
+    // NOTE: Levels only reference vertices of lods[0], so fetch order is determined by lods[0] first
+    vertexCount = optimizeVertexFetch(indices.data(), totalIndexCount, vertices.data(), vertexCount, sizeof(PosNormTexVertex));
+
+    VertexAtt vertexAtt{};
+    vertexAtt.format = VertexFormat_PosNormTex;
+    vertexAtt.baseVertex = addVertices(VertexFormat_PosNormTex, vertices.data(), vertexCount);
+    if(vertexCount <= (U16_MAX + 1)) { // NOTE: narrow to 16-bit indices whenever possible
+      std::vector<u16> narrowIndices(indices.begin(), indices.end());
+      vertexAtt.firstIndex = addIndices(VertexFormat_PosNormTex, narrowIndices.data(), totalIndexCount, sizeof(u16),
+                                        &vertexAtt.indexTypeSizeInBytes);
+    } else {
+      vertexAtt.firstIndex = addIndices(VertexFormat_PosNormTex, indices.data(), totalIndexCount, sizeof(u32),
+                                        &vertexAtt.indexTypeSizeInBytes);
+    }
+    for(u32 lod = 0; lod < mesh->lodCount; lod++) {
+      mesh->lods[lod] = vertexAtt;
+      mesh->lods[lod].firstIndex += lodFirstIndices[lod];
+      mesh->lods[lod].indexCount = lodIndexCounts[lod];
+    }
 
-    s32 gltfMaterialIndex = gltfPrimitive.material;
     if(gltfMaterialIndex >= 0) {
       tinygltf::Material gltfMaterial = gltfModel->materials[gltfMaterialIndex];
       // TODO: Handle more then just TEXCOORD_0 vertex attribute?
@@ -253,10 +364,13 @@ void initializeModelVertexData(tinygltf::Model* gltfModel, Model* model)
       mesh->textureData.albedoTextureId = TEXTURE_ID_NO_TEXTURE;
       mesh->textureData.baseColor = {};
     }
+    meshPrimitivesBegin = meshPrimitivesEnd;
   }
+
 }
 
 void loadModel(const char* filePath, Model* returnModel) {
+  PROFILE_SCOPE("loadModel");
   tinygltf::TinyGLTF loader;
   std::string err;
   std::string warn;
@@ -314,22 +428,32 @@ void loadModels(const char** filePaths, u32 count, Model** returnModels) {
   }
 }
 
+// NOTE: Transform for the mesh's vertices in model space, folding in the dequantization of PosNormTexVertex positions
+inline mat4 meshModelMat(const Mesh& mesh, const mat4& modelMat) {
+  if(mesh.lods[0].format != VertexFormat_PosNormTex) { return modelMat; }
+  return modelMat * scaleTrans_mat4(mesh.boundingBox.diagonal, mesh.boundingBox.min);
+}
+
+// NOTE: Coarsest level whose error stays under MESH_LOD_MAX_PIXEL_ERROR when a model space unit covers pixelsPerUnit pixels
+u32 selectMeshLod(const Mesh& mesh, f32 pixelsPerUnit) {
+  return selectLod(mesh.lodErrors, mesh.lodCount, pixelsPerUnit, MESH_LOD_MAX_PIXEL_ERROR);
+}
+
 void drawModel(const Model& model) {
   for(u32 i = 0; i < model.meshCount; ++i) {
     Mesh* meshPtr = model.meshes + i;
-    drawTriangles(&meshPtr->vertexAtt);
+    drawTriangles(&meshPtr->lods[0]);
   }
 }
 
+// NOTE: Model vertex data lives in the global vertex buffers and is freed with freeToVertexBufferMark()
 void deleteModels(Model* models, u32 count) {
-  std::vector<VertexAtt> vertexAtts;
   std::vector<GLuint> textureData;
 
   for(u32 i = 0; i < count; ++i) {
     Model* modelPtr = models + i;
-    for(u32 i = 0; i < modelPtr->meshCount; ++i) {
-      Mesh* meshPtr = modelPtr->meshes;
-      vertexAtts.push_back(meshPtr->vertexAtt);
+    for(u32 j = 0; j < modelPtr->meshCount; ++j) {
+      Mesh* meshPtr = modelPtr->meshes + j;
       TextureData textureDatum = meshPtr->textureData;
       if(textureDatum.normalTextureId != TEXTURE_ID_NO_TEXTURE) {
         textureData.push_back(textureDatum.normalTextureId);
@@ -343,6 +467,5 @@ void deleteModels(Model* models, u32 count) {
     *modelPtr = {}; // clear model to zero
   }
 
-  deleteVertexAtts(vertexAtts.data(), (u32)vertexAtts.size());
   glDeleteTextures((GLsizei)textureData.size(), textureData.data());
 }
\ No newline at end of file
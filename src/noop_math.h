@@ -217,7 +217,15 @@ inline f32 smoothStep(f32 edge1, f32 edge2, f32 x) {
 
 inline f32 lerp(f32 a, f32 b, f32 t) {
   Assert(t >= 0.0f && t <= 1.0f);
-  return a - ((a + b) * t);
+  return a + ((b - a) * t);
+}
+
+// NOTE: radians, turns the shortest way around the circle
+inline f32 lerpAngle(f32 a, f32 b, f32 t) {
+  f32 turn = fmodf(b - a, Tau32);
+  if(turn > Pi32) { turn -= Tau32; }
+  else if(turn < -Pi32) { turn += Tau32; }
+  return a + (turn * t);
 }
 
 inline f32 sign(f32 x) {
@@ -301,7 +309,7 @@ inline vec2 operator/(const vec2& xy, const f32 s) {
 
 inline vec2 lerp(const vec2& a, const vec2& b, f32 t) {
   Assert(t >= 0.0f && t <= 1.0f);
-  return a - ((a + b) * t);
+  return a + ((b - a) * t);
 }
 
 // vec3
@@ -416,7 +424,7 @@ inline b32 similarDirection(const vec3& v1, const vec3& v2) {
 
 inline vec3 lerp(const vec3& a, const vec3& b, f32 t) {
   Assert(t >= 0.0f && t <= 1.0f);
-  return a - ((a + b) * t);
+  return a + ((b - a) * t);
 }
 
 // vec4
@@ -506,7 +514,7 @@ inline vec4 operator/(const vec4& xyzw, const f32 s) {
 
 inline vec4 lerp(const vec4& a, const vec4& b, f32 t) {
   Assert(t >= 0.0f && t <= 1.0f);
-  return a - ((a + b) * t);
+  return a + ((b - a) * t);
 }
 
 inline vec4 operator/(const vec4& xyzw1, const vec4& xyzw2) {
@@ -669,7 +677,7 @@ inline quaternion operator/(const quaternion& q1, const f32 s) {
 
 quaternion lerp(quaternion a, quaternion b, f32 t) {
   Assert(t >= 0.0f && t <= 1.0f);
-  return normalize(a - ((a + b) * t));
+  return normalize(a + ((b - a) * t));
 }
 
 // spherical linear interpolation
@@ -788,16 +796,43 @@ mat3 operator*(const mat3& A, const mat3& B) {
   return result;
 }
 
+inline f32 determinant(const mat3& A) {
+  return dot(A.col[0], cross(A.col[1], A.col[2]));
+}
+
+// NOTE: Assumes A is invertible
+mat3 inverse(const mat3& A) {
+  f32 det = determinant(A);
+  Assert(det != 0.0f);
+  f32 invDet = 1.0f / det;
+
+  // rows of the inverse are the cross products of the columns of A
+  mat3 inverseTranspose;
+  inverseTranspose.col[0] = cross(A.col[1], A.col[2]) * invDet;
+  inverseTranspose.col[1] = cross(A.col[2], A.col[0]) * invDet;
+  inverseTranspose.col[2] = cross(A.col[0], A.col[1]) * invDet;
+  return transpose(inverseTranspose);
+}
+
 // mat4
 inline mat4 Mat4(mat3 M) {
   return mat4{
-          M.val2d[0][1], M.val2d[0][1], M.val2d[0][1], 0.0f,
-          M.val2d[0][1], M.val2d[0][1], M.val2d[0][1], 0.0f,
-          M.val2d[0][1], M.val2d[0][1], M.val2d[0][1], 0.0f,
+          M.val2d[0][0], M.val2d[0][1], M.val2d[0][2], 0.0f,
+          M.val2d[1][0], M.val2d[1][1], M.val2d[1][2], 0.0f,
+          M.val2d[2][0], M.val2d[2][1], M.val2d[2][2], 0.0f,
           0.0f, 0.0f, 0.0f, 1.0f,
   };
 }
 
+// NOTE: upper-left 3x3 of the mat4
+inline mat3 Mat3(const mat4& M) {
+  return mat3{
+          M.val2d[0][0], M.val2d[0][1], M.val2d[0][2],
+          M.val2d[1][0], M.val2d[1][1], M.val2d[1][2],
+          M.val2d[2][0], M.val2d[2][1], M.val2d[2][2],
+  };
+}
+
 inline mat4 identity_mat4() {
   return mat4 {
           1.0f, 0.0f, 0.0f, 0.0f,
@@ -989,6 +1024,11 @@ mat4 operator*(const mat4& A, const mat4& B) {
   return result;
 }
 
+// NOTE: Inverse transpose of the upper-left 3x3. Only needed when the model matrix contains non-uniform scale.
+inline mat3 normalMat(const mat4& modelMat) {
+  return transpose(inverse(Mat3(modelMat)));
+}
+
 // real-time rendering 4.7.2
 // ex: screenWidth = 20.0f, screenDist = 30.0f will provide the horizontal field of view
 // for a person sitting 30 inches away from a 20 inch screen, assuming the screen is
@@ -1151,6 +1191,95 @@ void adjustNearFarPerspProj(mat4* projectionMatrix, f32 n, f32 f) {
   (*projectionMatrix).val2d[3][2] = -(2.0f * f * n) / (f - n);
 }
 
+// quantization
+// NOTE: [0, 1] to [0, 65535], matches a normalized GL_UNSIGNED_SHORT vertex attribute
+inline u16 quantizeUnorm16(f32 x) {
+  return (u16)((clamp(0.0f, 1.0f, x) * 65535.0f) + 0.5f);
+}
+
+// NOTE: [-1, 1] to [-32767, 32767], matches a normalized GL_SHORT vertex attribute
+inline s16 quantizeSnorm16(f32 x) {
+  f32 scaled = clamp(-1.0f, 1.0f, x) * 32767.0f;
+  return (s16)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+inline f32 dequantizeSnorm16(s16 x) {
+  return Max(x / 32767.0f, -1.0f);
+}
+
+inline f32 signNotZero(f32 x) {
+  return x >= 0.0f ? 1.0f : -1.0f;
+}
+
+// NOTE: Unit vector to a point in the [-1, 1] square by projecting onto an octahedron and unfolding its lower half
+// source: A Survey of Efficient Representations for Independent Unit Vectors (Cigolle et al. 2014)
+inline vec2 octEncode(const vec3& unitVec) {
+  f32 l1Norm = fabsf(unitVec.x) + fabsf(unitVec.y) + fabsf(unitVec.z);
+  vec2 result{unitVec.x / l1Norm, unitVec.y / l1Norm};
+  if(unitVec.z < 0.0f) {
+    result = vec2{(1.0f - fabsf(result.y)) * signNotZero(result.x), (1.0f - fabsf(result.x)) * signNotZero(result.y)};
+  }
+  return result;
+}
+
+// NOTE: Mirrored by octDecode() in src/shaders/include/VertexDecode.glsl
+inline vec3 octDecode(vec2 encoded) {
+  vec3 result{encoded.x, encoded.y, 1.0f - fabsf(encoded.x) - fabsf(encoded.y)};
+  if(result.z < 0.0f) {
+    result.x = (1.0f - fabsf(encoded.y)) * signNotZero(encoded.x);
+    result.y = (1.0f - fabsf(encoded.x)) * signNotZero(encoded.y);
+  }
+  return normalize(result);
+}
+
+// NOTE: IEEE 754 binary16. Rounds to nearest even and overflows to infinity.
+inline u16 halfFloat(f32 x) {
+  u32 bits;
+  memcpy(&bits, &x, sizeof(bits));
+  u32 sign = (bits >> 16) & 0x8000;
+  u32 floatExponent = (bits >> 23) & 0xFF;
+  u32 mantissa = bits & 0x7FFFFF;
+  if(floatExponent == 0xFF) { // infinity or NaN
+    return (u16)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+  }
+
+  s32 exponent = (s32)floatExponent - 127 + 15;
+  if(exponent >= 31) { // too large
+    return (u16)(sign | 0x7C00);
+  }
+  if(exponent <= 0) { // half subnormal or zero
+    if(exponent < -10) { return (u16)sign; }
+    mantissa |= 0x800000; // implicit leading bit
+    u32 shift = (u32)(14 - exponent);
+    u32 half = mantissa >> shift;
+    u32 roundBit = 1u << (shift - 1);
+    if((mantissa & roundBit) && (mantissa & ((3 * roundBit) - 1))) { half++; } // round bit and (sticky bits or odd)
+    return (u16)(sign | half);
+  }
+
+  u32 half = sign | ((u32)exponent << 10) | (mantissa >> 13);
+  if((mantissa & 0x1000) && (mantissa & 0x2FFF)) { half++; } // round bit and (sticky bits or odd), may carry into exponent
+  return (u16)half;
+}
+
+inline f32 floatFromHalf(u16 half) {
+  u32 sign = (u32)(half & 0x8000) << 16;
+  u32 exponent = (half >> 10) & 0x1F;
+  u32 mantissa = half & 0x3FF;
+  u32 bits;
+  if(exponent == 0) { // subnormal or zero
+    f32 result = mantissa * (1.0f / 16777216.0f); // 2^-24
+    return sign ? -result : result;
+  } else if(exponent == 31) { // infinity or NaN
+    bits = sign | 0x7F800000 | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+  }
+  f32 result;
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
 // etc
 bool insideRect(BoundingRect boundingRect, vec2 position) {
   const vec2 boundingRectMax = boundingRect.min + boundingRect.diagonal;
@@ -1185,4 +1314,91 @@ bool overlap(BoundingBox bbA, BoundingBox bbB) {
           (bbBMax.z > bbA.min.z && bbB.min.z < bbAMax.z));   // overlap in Z
 }
 
+BoundingBox boundingBoxUnion(const BoundingBox& bbA, const BoundingBox& bbB) {
+  const vec3 bbAMax = bbA.min + bbA.diagonal;
+  const vec3 bbBMax = bbB.min + bbB.diagonal;
+  BoundingBox result;
+  result.min = {Min(bbA.min.x, bbB.min.x), Min(bbA.min.y, bbB.min.y), Min(bbA.min.z, bbB.min.z)};
+  result.diagonal = vec3{Max(bbAMax.x, bbBMax.x), Max(bbAMax.y, bbBMax.y), Max(bbAMax.z, bbBMax.z)} - result.min;
+  return result;
+}
+
+// NOTE: Axis aligned bounds of the transformed box, without transforming its eight corners
+// source: Jim Arvo "Transforming Axis-Aligned Bounding Boxes" Graphics Gems (1990)
+BoundingBox transformBoundingBox(const BoundingBox& boundingBox, const mat4& transform) {
+  const vec3 halfDiagonal = boundingBox.diagonal * 0.5f;
+  const vec3 center = (transform * Vec4(boundingBox.min + halfDiagonal, 1.0f)).xyz;
+  vec3 transformedHalfDiagonal{};
+  for(u32 i = 0; i < 3; i++) {
+    const vec3& axis = transform.col[i].xyz;
+    transformedHalfDiagonal.x += fabsf(axis.x) * halfDiagonal.val[i];
+    transformedHalfDiagonal.y += fabsf(axis.y) * halfDiagonal.val[i];
+    transformedHalfDiagonal.z += fabsf(axis.z) * halfDiagonal.val[i];
+  }
+  return BoundingBox{center - transformedHalfDiagonal, transformedHalfDiagonal * 2.0f};
+}
+
+inline f32 surfaceArea(const BoundingBox& boundingBox) {
+  const vec3& d = boundingBox.diagonal;
+  return 2.0f * ((d.x * d.y) + (d.y * d.z) + (d.z * d.x));
+}
+
+/*
+ * Slab test of a ray against a box
+ * parameters:
+ * rayInverseDirection is 1.0 / direction per component, the infinities of zero components are expected
+ * distance (optional) returns the distance along the ray to where it enters the box, 0.0 when it starts inside
+ */
+b32 rayBoxIntersection(const vec3& rayOrigin, const vec3& rayInverseDirection, const BoundingBox& boundingBox,
+                       f32 maxDistance, Out f32* distance = nullptr) {
+  f32 tEnter = 0.0f;
+  f32 tExit = maxDistance;
+  for(u32 axis = 0; axis < 3; axis++) {
+    f32 slabMin = boundingBox.min.val[axis];
+    f32 slabMax = slabMin + boundingBox.diagonal.val[axis];
+    if(isinf(rayInverseDirection.val[axis])) { // NOTE: parallel to the slab
+      if(rayOrigin.val[axis] < slabMin || rayOrigin.val[axis] > slabMax) { return false; }
+      continue;
+    }
+    f32 t1 = (slabMin - rayOrigin.val[axis]) * rayInverseDirection.val[axis];
+    f32 t2 = (slabMax - rayOrigin.val[axis]) * rayInverseDirection.val[axis];
+    tEnter = Max(tEnter, Min(t1, t2));
+    tExit = Min(tExit, Max(t1, t2));
+  }
+  if(tEnter > tExit) { return false; }
+  if(distance != nullptr) { *distance = tEnter; }
+  return true;
+}
+
+// NOTE: Planes (xyz normal pointing inward, w distance) in order left, right, bottom, top, near, far
+// source: Gribb & Hartmann "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" (2001)
+void frustumPlanes(const mat4& projectionView, Out vec4* planes) {
+  vec4 rows[4];
+  for(u32 row = 0; row < 4; row++) {
+    rows[row] = {projectionView.col[0].val[row], projectionView.col[1].val[row], projectionView.col[2].val[row], projectionView.col[3].val[row]};
+  }
+  planes[0] = rows[3] + rows[0];
+  planes[1] = rows[3] - rows[0];
+  planes[2] = rows[3] + rows[1];
+  planes[3] = rows[3] - rows[1];
+  planes[4] = rows[3] + rows[2];
+  planes[5] = rows[3] - rows[2];
+  for(u32 i = 0; i < 6; i++) {
+    planes[i] = planes[i] / magnitude(planes[i].xyz);
+  }
+}
+
+// NOTE: Conservative, boxes near frustum corners may be reported as intersecting when they are not
+b32 frustumBoxIntersection(const vec4* planes, const BoundingBox& boundingBox) {
+  for(u32 i = 0; i < 6; i++) {
+    // test the box corner furthest along the plane's normal
+    vec3 corner = boundingBox.min;
+    if(planes[i].x > 0.0f) { corner.x += boundingBox.diagonal.x; }
+    if(planes[i].y > 0.0f) { corner.y += boundingBox.diagonal.y; }
+    if(planes[i].z > 0.0f) { corner.z += boundingBox.diagonal.z; }
+    if(dot(planes[i].xyz, corner) + planes[i].w < 0.0f) { return false; }
+  }
+  return true;
+}
+
 #undef COMPARISON_EPSILON
\ No newline at end of file
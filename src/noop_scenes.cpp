@@ -8,14 +8,25 @@ GLFWwindow* createWindow();
 void initializeGLAD();
 void initializeImgui(GLFWwindow* window);
 
-int main()
+int main(int argc, char** argv)
 {
+  // NOTE: --trace-frames N captures a trace of the first N frames
+  // NOTE: --benchmark flythrough.json runs the flythrough, writes a frame time report and exits
+  // NOTE: --record-input file records the session's input, --replay-input file replays it and exits
+  LaunchOptions options{};
+  for(int argIndex = 1; argIndex < argc - 1; argIndex++) {
+    if(strcmp(argv[argIndex], "--trace-frames") == 0) { options.traceFrameCount = (u32)atoi(argv[argIndex + 1]); }
+    if(strcmp(argv[argIndex], "--benchmark") == 0) { options.flythroughFile = argv[argIndex + 1]; }
+    if(strcmp(argv[argIndex], "--record-input") == 0) { options.inputRecordFile = argv[argIndex + 1]; }
+    if(strcmp(argv[argIndex], "--replay-input") == 0) { options.inputReplayFile = argv[argIndex + 1]; }
+  }
+
   loadGLFW();
   GLFWwindow* window = createWindow();
   initializeGLAD();
   initializeInput(window);
   initializeImgui(window);
-  portalScene(window);
+  portalScene(window, options);
   glfwTerminate(); // clean up gl resources
   return 0;
 }
@@ -38,6 +49,7 @@ void initializeGLAD()
     std::cout << "Failed to initialize GLAD" << std::endl;
     exit(-1);
   }
+  installGlDebugLayer();
 }
 
 GLFWwindow* createWindow()
@@ -85,4 +97,7 @@ void initializeImgui(GLFWwindow* window) {
   // Setup Platform/Renderer bindings
   ImGui_ImplGlfw_InitForOpenGL(window, true);
   ImGui_ImplOpenGL3_Init(NULL);
+  // NOTE: Creates the renderer's device objects (ex: font atlas texture) up front, while the context is current here.
+  // ImGui::NewFrame() requires the font atlas and frames are drawn on the render thread.
+  ImGui_ImplOpenGL3_NewFrame();
 }
\ No newline at end of file
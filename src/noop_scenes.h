@@ -10,6 +10,8 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <xmmintrin.h>
 
 // platform/input
 #include <windows.h>
@@ -41,13 +43,27 @@
 #include "cstring_ring_buffer.h"
 #include "vertex_attributes.h"
 #include "file_locations.h"
+#include "flythrough.h"
 #include "save_file.h"
 #include "input.h"
+#include "timer.h"
+#include "profiler.h"
 #include "util.h"
 #include "textures.h"
 #include "shader_program.h"
+#include "mesh_optimization.h"
+#include "mesh_simplification.h"
 #include "model.h"
 #include "camera.h"
+#include "bvh.h"
+#include "collision.h"
+#include "portal_crossing.h"
+#include "lights.h"
+#include "draw_list.h"
+#include "gpu_timer.h"
+#include "gl_debug_layer.h"
+#include "render_thread.h"
+#include "trace_capture.h"
 
 #include "glfw_util.cpp"
 #include "input.cpp"
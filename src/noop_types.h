@@ -27,6 +27,8 @@ typedef s32 b32;
 #define Tau32 6.28318530717958647692f
 #define RadiansPerDegree (Pi32 / 180.0f)
 #define U32_MAX ~0u
+#define U16_MAX 0xFFFFu
+#define F32_MAX 3.402823466e+38f
 
 #define ArrayCount(Array) (sizeof(Array) / sizeof((Array)[0]))
 
@@ -0,0 +1,138 @@
+#pragma once
+
+/*
+ * Portal crossing tests, four portals per SSE instruction
+ * - Portals are upright rectangles: width runs along the xy-plane perpendicular to the normal, height along z.
+ * - A portal is crossed when a segment goes from in front of its plane to on or behind it, within its rectangle.
+ *   Testing the segment between the previous and current positions catches crossings however far apart they are.
+ */
+
+#define MAX_PORTALS 4
+#define PORTAL_LANES 4
+#define PORTAL_LANE_GROUPS ((MAX_PORTALS + PORTAL_LANES - 1) / PORTAL_LANES)
+
+struct PortalRects {
+  // NOTE: Structure of arrays, one lane per portal. Unused lanes are zeroed and never pass any test.
+  __m128 centerX[PORTAL_LANE_GROUPS], centerY[PORTAL_LANE_GROUPS], centerZ[PORTAL_LANE_GROUPS];
+  __m128 normalX[PORTAL_LANE_GROUPS], normalY[PORTAL_LANE_GROUPS], normalZ[PORTAL_LANE_GROUPS];
+  __m128 widthDirX[PORTAL_LANE_GROUPS], widthDirY[PORTAL_LANE_GROUPS];
+  __m128 halfWidth[PORTAL_LANE_GROUPS], halfHeight[PORTAL_LANE_GROUPS];
+};
+
+internal_func void setLane(__m128* lanes, u32 portalIndex, f32 value) {
+  ((f32*)(lanes + (portalIndex / PORTAL_LANES)))[portalIndex % PORTAL_LANES] = value;
+}
+
+void setPortalRect(PortalRects* rects, u32 portalIndex, const vec3& centerPosition, const vec3& normal, const vec2& dimens) {
+  Assert(portalIndex < MAX_PORTALS);
+  vec3 widthDirection = normalize(-normal.y, normal.x, 0.0f);
+  setLane(rects->centerX, portalIndex, centerPosition.x);
+  setLane(rects->centerY, portalIndex, centerPosition.y);
+  setLane(rects->centerZ, portalIndex, centerPosition.z);
+  setLane(rects->normalX, portalIndex, normal.x);
+  setLane(rects->normalY, portalIndex, normal.y);
+  setLane(rects->normalZ, portalIndex, normal.z);
+  setLane(rects->widthDirX, portalIndex, widthDirection.x);
+  setLane(rects->widthDirY, portalIndex, widthDirection.y);
+  setLane(rects->halfWidth, portalIndex, dimens.x * 0.5f);
+  setLane(rects->halfHeight, portalIndex, dimens.y * 0.5f);
+}
+
+internal_func u32 portalLaneMask(u32 portalCount, u32 group) {
+  u32 groupPortalCount = Min(portalCount - (group * PORTAL_LANES), (u32)PORTAL_LANES);
+  return (1 << groupPortalCount) - 1;
+}
+
+internal_func __m128 absLanes(__m128 v) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// NOTE: signed distance (scaled by the normal's length) of a point relative to the position in each portal lane
+internal_func __m128 portalPlaneDistances(const PortalRects& rects, u32 group, __m128 x, __m128 y, __m128 z,
+                                          Out __m128* relativeX, Out __m128* relativeY, Out __m128* relativeZ) {
+  *relativeX = _mm_sub_ps(x, rects.centerX[group]);
+  *relativeY = _mm_sub_ps(y, rects.centerY[group]);
+  *relativeZ = _mm_sub_ps(z, rects.centerZ[group]);
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(*relativeX, rects.normalX[group]), _mm_mul_ps(*relativeY, rects.normalY[group])),
+                    _mm_mul_ps(*relativeZ, rects.normalZ[group]));
+}
+
+// NOTE: lanes where a point, relative to the portal's center, falls within the portal's rectangle along the plane
+internal_func __m128 withinPortalRects(const PortalRects& rects, u32 group, __m128 relativeX, __m128 relativeY, __m128 relativeZ) {
+  __m128 widthDistance = _mm_add_ps(_mm_mul_ps(relativeX, rects.widthDirX[group]), _mm_mul_ps(relativeY, rects.widthDirY[group]));
+  return _mm_and_ps(_mm_cmplt_ps(absLanes(widthDistance), rects.halfWidth[group]),
+                    _mm_cmplt_ps(absLanes(relativeZ), rects.halfHeight[group]));
+}
+
+/*
+ * returns a bit mask of the portals whose front faces the point
+ * inFocusMask returns the bit mask of the portals facing the point that also have it in front of their rectangle
+ */
+u32 portalsFacingPoint(const PortalRects& rects, u32 portalCount, const vec3& point, Out u32* inFocusMask) {
+  const __m128 x = _mm_set1_ps(point.x);
+  const __m128 y = _mm_set1_ps(point.y);
+  const __m128 z = _mm_set1_ps(point.z);
+  u32 facingMask = 0;
+  *inFocusMask = 0;
+  for(u32 group = 0; group * PORTAL_LANES < portalCount; group++) {
+    __m128 relativeX, relativeY, relativeZ;
+    __m128 distances = portalPlaneDistances(rects, group, x, y, z, &relativeX, &relativeY, &relativeZ);
+    __m128 facing = _mm_cmpgt_ps(distances, _mm_setzero_ps());
+    __m128 inFocus = _mm_and_ps(facing, withinPortalRects(rects, group, relativeX, relativeY, relativeZ));
+    u32 laneMask = portalLaneMask(portalCount, group);
+    facingMask |= ((u32)_mm_movemask_ps(facing) & laneMask) << (group * PORTAL_LANES);
+    *inFocusMask |= ((u32)_mm_movemask_ps(inFocus) & laneMask) << (group * PORTAL_LANES);
+  }
+  return facingMask;
+}
+
+/*
+ * Finds the earliest portal crossed by the segment from -> to after tMin
+ * parameters:
+ * tMin excludes crossings at or before that fraction of the segment, pass the previous t to find the next crossing
+ * portalIndex returns the portal crossed, the lowest index wins ties
+ * t returns the fraction of the segment at which the portal is crossed, in (tMin, 1]
+ */
+b32 firstPortalCrossing(const PortalRects& rects, u32 portalCount, const vec3& from, const vec3& to, f32 tMin,
+                        Out u32* portalIndex, Out f32* t) {
+  const __m128 fromX = _mm_set1_ps(from.x);
+  const __m128 fromY = _mm_set1_ps(from.y);
+  const __m128 fromZ = _mm_set1_ps(from.z);
+  const __m128 deltaX = _mm_set1_ps(to.x - from.x);
+  const __m128 deltaY = _mm_set1_ps(to.y - from.y);
+  const __m128 deltaZ = _mm_set1_ps(to.z - from.z);
+  const __m128 tMinLanes = _mm_set1_ps(tMin);
+  f32 closestT = F32_MAX;
+  u32 closestPortal = 0;
+  for(u32 group = 0; group * PORTAL_LANES < portalCount; group++) {
+    __m128 fromRelativeX, fromRelativeY, fromRelativeZ, toRelativeX, toRelativeY, toRelativeZ;
+    __m128 fromDistances = portalPlaneDistances(rects, group, fromX, fromY, fromZ, &fromRelativeX, &fromRelativeY, &fromRelativeZ);
+    __m128 toDistances = portalPlaneDistances(rects, group, _mm_add_ps(fromX, deltaX), _mm_add_ps(fromY, deltaY), _mm_add_ps(fromZ, deltaZ),
+                                              &toRelativeX, &toRelativeY, &toRelativeZ);
+    __m128 crossesPlane = _mm_and_ps(_mm_cmpgt_ps(fromDistances, _mm_setzero_ps()), _mm_cmple_ps(toDistances, _mm_setzero_ps()));
+
+    // NOTE: the denominator is only guaranteed positive in lanes crossing the plane, other lanes are masked out below
+    __m128 crossingT = _mm_div_ps(fromDistances, _mm_sub_ps(fromDistances, toDistances));
+    __m128 hitRelativeX = _mm_add_ps(fromRelativeX, _mm_mul_ps(deltaX, crossingT));
+    __m128 hitRelativeY = _mm_add_ps(fromRelativeY, _mm_mul_ps(deltaY, crossingT));
+    __m128 hitRelativeZ = _mm_add_ps(fromRelativeZ, _mm_mul_ps(deltaZ, crossingT));
+    __m128 crossed = _mm_and_ps(_mm_and_ps(crossesPlane, _mm_cmpgt_ps(crossingT, tMinLanes)),
+                                withinPortalRects(rects, group, hitRelativeX, hitRelativeY, hitRelativeZ));
+
+    u32 crossedMask = (u32)_mm_movemask_ps(crossed) & portalLaneMask(portalCount, group);
+    if(crossedMask == 0) { continue; }
+    f32 laneT[PORTAL_LANES];
+    _mm_storeu_ps(laneT, crossingT);
+    for(u32 lane = 0; lane < PORTAL_LANES; lane++) {
+      if((crossedMask & (1 << lane)) && laneT[lane] < closestT) {
+        closestT = laneT[lane];
+        closestPortal = (group * PORTAL_LANES) + lane;
+      }
+    }
+  }
+
+  if(closestT == F32_MAX) { return false; }
+  *portalIndex = closestPortal;
+  *t = Min(closestT, 1.0f);
+  return true;
+}
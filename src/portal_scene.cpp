@@ -1,10 +1,21 @@
 #define PORTAL_BACKING_BOX_DEPTH 0.5f
-#define MAX_PORTALS 4
+#define MAX_PORTAL_CROSSINGS_PER_UPDATE 8
+#define SIMULATION_TIMESTEP (1.0f / 120.0f) // NOTE: seconds, rendering interpolates between steps at any frame rate
+#define MAX_WIREFRAME_DRAWS 32 // NOTE: per scene view, raise it if the assert in recordSceneView() fires
 
 const char* editorSaveFileName = "editor_state_save.json";
+const char* benchmarkReportFileName = "benchmark_report.json";
+
+struct LaunchOptions {
+  u32 traceFrameCount; // NOTE: if non-zero, captures a trace of that many frames from startup
+  const char* flythroughFile; // NOTE: if set, benchmarks the flythrough then exits
+  const char* inputRecordFile; // NOTE: if set, records the session's input from startup
+  const char* inputReplayFile; // NOTE: if set, replays the input log then exits
+};
 
 struct Player {
   BoundingBox boundingBox;
+  vec3 previousViewPosition; // NOTE: where the last portal crossing test ended
 };
 
 enum EntityType {
@@ -13,13 +24,26 @@ enum EntityType {
 };
 
 struct Entity {
-  BoundingBox boundingBox;
   u32 modelIndex;
   u32 shaderIndex;
   b32 typeFlags; // EntityType flags
   vec3 position;
   vec3 scale;
   f32 yaw; // NOTE: Radians. 0 rads starts at {0, -1} and goes around the xy-plane in a CCW as seen from above
+  f32 previousYaw; // NOTE: yaw before the latest simulation step
+
+  // NOTE: Cached from position, scale & yaw by updateEntityTransform(). Anything modifying those must set transformDirty.
+  b32 transformDirty;
+  mat4 modelMat;
+  mat4 normalMat;
+  BoundingBox boundingBox; // NOTE: world space
+  vec3 boundingSphereCenter; // NOTE: world space
+  f32 boundingSphereRadius;
+  // NOTE: modelMat & normalMat interpolated between simulation steps by interpolateEntities(), for drawing only
+  mat4 renderModelMat;
+  mat4 renderNormalMat;
+
+  b32 collidable; // NOTE: Set by updateSceneColliders() once the scene's portals have been added
 };
 
 enum PortalState {
@@ -36,48 +60,67 @@ struct Portal {
   u32 sceneDestination;
 };
 
-struct Light {
-  vec4 color;
-  // NOTE: For directional lights, this is the direction to the source
-  vec3 pos;
-};
-
 struct Scene {
   // TODO: should the scene keep track of its own index in the worlds?
   Entity entities[16];
   u32 entityCount;
+  BVH entityBVH; // NOTE: over entity world bounds, item indices are entity indices
   Portal portals[MAX_PORTALS];
+  PortalRects portalRects; // NOTE: copy of the portals' geometry for crossing tests
   u32 portalCount;
-  Light dirPosLightStack[8];
+  Light dirLights[MAX_DIR_LIGHTS];
   u32 dirLightCount;
+  Light posLights[MAX_POS_LIGHTS];
   u32 posLightCount;
   vec4 ambientLight;
+  b32 lightsDirty; // NOTE: scene's block in the light UBO must be re-uploaded before the scene is drawn
   GLuint skyboxTexture;
   const char* title;
   const char* skyboxDir;
   const char* skyboxExt;
 };
 
+// NOTE: Input for the coming simulation steps. Mouse movement and presses accumulate until a step consumes them.
+struct SimulationInput {
+  b32 movementEnabled;
+  b32 sprint;
+  b32 left;
+  b32 right;
+  b32 forward;
+  b32 back;
+  b32 togglePerspective;
+  vec2_f64 mouseDelta;
+};
+
 struct World
 {
   Camera camera;
   Player player;
   u32 currentSceneIndex;
   StopWatch stopWatch;
+  FixedTimestep simulationTimestep;
+  SimulationInput simulationInput;
+  // NOTE: state before the latest simulation step, rendering interpolates from it to the current state
+  Camera previousCamera;
+  vec3 previousPlayerMin;
   Scene scenes[16];
   u32 sceneCount;
   Model models[128];
   u32 modelCount;
   f32 fov;
   f32 aspect;
+  f32 viewportHeight; // NOTE: pixels
   struct {
     ProjectionViewModelUBO projectionViewModelUbo;
     GLuint projectionViewModelUboId;
     FragUBO fragUbo;
     GLuint fragUboId;
-    LightUBO lightUbo;
-    GLuint lightUboId;
+    GLuint lightUboId; // NOTE: one LightUBO block per scene, each lightUboStride bytes apart
+    u32 lightUboStride;
   } UBOs;
+  vec2 lightClusterTileSize;
+  RenderFrameStats renderStats; // NOTE: copy of the render thread's, as of the latest frame it drew
+  TraceCapture traceCapture;
   ShaderProgram shaders[16];
   u32 shaderCount;
 } globalWorld{};
@@ -88,9 +131,64 @@ struct EditorState
   bool cursorEnabled;
   bool showDebugTextWindow;
   bool showDemoWindow;
+  bool showProfilerWindow;
+  bool showPerformanceWindow;
   CStringRingBuffer debugCStringRingBuffer;
+  FlythroughRecorder flythroughRecorder;
 } globalEditorState{};
 
+struct Benchmark {
+  b32 active;
+  const char* flythroughFile;
+  FlythroughSaveFormat flythrough;
+  u32 frame; // NOTE: frames run so far, warm up frames included
+  std::vector<BenchmarkFrame> frames;
+  std::vector<f32> gpuFrameMs;
+  u32 gpuResultFrameCount; // NOTE: GpuTimers::resultFrameCount when last collected
+};
+
+// NOTE: A scene as drawn this frame, either directly or through a portal
+struct SceneView {
+  u32 sceneIndex;
+  const char* title;
+  GLuint skyboxTexture;
+  u32 stencilMask;
+  mat4 projection;
+  DrawList drawList;
+  LightClusterGrid lightClusterGrid;
+  struct {
+    const VertexAtt* vertexAtt;
+    mat4 modelMat;
+  } wireframes[MAX_WIREFRAME_DRAWS];
+  u32 wireframeCount;
+};
+
+struct PortalView {
+  u32 portalIndex; // NOTE: into the current scene's portals, selects the occlusion query
+  u32 stencilMask;
+  mat4 stencilModelMat;
+  const VertexAtt* stencilVertexAtt;
+  SceneView destination;
+};
+
+// NOTE: Everything the render thread needs to draw a frame, recorded by the main thread
+struct FramePacket {
+  f32 cpuFrameMs;
+  vec2_u32 viewportExtent;
+  ProjectionViewModelUBO projectionViewModelUbo;
+  FragUBO fragUbo;
+  LightUBO lightUbos[ArrayCount(World::scenes)]; // NOTE: only of scenes whose lights changed since the last packet
+  u32 lightUboSceneIndices[ArrayCount(World::scenes)];
+  u32 lightUboCount;
+  b32 drawPlayer;
+  mat4 playerBoxModelMats[4];
+  SceneView sceneView;
+  PortalView portalViews[MAX_PORTALS];
+  u32 portalViewCount;
+  ImDrawData imguiDrawData;
+  std::vector<ImDrawList*> imguiDrawLists; // NOTE: owned by the packet, imguiDrawData.CmdLists points into it
+};
+
 const vec3 defaultPlayerDimensionInMeters{0.5f, 0.25f, 1.75f}; // NOTE: ~1'7"w, 9"d, 6'h
 const f32 near = 0.1f;
 const f32 far = 200.0f;
@@ -101,7 +199,9 @@ global_variable struct {
   VertexAtt portalQuad{};
   VertexAtt portalBox{};
   VertexAtt skyboxBox{};
+  VertexAtt cube{};
 } globalVertexAtts;
+global_variable VertexBufferMark builtInVertexBufferMark; // NOTE: Geometry after this mark belongs to the loaded world
 
 global_variable union {
   struct {
@@ -112,8 +212,8 @@ global_variable union {
   ShaderProgram shaders[3];
 } globalShaders;
 
-void drawScene(World* world, const u32 sceneIndex, u32 stencilMask = 0x00);
-void drawPortals(World* world, const u32 sceneIndex);
+global_variable FramePacket globalFramePackets[RENDER_THREAD_FRAMES_IN_FLIGHT];
+global_variable RenderThread globalRenderThread;
 
 void addPortal(World* world, u32 homeSceneIndex,
                const vec3& centerPosition, const vec3& normal, const vec2& dimens,
@@ -131,6 +231,7 @@ void addPortal(World* world, u32 homeSceneIndex,
   portal.sceneDestination = destinationSceneIndex;
   portal.stateFlags = 0;
 
+  setPortalRect(&homeScene->portalRects, homeScene->portalCount, centerPosition, normal, dimens);
   homeScene->portals[homeScene->portalCount++] = portal;
 }
 
@@ -140,9 +241,60 @@ u32 addNewScene(World* world, const char* title) {
   Scene* scene = world->scenes + sceneIndex;
   *scene = {};
   scene->title = title;
+  scene->lightsDirty = true;
+  initBVH(&scene->entityBVH, ArrayCount(scene->entities));
   return sceneIndex;
 }
 
+// NOTE: Must be called once a scene's entities have been added, entities that move are refit by updateEntities()
+void buildSceneBVH(Scene* scene) {
+  BoundingBox entityBounds[ArrayCount(scene->entities)];
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; ++entityIndex) {
+    entityBounds[entityIndex] = scene->entities[entityIndex].boundingBox;
+  }
+  buildBVH(&scene->entityBVH, entityBounds, scene->entityCount);
+}
+
+// NOTE: Entities touching a portal are not collidable. Their boxes would cover the portal's opening and the player
+// must be able to walk through it, like into the gate or back out past the backing behind a portal.
+void updateSceneColliders(Scene* scene) {
+  for(u32 entityIndex = 0; entityIndex < scene->entityCount; ++entityIndex) {
+    Entity* entity = scene->entities + entityIndex;
+    const vec3 entityMax = entity->boundingBox.min + entity->boundingBox.diagonal;
+    entity->collidable = true;
+    for(u32 portalIndex = 0; portalIndex < scene->portalCount && entity->collidable; ++portalIndex) {
+      const Portal& portal = scene->portals[portalIndex];
+      // NOTE: portals are upright, width runs along the xy-plane perpendicular to the normal
+      vec3 widthDirection = normalize(-portal.normal.y, portal.normal.x, 0.0f);
+      vec3 halfExtent = vec3{fabsf(widthDirection.x), fabsf(widthDirection.y), 0.0f} * (portal.dimens.x * 0.5f);
+      halfExtent.z = portal.dimens.y * 0.5f;
+      const vec3 portalMin = portal.centerPosition - halfExtent;
+      const vec3 portalMax = portal.centerPosition + halfExtent;
+      b32 touchesPortal = portalMin.x <= entityMax.x && portalMax.x >= entity->boundingBox.min.x &&
+                          portalMin.y <= entityMax.y && portalMax.y >= entity->boundingBox.min.y &&
+                          portalMin.z <= entityMax.z && portalMax.z >= entity->boundingBox.min.z;
+      if(touchesPortal) { entity->collidable = false; }
+    }
+  }
+}
+
+// NOTE: returns the part of delta the player can move before running into the current scene's collidable entities
+vec3 collidePlayerMovement(const World* world, const vec3& delta) {
+  const Scene* scene = world->scenes + world->currentSceneIndex;
+  const BoundingBox& playerBox = world->player.boundingBox;
+  // NOTE: sliding never moves further than delta on any axis, so the swept box bounds every obstacle that can be hit
+  BoundingBox sweptBox = boundingBoxUnion(playerBox, BoundingBox{playerBox.min + delta, playerBox.diagonal});
+  u32 candidates[ArrayCount(scene->entities)];
+  u32 candidateCount = queryBVHOverlap(scene->entityBVH, sweptBox, candidates, ArrayCount(candidates));
+  BoundingBox obstacles[ArrayCount(scene->entities)];
+  u32 obstacleCount = 0;
+  for(u32 i = 0; i < candidateCount; i++) {
+    const Entity& entity = scene->entities[candidates[i]];
+    if(entity.collidable) { obstacles[obstacleCount++] = entity.boundingBox; }
+  }
+  return moveAndSlide(playerBox, delta, obstacles, obstacleCount);
+}
+
 u32 addNewShader(World* world, const char* vertexShaderFileLoc, const char* fragmentShaderFileLoc, const char* noiseTexture = nullptr) {
   Assert(ArrayCount(world->shaders) > world->shaderCount);
   u32 shaderIndex = world->shaderCount++;
@@ -151,6 +303,28 @@ u32 addNewShader(World* world, const char* vertexShaderFileLoc, const char* frag
   return shaderIndex;
 }
 
+inline vec3 calcBoundingBoxCenterPosition(BoundingBox box) {
+  return box.min + (box.diagonal * 0.5f);
+}
+
+// NOTE: returns true if the cached transform was stale and has been rebuilt
+b32 updateEntityTransform(const World* world, Entity* entity) {
+  if(!entity->transformDirty) { return false; }
+  const Model& model = world->models[entity->modelIndex];
+  entity->modelMat = scaleRotTrans_mat4(entity->scale, vec3{0.0f, 0.0f, 1.0f}, entity->yaw, entity->position);
+  // NOTE: Normals are normalized in the shaders, so the model matrix itself suffices for uniform scale
+  b32 uniformScale = entity->scale.x == entity->scale.y && entity->scale.y == entity->scale.z;
+  entity->normalMat = uniformScale ? entity->modelMat : Mat4(normalMat(entity->modelMat));
+  entity->boundingBox = transformBoundingBox(model.boundingBox, entity->modelMat);
+  f32 maxScale = Max(entity->scale.x, Max(entity->scale.y, entity->scale.z));
+  entity->boundingSphereCenter = (entity->modelMat * Vec4(calcBoundingBoxCenterPosition(model.boundingBox), 1.0f)).xyz;
+  entity->boundingSphereRadius = 0.5f * maxScale * magnitude(model.boundingBox.diagonal);
+  entity->renderModelMat = entity->modelMat;
+  entity->renderNormalMat = entity->normalMat;
+  entity->transformDirty = false;
+  return true;
+}
+
 u32 addNewEntity(World* world, u32 sceneIndex, u32 modelIndex,
                  vec3 pos, vec3 scale, f32 yaw,
                  u32 shaderIndex, b32 entityTypeFlags = 0) {
@@ -160,36 +334,42 @@ u32 addNewEntity(World* world, u32 sceneIndex, u32 modelIndex,
   Entity* entity = scene->entities + sceneEntityIndex;
   *entity = {};
   entity->modelIndex = modelIndex;
-  entity->boundingBox = world->models[modelIndex].boundingBox;
-  entity->boundingBox.min = hadamard(entity->boundingBox.min, scale);
-  entity->boundingBox.min += pos;
-  entity->boundingBox.diagonal = hadamard(entity->boundingBox.diagonal, scale);
   entity->position = pos;
   entity->scale = scale;
   entity->yaw = yaw;
+  entity->previousYaw = yaw;
   entity->shaderIndex = shaderIndex;
   entity->typeFlags = entityTypeFlags;
+  entity->transformDirty = true;
+  updateEntityTransform(world, entity);
+
+  // NOTE: Compile any shader permutations this entity's meshes need up front to avoid hitching mid-frame
+  Model* model = world->models + modelIndex;
+  for(u32 meshIndex = 0; meshIndex < model->meshCount; ++meshIndex) {
+    shaderPermutationId(world->shaders + shaderIndex, shaderPermutationFlags(model->meshes[meshIndex].textureData) | ShaderPermutation_DrawInstanced);
+  }
   return sceneEntityIndex;
 }
 
 u32 addNewDirectionalLight(World* world, u32 sceneIndex, vec3 lightColor, f32 lightPower, vec3 lightToSource) {
   Scene* scene = world->scenes + sceneIndex;
-  Assert(scene->posLightCount + scene->dirLightCount < ArrayCount(scene->dirPosLightStack));
+  Assert(scene->dirLightCount < ArrayCount(scene->dirLights));
   u32 newLightIndex = scene->dirLightCount++;
-  scene->dirPosLightStack[newLightIndex].color.rgb = lightColor;
-  scene->dirPosLightStack[newLightIndex].color.a = lightPower;
-  scene->dirPosLightStack[newLightIndex].pos = normalize(lightToSource);
+  scene->dirLights[newLightIndex].color.rgb = lightColor;
+  scene->dirLights[newLightIndex].color.a = lightPower;
+  scene->dirLights[newLightIndex].pos = normalize(lightToSource);
+  scene->lightsDirty = true;
   return newLightIndex;
 }
 
 u32 addNewPositionalLight(World* world, u32 sceneIndex, vec3 lightColor, f32 lightPower, vec3 lightPos) {
   Scene* scene = world->scenes + sceneIndex;
-  const u32 maxLights = ArrayCount(scene->dirPosLightStack);
-  Assert(scene->posLightCount + scene->dirLightCount < maxLights);
-  u32 newLightIndex = maxLights - 1 - scene->posLightCount++;
-  scene->dirPosLightStack[newLightIndex].color.rgb = lightColor;
-  scene->dirPosLightStack[newLightIndex].color.a = lightPower;
-  scene->dirPosLightStack[newLightIndex].pos = lightPos;
+  Assert(scene->posLightCount < ArrayCount(scene->posLights));
+  u32 newLightIndex = scene->posLightCount++;
+  scene->posLights[newLightIndex].color.rgb = lightColor;
+  scene->posLights[newLightIndex].color.a = lightPower;
+  scene->posLights[newLightIndex].pos = lightPos;
+  scene->lightsDirty = true;
   return newLightIndex;
 }
 
@@ -197,35 +377,45 @@ void adjustAmbientLight(World* world, u32 sceneIndex, vec3 lightColor, f32 light
   Scene* scene = world->scenes + sceneIndex;
   scene->ambientLight.rgb = lightColor;
   scene->ambientLight.a = lightPower;
+  scene->lightsDirty = true;
 }
 
 void removeAmbientLight(World* world, u32 sceneIndex) {
   world->scenes[sceneIndex].ambientLight = {};
+  world->scenes[sceneIndex].lightsDirty = true;
+}
+
+void setLightClusterTileSize(World* world, vec2_u32 windowExtent) {
+  world->lightClusterTileSize = lightClusterTileSize(windowExtent);
+  for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; sceneIndex++) {
+    world->scenes[sceneIndex].lightsDirty = true;
+  }
 }
 
 u32 addNewModel(World* world, const char* modelFileLoc) {
+  Assert(ArrayCount(world->models) > world->modelCount);
   u32 modelIndex = world->modelCount++;
   loadModel(modelFileLoc, world->models + modelIndex);
   return modelIndex;
 }
 
 u32 addNewModel_Skybox(World* world) {
+  Assert(ArrayCount(world->models) > world->modelCount);
   u32 modelIndex = world->modelCount++;
   Model* model = world->models + modelIndex;
   model->boundingBox = cubeVertAttBoundingBox;
   model->meshes = new Mesh[1];
   model->meshCount = 1;
-  model->meshes[0].vertexAtt = cubePosVertexAttBuffers(true);
+  model->meshes[0].lods[0] = cubePosVertexAttBuffers(true);
+  model->meshes[0].lodErrors[0] = 0.0f;
+  model->meshes[0].lodCount = 1;
+  model->meshes[0].boundingBox = cubeVertAttBoundingBox;
   model->meshes[0].textureData = {};
   model->meshes[0].textureData.albedoTextureId = TEXTURE_ID_NO_TEXTURE;
   model->meshes[0].textureData.normalTextureId = TEXTURE_ID_NO_TEXTURE;
   return modelIndex;
 }
 
-inline vec3 calcBoundingBoxCenterPosition(BoundingBox box) {
-  return box.min + (box.diagonal * 0.5f);
-}
-
 // assume "eyes" (FPS camera) is positioned on middle X, max Y, max Z
 inline vec3 calcPlayerViewingPosition(const Player* player) {
   return player->boundingBox.min + hadamard(player->boundingBox.diagonal, {0.5f, 1.0f, 1.0f});
@@ -250,7 +440,7 @@ mat4 calcBoxStencilModelMatFromPortalModelMat(const mat4& portalModelMat) {
   return portalModelMat * scale_mat4(vec3{1.0f, PORTAL_BACKING_BOX_DEPTH, 1.0f}) * translate_mat4(-cubeFaceNegativeYCenter);
 }
 
-void drawPortal(const World* world, Portal* portal) {
+void drawPortal(const World* world, const PortalView& portalView) {
   glUseProgram(globalShaders.stencil.id);
 
   // NOTE: Stencil function Example
@@ -263,78 +453,198 @@ void drawPortal(const World* world, Portal* portal) {
               GL_KEEP, // action when stencil passes but depth fails
               GL_REPLACE); // action when both stencil and depth pass
 
-  mat4 portalModelMat = quadModelMatrix(portal->centerPosition, portal->normal, portal->dimens.x, portal->dimens.y);
-  VertexAtt* portalVertexAtt = &globalVertexAtts.portalQuad;
-  if(flagIsSet(portal->stateFlags, PortalState_InFocus)) {
-    portalModelMat = calcBoxStencilModelMatFromPortalModelMat(portalModelMat);
-    portalVertexAtt = &globalVertexAtts.portalBox;
-  }
-
   glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-  glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &portalModelMat);
+  glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &portalView.stencilModelMat);
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
   glUseProgram(globalShaders.stencil.id);
-  glStencilMask(portal->stencilMask);
-  drawTriangles(portalVertexAtt);
+  glStencilMask(portalView.stencilMask);
+  drawTriangles(portalView.stencilVertexAtt);
 }
 
-void drawPortals(World* world, const u32 sceneIndex){
+// NOTE: Largest on-screen extent of the portal in pixels, the full viewport if any of it is behind the camera
+f32 portalOnScreenSize(const World* world, const Portal& portal) {
+  const ProjectionViewModelUBO& pvmUbo = world->UBOs.projectionViewModelUbo;
+  mat4 portalModelMat = quadModelMatrix(portal.centerPosition, portal.normal, portal.dimens.x, portal.dimens.y);
+  mat4 portalClipMat = pvmUbo.projection * pvmUbo.view * portalModelMat;
+  const vec2 quadCorners[] = {{-0.5f, -0.5f}, {0.5f, -0.5f}, {0.5f, 0.5f}, {-0.5f, 0.5f}};
+  vec2 ndcMin{F32_MAX, F32_MAX};
+  vec2 ndcMax{-F32_MAX, -F32_MAX};
+  for(u32 i = 0; i < ArrayCount(quadCorners); i++) {
+    vec4 clipPos = portalClipMat * vec4{quadCorners[i].x, 0.0f, quadCorners[i].y, 1.0f};
+    if(clipPos.w <= near) { return world->viewportHeight; }
+    vec2 ndcPos = clipPos.xy / clipPos.w;
+    ndcMin = {Min(ndcMin.x, ndcPos.x), Min(ndcMin.y, ndcPos.y)};
+    ndcMax = {Max(ndcMax.x, ndcPos.x), Max(ndcMax.y, ndcPos.y)};
+  }
+  f32 ndcWidth = clamp(-1.0f, 1.0f, ndcMax.x) - clamp(-1.0f, 1.0f, ndcMin.x);
+  f32 ndcHeight = clamp(-1.0f, 1.0f, ndcMax.y) - clamp(-1.0f, 1.0f, ndcMin.y);
+  return Max(ndcWidth * world->aspect, ndcHeight) * 0.5f * world->viewportHeight;
+}
 
+// NOTE: maxOnScreenSize (pixels) bounds the size used for level of detail selection, ex: the footprint of the portal
+// the scene is seen through. Objects larger than that opening are at most partially visible through it.
+void recordSceneView(World* world, SceneView* sceneView, const u32 sceneIndex, u32 stencilMask, const mat4& projection, f32 maxOnScreenSize) {
+  PROFILE_SCOPE("recordSceneView");
   Scene* scene = world->scenes + sceneIndex;
-
-  for(u32 portalIndex = 0; portalIndex < scene->portalCount; portalIndex++) {
-    Portal* portal = scene->portals + portalIndex;
-    // don't draw portals if portal isn't visible
-    // TODO: better visibility tests besides facing camera?
-    if(!flagIsSet(portal->stateFlags, PortalState_FacingCamera)) { continue; }
-
-    // begin occlusion query
-    glBeginQuery(GL_ANY_SAMPLES_PASSED, portalQueryObjects[portalIndex]);
-    drawPortal(world, portal);
-    // end occlusion query
-    glEndQuery(GL_ANY_SAMPLES_PASSED);
+  const ProjectionViewModelUBO& pvmUbo = world->UBOs.projectionViewModelUbo;
+  sceneView->sceneIndex = sceneIndex;
+  sceneView->title = scene->title;
+  sceneView->skyboxTexture = scene->skyboxTexture;
+  sceneView->stencilMask = stencilMask;
+  sceneView->projection = projection;
+
+  // NOTE: Clusters are view dependent and must be rebuilt every time the scene is drawn
+  buildLightClusters(&sceneView->lightClusterGrid, scene->posLights, scene->posLightCount,
+                     pvmUbo.view, world->fov, world->aspect, near, far);
+
+  DrawList* drawList = &sceneView->drawList;
+  clearDrawList(drawList);
+  const f32 pixelsPerUnitAtUnitDistance = (0.5f * world->viewportHeight) / tanf(0.5f * world->fov);
+  // NOTE: Culled against the unclipped frustum, the oblique near plane of portal projections only ever culls more
+  vec4 frustum[6];
+  frustumPlanes(pvmUbo.projection * pvmUbo.view, frustum);
+  u32 visibleEntityIndices[ArrayCount(scene->entities)];
+  u32 visibleEntityCount = queryBVHFrustum(scene->entityBVH, frustum, visibleEntityIndices, ArrayCount(visibleEntityIndices));
+  for(u32 visibleEntityIndex = 0; visibleEntityIndex < visibleEntityCount; ++visibleEntityIndex) {
+    Entity* entity = &scene->entities[visibleEntityIndices[visibleEntityIndex]];
+    Assert(!entity->transformDirty);
+    const Model& model = world->models[entity->modelIndex];
+    DrawInstance instance;
+    instance.model = entity->renderModelMat;
+    instance.normal = entity->renderNormalMat;
+
+    // level of detail from the projected size of the model's bounding sphere
+    f32 maxScale = Max(entity->scale.x, Max(entity->scale.y, entity->scale.z));
+    f32 boundsRadius = entity->boundingSphereRadius;
+    f32 boundsDistance = magnitude(entity->boundingSphereCenter - pvmUbo.cameraPos.xyz);
+    f32 pixelsPerUnit = F32_MAX; // NOTE: camera inside the bounds
+    if(boundsDistance > boundsRadius) {
+      pixelsPerUnit = maxScale * pixelsPerUnitAtUnitDistance / boundsDistance;
+      f32 onScreenSize = 2.0f * boundsRadius * pixelsPerUnitAtUnitDistance / boundsDistance;
+      if(onScreenSize > maxOnScreenSize) { pixelsPerUnit *= maxOnScreenSize / onScreenSize; }
+    }
+    recordModel(drawList, model, world->shaders + entity->shaderIndex, instance, pixelsPerUnit);
   }
+  buildDrawCommands(drawList);
 
-  // turn off writes to the stencil
-  glStencilMask(0x00);
-
-  // Draw portal worlds
-  // We need to clear disable depth values so distant objects through the "portals" still get drawn
-  // The portals themselves will still obey the depth of the scene, as the stencils have been rendered with depth in mind
-  glClear(GL_DEPTH_BUFFER_BIT);
+  sceneView->wireframeCount = 0;
+  for(u32 sceneEntityIndex = 0; sceneEntityIndex < scene->entityCount; ++sceneEntityIndex) {
+    Entity* entity = &scene->entities[sceneEntityIndex];
+    if(entity->typeFlags & EntityType_Wireframe) { // wireframes should be drawn on top default mesh
+      const Model& model = world->models[entity->modelIndex];
+      for(u32 meshIndex = 0; meshIndex < model.meshCount; ++meshIndex) {
+        Assert(sceneView->wireframeCount < MAX_WIREFRAME_DRAWS);
+        if(sceneView->wireframeCount == MAX_WIREFRAME_DRAWS) { break; }
+        const Mesh* mesh = model.meshes + meshIndex;
+        sceneView->wireframes[sceneView->wireframeCount].vertexAtt = &mesh->lods[0];
+        sceneView->wireframes[sceneView->wireframeCount].modelMat = meshModelMat(*mesh, entity->renderModelMat);
+        sceneView->wireframeCount++;
+      }
+    }
+  }
+}
 
+void recordPortalViews(World* world, FramePacket* packet) {
+  PROFILE_SCOPE("recordPortalViews");
+  const Scene* scene = world->scenes + world->currentSceneIndex;
+  const ProjectionViewModelUBO& pvmUbo = world->UBOs.projectionViewModelUbo;
+  packet->portalViewCount = 0;
   for(u32 portalIndex = 0; portalIndex < scene->portalCount; portalIndex++) {
-    Portal portal = scene->portals[portalIndex];
-    // don't draw scene if portal isn't visible
+    const Portal& portal = scene->portals[portalIndex];
+    // don't draw portals if portal isn't visible
     // TODO: better visibility tests besides facing camera?
     if(!flagIsSet(portal.stateFlags, PortalState_FacingCamera)) { continue; }
 
-    vec3 portalNormal_viewSpace = (world->UBOs.projectionViewModelUbo.view * Vec4(-portal.normal, 0.0f)).xyz;
-    vec3 portalCenterPos_viewSpace = (world->UBOs.projectionViewModelUbo.view * Vec4(portal.centerPosition, 1.0f)).xyz;
+    PortalView* portalView = packet->portalViews + packet->portalViewCount++;
+    portalView->portalIndex = portalIndex;
+    portalView->stencilMask = portal.stencilMask;
+    portalView->stencilModelMat = quadModelMatrix(portal.centerPosition, portal.normal, portal.dimens.x, portal.dimens.y);
+    portalView->stencilVertexAtt = &globalVertexAtts.portalQuad;
+    if(flagIsSet(portal.stateFlags, PortalState_InFocus)) {
+      portalView->stencilModelMat = calcBoxStencilModelMatFromPortalModelMat(portalView->stencilModelMat);
+      portalView->stencilVertexAtt = &globalVertexAtts.portalBox;
+    }
+
+    vec3 portalNormal_viewSpace = (pvmUbo.view * Vec4(-portal.normal, 0.0f)).xyz;
+    vec3 portalCenterPos_viewSpace = (pvmUbo.view * Vec4(portal.centerPosition, 1.0f)).xyz;
     mat4 portalProjectionMat = obliquePerspective(world->fov, world->aspect, near, far, portalNormal_viewSpace, portalCenterPos_viewSpace);
+    recordSceneView(world, &portalView->destination, portal.sceneDestination, portal.stencilMask, portalProjectionMat,
+                    portalOnScreenSize(world, portal));
+  }
+}
 
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &portalProjectionMat);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+// NOTE: ImGui reuses its draw lists every frame, so the packet keeps copies of them
+void recordImGuiDrawData(FramePacket* packet, const ImDrawData* drawData) {
+  for(ImDrawList* drawList : packet->imguiDrawLists) { IM_DELETE(drawList); }
+  packet->imguiDrawLists.clear();
+  for(int i = 0; i < drawData->CmdListsCount; i++) {
+    packet->imguiDrawLists.push_back(drawData->CmdLists[i]->CloneOutput());
+  }
+  packet->imguiDrawData = *drawData;
+  packet->imguiDrawData.CmdLists = packet->imguiDrawLists.data();
+}
 
-    // Conditional render only if the any samples passed while drawing the portal
-    glBeginConditionalRender(portalQueryObjects[portalIndex], GL_QUERY_BY_REGION_WAIT);
-    drawScene(world, portal.sceneDestination, portal.stencilMask);
-    glEndConditionalRender();
+/*
+ * Records everything the render thread needs to draw the frame, on the main thread
+ * NOTE: Scenes' light blocks are recorded once whenever their lights change, packets are drawn in the order recorded
+ */
+void recordFramePacket(World* world, const Camera& renderCamera, const vec3& renderPlayerMin, vec2_u32 viewportExtent,
+                       f32 cpuFrameMs, FramePacket* packet) {
+  PROFILE_SCOPE("recordFramePacket");
+  packet->cpuFrameMs = cpuFrameMs;
+  packet->viewportExtent = viewportExtent;
+  packet->projectionViewModelUbo = world->UBOs.projectionViewModelUbo;
+  packet->fragUbo = world->UBOs.fragUbo;
+
+  // update scene light uniform buffer objects
+  packet->lightUboCount = 0;
+  for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; ++sceneIndex) {
+    Scene* scene = world->scenes + sceneIndex;
+    if(!scene->lightsDirty) { continue; }
+    LightUBO* lightUbo = packet->lightUbos + packet->lightUboCount;
+    *lightUbo = {};
+    // TODO: If LightUniform and Light struct for class were the same we could do a simple memcpy
+    lightUbo->dirLightCount = scene->dirLightCount;
+    for(u32 i = 0; i < scene->dirLightCount; ++i) {
+      lightUbo->dirLights[i].color = scene->dirLights[i].color;
+      lightUbo->dirLights[i].pos.xyz = scene->dirLights[i].pos;
+      // TODO: W component of pos currently undefined and potentially dangerous. Determine if it can be used.
+    }
+    lightUbo->posLightCount = scene->posLightCount;
+    lightClusterSliceScaleBias(near, far, &lightUbo->clusterSliceScale, &lightUbo->clusterSliceBias);
+    lightUbo->clusterTileSize = world->lightClusterTileSize;
+    lightUbo->ambientLight = scene->ambientLight;
+    packet->lightUboSceneIndices[packet->lightUboCount++] = sceneIndex;
+    scene->lightsDirty = false;
+  }
+
+  packet->drawPlayer = renderCamera.thirdPerson;
+  if(renderCamera.thirdPerson) { // draw player if third person
+    BoundingBox renderPlayerBox{renderPlayerMin, world->player.boundingBox.diagonal};
+    vec3 playerCenter = calcBoundingBoxCenterPosition(renderPlayerBox);
+    vec3 playerViewCenter = renderPlayerMin + hadamard(renderPlayerBox.diagonal, {0.5f, 1.0f, 1.0f});
+    packet->playerBoxModelMats[0] = scaleTrans_mat4(renderPlayerBox.diagonal, playerCenter); // debug player bounding box
+    packet->playerBoxModelMats[1] = scaleTrans_mat4(0.05f, playerCenter); // debug player center
+    packet->playerBoxModelMats[2] = scaleTrans_mat4(0.1f, renderPlayerMin); // debug player min coordinate box
+    packet->playerBoxModelMats[3] = scaleTrans_mat4(0.1f, playerViewCenter); // debug player view
   }
+
+  recordSceneView(world, &packet->sceneView, world->currentSceneIndex, 0x00, packet->projectionViewModelUbo.projection, F32_MAX);
+  recordPortalViews(world, packet);
+  recordImGuiDrawData(packet, ImGui::GetDrawData());
 }
 
-void drawScene(World* world, const u32 sceneIndex, u32 stencilMask) {
+void drawSceneView(const World* world, SceneView* sceneView, GpuTimers* gpuTimers) {
+  PROFILE_SCOPE("drawScene");
   glStencilFunc(
           GL_EQUAL, // test function applied to stored stencil value and ref [ex: discard when stored value GL_GREATER ref]
-          stencilMask, // ref
+          sceneView->stencilMask, // ref
           0xFF); // enable which bits in reference and stored value are compared
 
-  Scene* scene = world->scenes + sceneIndex;
-
-  if(scene->skyboxTexture != TEXTURE_ID_NO_TEXTURE) { // draw skybox if one exists
+  if(sceneView->skyboxTexture != TEXTURE_ID_NO_TEXTURE) { // draw skybox if one exists
+    GPU_PASS_SCOPE(gpuTimers, "Skybox");
     glUseProgram(globalShaders.skybox.id);
-    bindActiveTextureCubeMap(skyboxActiveTextureIndex, scene->skyboxTexture);
+    bindActiveTextureCubeMap(skyboxActiveTextureIndex, sceneView->skyboxTexture);
     setSamplerCube(globalShaders.skybox.id, skyboxTexUniformName, skyboxActiveTextureIndex);
     mat4 identityMat4 = identity_mat4();
     glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
@@ -343,144 +653,302 @@ void drawScene(World* world, const u32 sceneIndex, u32 stencilMask) {
     drawTriangles(&globalVertexAtts.skyboxBox);
   }
 
-  // update scene light uniform buffer object
-  {
-    const u32 maxLights = ArrayCount(world->UBOs.lightUbo.dirPosLightStack);
-    Assert((scene->dirLightCount + scene->posLightCount) <= maxLights);
-
+  glBindBufferRange(GL_UNIFORM_BUFFER, lightUBOBindingIndex, world->UBOs.lightUboId,
+                    sceneView->sceneIndex * world->UBOs.lightUboStride, sizeof(LightUBO));
+  uploadLightClusterGrid(&sceneView->lightClusterGrid);
+  bindLightClusterGrid(&sceneView->lightClusterGrid);
 
-    // TODO: If LightUniform and Light struct for class were the same we could do a simple memcpy
-    world->UBOs.lightUbo.dirLightCount = scene->dirLightCount;
-    for(u32 i = 0; i < scene->dirLightCount; ++i) {
-      world->UBOs.lightUbo.dirPosLightStack[i].color = scene->dirPosLightStack[i].color;
-      world->UBOs.lightUbo.dirPosLightStack[i].pos.xyz = scene->dirPosLightStack[i].pos;
-      // TODO: Z component of pos currently undefined and potentially dangerous. Determine if it can be used.
-    }
+  {
+    GPU_PASS_SCOPE(gpuTimers, "Entities");
+    submitDrawList(&sceneView->drawList);
+  }
 
-    world->UBOs.lightUbo.posLightCount = scene->posLightCount;
-    for(u32 i = 0; i < scene->posLightCount; ++i) {
-      world->UBOs.lightUbo.dirPosLightStack[maxLights - i].color = scene->dirPosLightStack[maxLights - i].color;
-      world->UBOs.lightUbo.dirPosLightStack[maxLights - i].pos.xyz = scene->dirPosLightStack[maxLights - i].pos;
-      // TODO: Z component of pos currently undefined and potentially dangerous. Determine if it can be used.
-    }
+  GPU_PASS_SCOPE(gpuTimers, "Wireframes");
+  for(u32 wireframeIndex = 0; wireframeIndex < sceneView->wireframeCount; ++wireframeIndex) {
+    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &sceneView->wireframes[wireframeIndex].modelMat);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    drawTrianglesWireframe(sceneView->wireframes[wireframeIndex].vertexAtt);
+  }
+}
 
-    world->UBOs.lightUbo.ambientLight = scene->ambientLight;
+void drawPortalViews(const World* world, FramePacket* packet, GpuTimers* gpuTimers) {
+  PROFILE_SCOPE("drawPortals");
 
-    glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.lightUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightUBO), &world->UBOs.lightUbo);
+  u32 stencilPass = beginGpuPass(gpuTimers, "Portal stencils");
+  for(u32 portalViewIndex = 0; portalViewIndex < packet->portalViewCount; portalViewIndex++) {
+    const PortalView& portalView = packet->portalViews[portalViewIndex];
+    // begin occlusion query
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, portalQueryObjects[portalView.portalIndex]);
+    drawPortal(world, portalView);
+    // end occlusion query
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
   }
+  endGpuPass(gpuTimers, stencilPass);
 
-  for(u32 sceneEntityIndex = 0; sceneEntityIndex < scene->entityCount; ++sceneEntityIndex) {
-    Entity* entity = &scene->entities[sceneEntityIndex];
-    ShaderProgram shader = world->shaders[entity->shaderIndex];
+  // turn off writes to the stencil
+  glStencilMask(0x00);
 
-    mat4 modelMatrix = scaleRotTrans_mat4(entity->scale, vec3{0.0f, 0.0f, 1.0f}, entity->yaw, entity->position);
+  // Draw portal worlds
+  // We need to clear disable depth values so distant objects through the "portals" still get drawn
+  // The portals themselves will still obey the depth of the scene, as the stencils have been rendered with depth in mind
+  glClear(GL_DEPTH_BUFFER_BIT);
 
+  for(u32 portalViewIndex = 0; portalViewIndex < packet->portalViewCount; portalViewIndex++) {
+    PortalView* portalView = packet->portalViews + portalViewIndex;
     glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &modelMatrix);
+    glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, projection), sizeof(mat4), &portalView->destination.projection);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    glUseProgram(shader.id);
-    if(shader.noiseTextureId != TEXTURE_ID_NO_TEXTURE) {
-      bindActiveTextureSampler2d(noiseActiveTextureIndex, shader.noiseTextureId);
-      setSampler2D(shader.id, noiseTexUniformName, noiseActiveTextureIndex);
-    }
-    Model model = world->models[entity->modelIndex];
-    // TODO: Should some of this logic be moved to drawModel()?
-    for(u32 meshIndex = 0; meshIndex < model.meshCount; ++meshIndex) {
-      Mesh* mesh = model.meshes + meshIndex;
-      if(mesh->textureData.baseColor.a != 0.0f) {
-        setUniform(shader.id, baseColorUniformName, mesh->textureData.baseColor.rgb);
-      }
-      if(mesh->textureData.albedoTextureId != TEXTURE_ID_NO_TEXTURE) {
-        bindActiveTextureSampler2d(albedoActiveTextureIndex, mesh->textureData.albedoTextureId);
-        setSampler2D(shader.id, albedoTexUniformName, albedoActiveTextureIndex);
-      }
-      if(mesh->textureData.normalTextureId != TEXTURE_ID_NO_TEXTURE) {
-        bindActiveTextureSampler2d(normalActiveTextureIndex, mesh->textureData.normalTextureId);
-        setSampler2D(shader.id, normalTexUniformName, normalActiveTextureIndex);
-      }
+    GPU_PASS_SCOPE(gpuTimers, portalView->destination.title);
+    // Conditional render only if the any samples passed while drawing the portal
+    glBeginConditionalRender(portalQueryObjects[portalView->portalIndex], GL_QUERY_BY_REGION_WAIT);
+    drawSceneView(world, &portalView->destination, gpuTimers);
+    glEndConditionalRender();
+  }
+}
 
-      drawTriangles(&mesh->vertexAtt);
-    }
+/*
+ * Draws a frame packet, on the render thread
+ * NOTE: World is only read for GL objects created at startup, the render thread is paused whenever worlds are loaded
+ */
+RENDER_FRAME_PACKET(renderFramePacket) {
+  PROFILE_SCOPE("renderFramePacket");
+  FramePacket* framePacket = (FramePacket*)packet;
+  const World* world = &globalWorld;
+
+  func_persist vec2_u32 viewportExtent{};
+  if(framePacket->viewportExtent.width != viewportExtent.width || framePacket->viewportExtent.height != viewportExtent.height) {
+    viewportExtent = framePacket->viewportExtent;
+    glViewport(0, 0, viewportExtent.width, viewportExtent.height);
+  }
 
-    if(entity->typeFlags & EntityType_Wireframe) { // wireframes should be drawn on top default mesh
-      for(u32 meshIndex = 0; meshIndex < model.meshCount; ++meshIndex) {
-        Mesh* mesh = model.meshes + meshIndex;
-        drawTrianglesWireframe(&mesh->vertexAtt);
-      }
+  beginGpuTimerFrame(gpuTimers);
+  glStencilMask(0xFF);
+  glStencilFunc(GL_ALWAYS, // stencil function always passes
+                0x00, // reference
+                0x00); // mask
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  // universal matrices in UBO
+  glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(ProjectionViewModelUBO, model), &framePacket->projectionViewModelUbo);
+
+  glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.fragUboId);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FragUBO), &framePacket->fragUbo);
+
+  glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.lightUboId);
+  for(u32 i = 0; i < framePacket->lightUboCount; ++i) {
+    glBufferSubData(GL_UNIFORM_BUFFER, framePacket->lightUboSceneIndices[i] * world->UBOs.lightUboStride, sizeof(LightUBO),
+                    framePacket->lightUbos + i);
+  }
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  if(framePacket->drawPlayer) { // draw player if third person
+    const vec3 playerBoxColors[ArrayCount(framePacket->playerBoxModelMats)] = {
+            {1.0f, 0.0f, 0.0f}, // bounding box, red
+            {0.0f, 0.0f, 0.0f}, // center, black
+            {0.0f, 1.0f, 0.0f}, // min coordinate, green
+            {1.0f, 1.0f, 1.0f} // view, white
+    };
+
+    glUseProgram(globalShaders.singleColor.id);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    glDisable(GL_CULL_FACE);
+    for(u32 i = 0; i < ArrayCount(framePacket->playerBoxModelMats); ++i) {
+      glBindBuffer(GL_UNIFORM_BUFFER, world->UBOs.projectionViewModelUboId);
+      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), framePacket->playerBoxModelMats + i);
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+      setUniform(globalShaders.singleColor.id, baseColorUniformName, playerBoxColors[i]);
+      drawTriangles(&globalVertexAtts.cube);
     }
+    glEnable(GL_CULL_FACE);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
   }
-}
 
-void drawSceneWithPortals(World* world)
-{
   // draw scene
-  drawScene(world, world->currentSceneIndex);
+  {
+    GPU_PASS_SCOPE(gpuTimers, framePacket->sceneView.title);
+    drawSceneView(world, &framePacket->sceneView, gpuTimers);
+  }
   // draw portals
-  drawPortals(world, world->currentSceneIndex);
+  drawPortalViews(world, framePacket, gpuTimers);
+  {
+    GPU_PASS_SCOPE(gpuTimers, "ImGui");
+    ImGui_ImplOpenGL3_RenderDrawData(&framePacket->imguiDrawData);
+  }
+  endGpuTimerFrame(gpuTimers, framePacket->cpuFrameMs);
 }
 
-void updateEntities(World* world) {
+// NOTE: Every view in a packet has buffers of its own, they can't be reused until the render thread is done with them
+void initFramePackets() {
+  for(u32 packetIndex = 0; packetIndex < ArrayCount(globalFramePackets); packetIndex++) {
+    FramePacket* packet = globalFramePackets + packetIndex;
+    initLightClusterGrid(&packet->sceneView.lightClusterGrid);
+    initDrawList(&packet->sceneView.drawList);
+    for(u32 portalIndex = 0; portalIndex < ArrayCount(packet->portalViews); portalIndex++) {
+      initLightClusterGrid(&packet->portalViews[portalIndex].destination.lightClusterGrid);
+      initDrawList(&packet->portalViews[portalIndex].destination.drawList);
+    }
+  }
+}
+
+void deleteFramePackets() {
+  for(u32 packetIndex = 0; packetIndex < ArrayCount(globalFramePackets); packetIndex++) {
+    FramePacket* packet = globalFramePackets + packetIndex;
+    deleteLightClusterGrid(&packet->sceneView.lightClusterGrid);
+    deleteDrawList(&packet->sceneView.drawList);
+    for(u32 portalIndex = 0; portalIndex < ArrayCount(packet->portalViews); portalIndex++) {
+      deleteLightClusterGrid(&packet->portalViews[portalIndex].destination.lightClusterGrid);
+      deleteDrawList(&packet->portalViews[portalIndex].destination.drawList);
+    }
+    for(ImDrawList* drawList : packet->imguiDrawLists) { IM_DELETE(drawList); }
+    packet->imguiDrawLists.clear();
+  }
+}
+
+void updateEntities(World* world, f32 timestep) {
+  PROFILE_SCOPE("updateEntities");
   for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; ++sceneIndex) {
     Scene* scene = world->scenes + sceneIndex;
     for(u32 entityIndex = 0; entityIndex < scene->entityCount; ++entityIndex) {
       Entity* entity = scene->entities + entityIndex;
+      entity->previousYaw = entity->yaw;
       if(entity->typeFlags & EntityType_Rotating) {
-        entity->yaw += 30.0f * RadiansPerDegree * world->stopWatch.delta;
+        entity->yaw += 30.0f * RadiansPerDegree * timestep;
         if(entity->yaw > Tau32) {
           entity->yaw -= Tau32;
         }
+        entity->transformDirty = true;
+      }
+      if(updateEntityTransform(world, entity)) {
+        refitBVHItem(&scene->entityBVH, entityIndex, entity->boundingBox);
       }
     }
   }
 
-  Scene* currentScene = &world->scenes[world->currentSceneIndex];
+  // NOTE: Portals are crossed by the segment the view position moved along since the last update. Crossing a portal
+  // changes scenes but not the position, so the rest of the segment is tested against the destination's portals.
   vec3 playerViewPosition = calcPlayerViewingPosition(&world->player);
-  b32 portalEntered = false;
-  u32 portalSceneDestination;
-  auto updatePortalsForScene = [playerViewPosition, &portalEntered, &portalSceneDestination](Scene* scene) {
-    for(u32 portalIndex = 0; portalIndex < scene->portalCount; ++portalIndex) {
-      Portal* portal = scene->portals + portalIndex;
-
-      vec3 portalCenterToPlayerView = playerViewPosition - portal->centerPosition;
-      b32 portalFacingCamera = similarDirection(portal->normal, playerViewPosition - portal->centerPosition) ? PortalState_FacingCamera : false;
+  f32 crossingT = 0.0f;
+  for(u32 crossing = 0; crossing < MAX_PORTAL_CROSSINGS_PER_UPDATE; crossing++) {
+    Scene* scene = world->scenes + world->currentSceneIndex;
+    u32 portalIndex;
+    if(!firstPortalCrossing(scene->portalRects, scene->portalCount, world->player.previousViewPosition, playerViewPosition,
+                            crossingT, &portalIndex, &crossingT)) { break; }
+    for(u32 i = 0; i < scene->portalCount; ++i) {
+      clearFlags(&scene->portals[i].stateFlags); // clear all flags of the scene being left
+    }
+    world->currentSceneIndex = scene->portals[portalIndex].sceneDestination;
+  }
+  world->player.previousViewPosition = playerViewPosition;
+
+  Scene* currentScene = world->scenes + world->currentSceneIndex;
+  u32 inFocusMask;
+  u32 facingMask = portalsFacingPoint(currentScene->portalRects, currentScene->portalCount, playerViewPosition, &inFocusMask);
+  for(u32 portalIndex = 0; portalIndex < currentScene->portalCount; ++portalIndex) {
+    b32 portalFacingCamera = flagIsSet(facingMask, 1 << portalIndex) ? PortalState_FacingCamera : false;
+    b32 portalInFocus = flagIsSet(inFocusMask, 1 << portalIndex) ? PortalState_InFocus : false;
+    overrideFlags(&currentScene->portals[portalIndex].stateFlags, portalFacingCamera | portalInFocus);
+  }
+}
 
-      b32 portalWasInFocus = flagIsSet(portal->stateFlags, PortalState_InFocus);
-      vec3 viewPositionPerpendicularToPortal = perpendicularTo(portalCenterToPlayerView, portal->normal);
-      f32 widthDistFromCenter = magnitude(viewPositionPerpendicularToPortal.xy);
-      f32 heightDistFromCenter = viewPositionPerpendicularToPortal.z;
-      b32 viewerInsideDimens = widthDistFromCenter < (portal->dimens.x * 0.5f) && heightDistFromCenter < (portal->dimens.y * 0.5f);
+// NOTE: alpha is how far between the previous and the latest simulation step to draw rotating entities
+void interpolateEntities(World* world, f32 alpha) {
+  PROFILE_SCOPE("interpolateEntities");
+  for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; ++sceneIndex) {
+    Scene* scene = world->scenes + sceneIndex;
+    for(u32 entityIndex = 0; entityIndex < scene->entityCount; ++entityIndex) {
+      Entity* entity = scene->entities + entityIndex;
+      if(!(entity->typeFlags & EntityType_Rotating)) { continue; }
+      f32 yaw = lerpAngle(entity->previousYaw, entity->yaw, alpha);
+      entity->renderModelMat = scaleRotTrans_mat4(entity->scale, vec3{0.0f, 0.0f, 1.0f}, yaw, entity->position);
+      b32 uniformScale = entity->scale.x == entity->scale.y && entity->scale.y == entity->scale.z;
+      entity->renderNormalMat = uniformScale ? entity->renderModelMat : Mat4(normalMat(entity->renderModelMat));
+    }
+  }
+}
 
-      b32 portalInFocus = (portalFacingCamera && viewerInsideDimens) ? PortalState_InFocus : false;
-      b32 insidePortal = portalWasInFocus && !portalFacingCamera; // portal was in focus and now we're on the other side
+void movePlayer(World* world, const SimulationInput& input, f32 timestep) {
+  PROFILE_SCOPE("Player movement");
+  Camera* camera = &world->camera;
+  vec3 playerViewPosition = calcPlayerViewingPosition(&world->player);
+  b32 lateralMovement = input.left != input.right;
+  b32 forwardMovement = input.forward != input.back;
+  vec3 playerDelta{};
+  if (lateralMovement || forwardMovement)
+  {
+    f32 playerMovementSpeed = input.sprint ? 8.0f : 4.0f;
 
-      overrideFlags(&portal->stateFlags, portalFacingCamera | portalInFocus);
+    // Camera movement direction
+    vec3 playerMovementDirection{};
+    if (lateralMovement)
+    {
+      playerMovementDirection += input.right ? camera->right : -camera->right;
+    }
 
-      if(insidePortal){
-        portalEntered = true;
-        portalSceneDestination = portal->sceneDestination;
-        break;
-      }
+    if (forwardMovement)
+    {
+      playerMovementDirection += input.forward ? camera->forward : -camera->forward;
     }
-  };
 
-  // update portals for current scene
-  updatePortalsForScene(currentScene);
-  // if portal was entered, we need to update portals for new scene
-  if(portalEntered) {
-    // clear portals for old scene
-    for(u32 portalIndex = 0; portalIndex < currentScene->portalCount; ++portalIndex) {
-      clearFlags(&currentScene->portals[portalIndex].stateFlags); // clear all flags of previous currentScene
+    playerMovementDirection = normalize(playerMovementDirection.x, playerMovementDirection.y, 0.0);
+    playerDelta = playerMovementDirection * playerMovementSpeed * timestep;
+  }
+
+  playerDelta = collidePlayerMovement(world, playerDelta);
+  world->player.boundingBox.min += playerDelta;
+  vec3 playerCenter = calcBoundingBoxCenterPosition(world->player.boundingBox);
+
+  if(input.togglePerspective) { // switch between third and first person
+    vec3 xyForward = normalize(camera->forward.x, camera->forward.y, 0.0f);
+
+    if(!camera->thirdPerson) {
+      lookAt_ThirdPerson(playerCenter, xyForward, camera);
+    } else { // camera is first person now
+      vec3 focus = playerViewPosition + xyForward;
+      lookAt_FirstPerson(playerViewPosition, focus, camera);
     }
+  }
 
-    world->currentSceneIndex = portalSceneDestination;
+  const f32 mouseDeltaMultConst = 0.0005f;
+  if(camera->thirdPerson) {
+    updateCamera_ThirdPerson(camera, playerCenter, f32(-input.mouseDelta.y * mouseDeltaMultConst), f32(-input.mouseDelta.x * mouseDeltaMultConst));
+  } else {
+    updateCamera_FirstPerson(camera, playerDelta, f32(-input.mouseDelta.y * mouseDeltaMultConst), f32(-input.mouseDelta.x * mouseDeltaMultConst));
+  }
+}
 
-    // update portals for new scene
-    updatePortalsForScene(world->scenes + world->currentSceneIndex);
+/*
+ * Advances player movement, entities and portal crossings by one fixed timestep
+ * The world's previous state is kept for interpolation, except across a portal crossing as the scene drawn changes.
+ */
+void simulateStep(World* world, f32 timestep) {
+  PROFILE_SCOPE("simulateStep");
+  world->previousCamera = world->camera;
+  world->previousPlayerMin = world->player.boundingBox.min;
+  u32 sceneIndex = world->currentSceneIndex;
+
+  SimulationInput* input = &world->simulationInput;
+  if(input->movementEnabled) { movePlayer(world, *input, timestep); }
+  input->togglePerspective = false;
+  input->mouseDelta = {0.0, 0.0};
+
+  updateEntities(world, timestep);
+  if(world->currentSceneIndex != sceneIndex) {
+    world->previousCamera = world->camera;
+    world->previousPlayerMin = world->player.boundingBox.min;
   }
 }
 
+// NOTE: Restarts the fixed timestep and drops pending input & interpolation, ex: when the world is (re)loaded
+void resetSimulation(World* world) {
+  world->simulationTimestep = createFixedTimestep(SIMULATION_TIMESTEP);
+  world->simulationInput = {};
+  world->previousCamera = world->camera;
+  world->previousPlayerMin = world->player.boundingBox.min;
+}
+
 void initGlobalShaders() {
   globalShaders.singleColor = createShaderProgram(posVertexShaderFileLoc, singleColorFragmentShaderFileLoc);
   globalShaders.stencil = createShaderProgram(posVertexShaderFileLoc, blackFragmentShaderFileLoc);
@@ -491,6 +959,7 @@ void initGlobalVertexAtts() {
   globalVertexAtts.portalQuad = quadPosVertexAttBuffers(false);
   globalVertexAtts.portalBox = cubePosVertexAttBuffers(true, true);
   globalVertexAtts.skyboxBox = cubePosVertexAttBuffers(true);
+  globalVertexAtts.cube = cubePosVertexAttBuffers();
 }
 
 void saveWorld(World* world, const char* title) {
@@ -561,9 +1030,8 @@ void saveWorld(World* world, const char* title) {
       sceneSaveFormat.portals.push_back(portalSaveFormat);
     }
 
-    const u32 maxLights = ArrayCount(scene->dirPosLightStack);
     for(u32 dirLightIndex = 0; dirLightIndex < scene->dirLightCount; dirLightIndex++) {
-      Light dirLight = scene->dirPosLightStack[dirLightIndex];
+      Light dirLight = scene->dirLights[dirLightIndex];
       DirectionalLightSaveFormat directionalLightSaveFormat{};
       directionalLightSaveFormat.color = dirLight.color.rgb;
       directionalLightSaveFormat.power = dirLight.color.a;
@@ -572,7 +1040,7 @@ void saveWorld(World* world, const char* title) {
     }
 
     for(u32 posLightIndex = 0; posLightIndex < scene->posLightCount; posLightIndex++) {
-      Light posLight = scene->dirPosLightStack[maxLights - 1 - posLightIndex];
+      Light posLight = scene->posLights[posLightIndex];
       PositionalLightSaveFormat positionalLightSaveFormat{};
       positionalLightSaveFormat.color = posLight.color.rgb;
       positionalLightSaveFormat.power = posLight.color.a;
@@ -594,6 +1062,7 @@ void cleanupScene(Scene* scene) {
     scene->entities[entityIndex] = {}; // zero out struct
   }
   scene->entityCount = 0;
+  deleteBVH(&scene->entityBVH);
 
   for(u32 portalIndex = 0; portalIndex < scene->portalCount; portalIndex++) {
     scene->portals[portalIndex] = {}; // zero out struct
@@ -611,19 +1080,25 @@ void cleanupScene(Scene* scene) {
   scene->skyboxExt = nullptr;
 }
 
+// NOTE: Empties the world for the next loadWorld(), the GL UBOs, stop watch, render stats & trace capture are kept
 void cleanupWorld(World* world) {
   for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; sceneIndex++) {
     cleanupScene(world->scenes + sceneIndex);
+    world->scenes[sceneIndex] = {};
   }
+  world->sceneCount = 0;
+  world->currentSceneIndex = 0;
 
   deleteModels(world->models, world->modelCount);
   memset(world->models, 0, sizeof(Model) * world->modelCount);
+  world->modelCount = 0;
+  freeToVertexBufferMark(builtInVertexBufferMark);
 
   for(u32 shaderIndex = 0; shaderIndex < world->shaderCount; shaderIndex++) {
     deleteShaderProgram(world->shaders + shaderIndex);
   }
-
-  world = {};
+  memset(world->shaders, 0, sizeof(ShaderProgram) * world->shaderCount);
+  world->shaderCount = 0;
 }
 
 void cleanupEditorState(EditorState* editorState) {
@@ -634,6 +1109,7 @@ void cleanupEditorState(EditorState* editorState) {
 void initPlayer(Player* player) {
   player->boundingBox.diagonal = defaultPlayerDimensionInMeters;
   player->boundingBox.min = {-(globalWorld.player.boundingBox.diagonal.x * 0.5f), -12.0f - (globalWorld.player.boundingBox.diagonal.y * 0.5f), 0.0f};
+  player->previousViewPosition = calcPlayerViewingPosition(player);
 }
 
 void initCamera(Camera* camera, const Player& player) {
@@ -643,6 +1119,7 @@ void initCamera(Camera* camera, const Player& player) {
 }
 
 void loadWorld(World* world, EditorState* editorState, const char* saveJsonFile) {
+  PROFILE_SCOPE("loadWorld");
 
   strcpy(editorState->currentlyLoadedWorld, saveJsonFile);
   addCStringF(&editorState->debugCStringRingBuffer, "Currently leading world: %s", editorState->currentlyLoadedWorld);
@@ -747,6 +1224,11 @@ void loadWorld(World* world, EditorState* editorState, const char* saveJsonFile)
     }
   }
 
+  for(u32 sceneIndex = 0; sceneIndex < world->sceneCount; sceneIndex++) {
+    buildSceneBVH(world->scenes + sceneIndex);
+    updateSceneColliders(world->scenes + sceneIndex);
+  }
+
   Assert(saveFormat.startingSceneIndex < sceneCount);
   world->currentSceneIndex = worldSceneIndices[saveFormat.startingSceneIndex];
 
@@ -754,10 +1236,12 @@ void loadWorld(World* world, EditorState* editorState, const char* saveJsonFile)
   initPlayer(&world->player);
   // TODO: Set camera based on save file
   initCamera(&globalWorld.camera, globalWorld.player);
+  resetSimulation(world);
   // TODO: Set FOV based on save file
   world->fov = fieldOfView(13.5f, 25.0f);
   vec2_u32 windowExtent = getWindowExtent();
   world->aspect = f32(windowExtent.width) / windowExtent.height;
+  world->viewportHeight = f32(windowExtent.height);
   // NOTE: projection and view in UBO gets updated at the beginning of every frame, no need to manually update UBO here
   world->UBOs.projectionViewModelUbo.projection = perspective(world->fov, world->aspect, near, far);
   // NOTE: fragmentUBO gets updated using the stopwatch at the beginning of every frame, no need to manually update UBO here
@@ -770,6 +1254,8 @@ void initGuiState(EditorState* guiState) {
   guiState->cursorEnabled = true;
   guiState->showDebugTextWindow = true;
   guiState->showDemoWindow = false;
+  guiState->showProfilerWindow = false;
+  guiState->showPerformanceWindow = true;
   guiState->debugCStringRingBuffer = createCStringRingBuffer(128, 50);
 }
 
@@ -816,20 +1302,264 @@ void loadPrevEditorState(World* world, EditorState* editorState) {
   }
 }
 
-void portalScene(GLFWwindow* window) {
+// NOTE: Puts the player's view at the pose and the camera in first person looking along it
+void applyFlythroughPose(World* world, const FlythroughPose& pose) {
+  Player* player = &world->player;
+  player->boundingBox.min = pose.viewPosition - hadamard(player->boundingBox.diagonal, {0.5f, 1.0f, 1.0f});
+  world->camera.thirdPerson = false;
+  updateCamera_FirstPerson(&world->camera, pose.viewPosition - world->camera.origin, pose.pitch - world->camera.pitch,
+                           pose.yaw - world->camera.yaw);
+}
+
+void beginFlythroughRecording(FlythroughRecorder* recorder, const World& world) {
+  recorder->recording = true;
+  recorder->time = 0.0f;
+  recorder->startingSceneIndex = world.currentSceneIndex;
+  recorder->keyframes.clear();
+}
+
+void updateFlythroughRecording(FlythroughRecorder* recorder, const World& world, f32 timestep) {
+  if(!recorder->recording) { return; }
+  if(recorder->keyframes.empty() || recorder->time >= recorder->keyframes.back().time + FLYTHROUGH_RECORD_INTERVAL) {
+    // NOTE: angles from the camera's forward so a third person camera's view direction is recorded too
+    FlythroughKeyframe keyframe;
+    keyframe.time = recorder->time;
+    keyframe.viewPosition = calcPlayerViewingPosition(&world.player);
+    keyframe.pitch = asinf(world.camera.forward.z);
+    keyframe.yaw = atan2f(world.camera.forward.y, world.camera.forward.x);
+    recorder->keyframes.push_back(keyframe);
+  }
+  recorder->time += timestep;
+}
+
+void endFlythroughRecording(FlythroughRecorder* recorder, EditorState* editorState) {
+  recorder->recording = false;
+  if(recorder->keyframes.size() < 2) {
+    addCString(&editorState->debugCStringRingBuffer, "Flythrough not saved, too short");
+    return;
+  }
+
+  FlythroughSaveFormat flythrough{};
+  flythrough.worldFile = editorState->currentlyLoadedWorld;
+  flythrough.startingSceneIndex = recorder->startingSceneIndex;
+  flythrough.timestep = FLYTHROUGH_DEFAULT_TIMESTEP;
+  flythrough.warmupFrames = FLYTHROUGH_DEFAULT_WARMUP_FRAMES;
+  flythrough.frameCount = (u32)ceilf(recorder->keyframes.back().time / flythrough.timestep) + 1;
+  flythrough.keyframes = recorder->keyframes;
+
+  char fileName[64];
+  time_t now = time(nullptr);
+  strftime(fileName, sizeof(fileName), "flythrough_%Y%m%d_%H%M%S.json", localtime(&now));
+  saveFlythrough(flythrough, fileName);
+  addCStringF(&editorState->debugCStringRingBuffer, "Flythrough of %d keyframes saved to %s", (u32)flythrough.keyframes.size(), fileName);
+}
+
+b32 beginBenchmark(Benchmark* benchmark, World* world, EditorState* editorState, const char* flythroughFile) {
+  if(!fileReadable(flythroughFile)) {
+    std::cout << "Could not read flythrough file: " << flythroughFile << std::endl;
+    return false;
+  }
+  benchmark->flythroughFile = flythroughFile;
+  benchmark->flythrough = loadFlythrough(flythroughFile);
+  if(benchmark->flythrough.keyframes.empty() || !fileReadable(benchmark->flythrough.worldFile.c_str())) {
+    std::cout << "Flythrough has no keyframes or its world can't be read: " << flythroughFile << std::endl;
+    return false;
+  }
+
+  loadWorld(world, editorState, benchmark->flythrough.worldFile.c_str());
+  Assert(benchmark->flythrough.startingSceneIndex < world->sceneCount);
+  world->currentSceneIndex = benchmark->flythrough.startingSceneIndex;
+  FlythroughPose pose = sampleFlythrough(benchmark->flythrough.keyframes.data(), (u32)benchmark->flythrough.keyframes.size(), 0.0f);
+  applyFlythroughPose(world, pose);
+  world->player.previousViewPosition = pose.viewPosition; // NOTE: the path starts here, no portal has been crossed yet
+
+  benchmark->active = true;
+  benchmark->frame = 0;
+  benchmark->frames.clear();
+  benchmark->frames.reserve(benchmark->flythrough.frameCount);
+  benchmark->gpuFrameMs.clear();
+  benchmark->gpuResultFrameCount = world->renderStats.gpuTimers.resultFrameCount;
+  return true;
+}
+
+// NOTE: Moves the player along the path, the frame then takes exactly one simulation step of the path's timestep
+void stepBenchmark(Benchmark* benchmark, World* world) {
+  const FlythroughSaveFormat& flythrough = benchmark->flythrough;
+  world->UBOs.fragUbo.time = benchmark->frame * flythrough.timestep;
+  u32 pathFrame = benchmark->frame > flythrough.warmupFrames ? benchmark->frame - flythrough.warmupFrames : 0;
+  FlythroughPose pose = sampleFlythrough(flythrough.keyframes.data(), (u32)flythrough.keyframes.size(), pathFrame * flythrough.timestep);
+  applyFlythroughPose(world, pose);
+}
+
+/*
+ * Records the frame that just ended, call once it has been handed to the render thread
+ * NOTE: CPU times are the main thread's, presenting overlaps with the next frame on the render thread
+ * returns true once every frame has been measured and the report written
+ */
+b32 endBenchmarkFrame(Benchmark* benchmark, const World& world, f32 cpuFrameMs) {
+  const FlythroughSaveFormat& flythrough = benchmark->flythrough;
+  if(benchmark->frame >= flythrough.warmupFrames) {
+    BenchmarkFrame frame;
+    frame.frameIndex = benchmark->frame - flythrough.warmupFrames;
+    frame.cpuMs = cpuFrameMs;
+    frame.viewPosition = calcPlayerViewingPosition(&world.player);
+    frame.sceneIndex = world.currentSceneIndex;
+    benchmark->frames.push_back(frame);
+
+    if(world.renderStats.gpuTimers.resultFrameCount != benchmark->gpuResultFrameCount) {
+      benchmark->gpuFrameMs.push_back(world.renderStats.gpuTimers.resultMs[0]);
+    }
+  }
+  benchmark->gpuResultFrameCount = world.renderStats.gpuTimers.resultFrameCount;
+  benchmark->frame++;
+  if(benchmark->frames.size() < flythrough.frameCount) { return false; }
+
+  benchmark->active = false;
+  BenchmarkReport report = buildBenchmarkReport(benchmark->frames, benchmark->gpuFrameMs);
+  printf("Benchmark %s: %d frames, CPU mean %.3f ms, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms | GPU mean %.3f ms, p95 %.3f ms\n",
+         benchmark->flythroughFile, report.cpu.frameCount, report.cpu.meanMs, report.cpu.p50Ms, report.cpu.p95Ms,
+         report.cpu.p99Ms, report.cpu.maxMs, report.gpu.meanMs, report.gpu.p95Ms);
+  if(!writeBenchmarkReport(report, benchmark->flythroughFile, benchmarkReportFileName)) {
+    std::cout << "Could not write benchmark report: " << benchmarkReportFileName << std::endl;
+  }
+  return true;
+}
+
+// NOTE: GPU results lag the CPU by GPU_TIMER_FRAMES_IN_FLIGHT frames
+void drawPerformanceGui(const GpuTimers& timers) {
+  const f32 graphMaxMs = 33.3f;
+  const ImVec2 graphSize{0.0f, 60.0f};
+  char overlay[32];
+  u32 latestCpuFrame = (timers.cpuFrameMsHistoryNext + GPU_TIMER_HISTORY_FRAMES - 1) % GPU_TIMER_HISTORY_FRAMES;
+  snprintf(overlay, sizeof(overlay), "%.2f ms", timers.cpuFrameMsHistory[latestCpuFrame]);
+  ImGui::PlotLines("CPU frame", timers.cpuFrameMsHistory, GPU_TIMER_HISTORY_FRAMES, timers.cpuFrameMsHistoryNext, overlay, 0.0f, graphMaxMs, graphSize);
+  u32 latestGpuFrame = (timers.gpuFrameMsHistoryNext + GPU_TIMER_HISTORY_FRAMES - 1) % GPU_TIMER_HISTORY_FRAMES;
+  snprintf(overlay, sizeof(overlay), "%.2f ms", timers.gpuFrameMsHistory[latestGpuFrame]);
+  ImGui::PlotLines("GPU frame", timers.gpuFrameMsHistory, GPU_TIMER_HISTORY_FRAMES, timers.gpuFrameMsHistoryNext, overlay, 0.0f, graphMaxMs, graphSize);
+
+  ImGui::Separator();
+  ImGui::Text("GPU passes (%d frames skipped waiting on results)", timers.skippedFrameCount);
+  for(u32 passIndex = 0; passIndex < timers.resultPassCount; passIndex++) {
+    const GpuTimerPass& pass = timers.resultPasses[passIndex];
+    s32 indent = 2 * pass.depth;
+    ImGui::Text("%*s%-*s %7.3f ms", indent, "", 24 - indent, pass.name, timers.resultMs[passIndex]);
+  }
+}
+
+#if PROFILER_ON
+void drawProfileNodeGui(u32 nodeIndex) {
+  const ProfileNode& node = globalProfiler.nodes[nodeIndex];
+  ProfileStats stats = profileNodeStats(node);
+  ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_DefaultOpen | (node.firstChild == PROFILER_NODE_NONE ? ImGuiTreeNodeFlags_Leaf : 0);
+  bool open = ImGui::TreeNodeEx((void*)(intptr_t)nodeIndex, flags, "%-20s %7.3f ms x%-3d | min %7.3f avg %7.3f p95 %7.3f p99 %7.3f",
+                                node.name, node.lastFrameMs, node.lastFrameCallCount, stats.minMs, stats.avgMs, stats.p95Ms, stats.p99Ms);
+  if(open) {
+    for(u32 child = node.firstChild; child != PROFILER_NODE_NONE; child = globalProfiler.nodes[child].nextSibling) {
+      drawProfileNodeGui(child);
+    }
+    ImGui::TreePop();
+  }
+}
+#endif
+
+// NOTE: times are of the last completed frame, statistics are over the last PROFILER_HISTORY_FRAMES frames each scope ran in
+void drawProfilerGui(const RenderFrameStats& renderStats) {
+#if PROFILER_ON
+  for(u32 nodeIndex = 0; nodeIndex < globalProfiler.nodeCount; nodeIndex++) {
+    if(globalProfiler.nodes[nodeIndex].parent == PROFILER_NODE_NONE) { drawProfileNodeGui(nodeIndex); }
+  }
+#else
+  ImGui::Text("Profiler compiled out (PROFILER_ON 0)");
+#endif
+
+  ImGui::Separator();
+#if GL_DEBUG_LAYER_ON
+  const GlDebugFrameCounts& glCalls = renderStats.glCalls;
+  ImGui::Text("GL calls: %d (%d redundant)", glCalls.callCount, glCalls.redundantCount);
+  for(u32 callType = 0; callType < GlDebugCall_Count; callType++) {
+    if(glCalls.callCounts[callType] == 0) { continue; }
+    ImGui::Text("  %-32s %5d  %5d redundant", glDebugCallNames[callType], glCalls.callCounts[callType],
+                glCalls.redundantCounts[callType]);
+  }
+#else
+  ImGui::Text("GL debug layer compiled out (GL_DEBUG_LAYER_ON 0)");
+#endif
+}
+
+internal_func void finishTraceCapture(const TraceCapture& capture, EditorState* editorState) {
+  char fileName[64];
+  time_t now = time(nullptr);
+  strftime(fileName, sizeof(fileName), "trace_%Y%m%d_%H%M%S.json", localtime(&now));
+  if(writeTraceCapture(capture, fileName)) {
+    addCStringF(&editorState->debugCStringRingBuffer, "Trace of %d frames written to %s", capture.capturedFrameCount, fileName);
+  } else {
+    addCStringF(&editorState->debugCStringRingBuffer, "Error: Could not write trace to %s", fileName);
+  }
+}
+
+/*
+ * Input recordings begin from a freshly loaded world, so that replaying one from a fresh load reproduces the session
+ */
+void toggleInputRecording(World* world, EditorState* editorState) {
+  if(isRecordingInput()) {
+    endInputRecording();
+    addCString(&editorState->debugCStringRingBuffer, "Input recording saved");
+    return;
+  }
+
+  if(!empty(editorState->currentlyLoadedWorld)) {
+    char worldFile[ArrayCount(editorState->currentlyLoadedWorld)];
+    strcpy(worldFile, editorState->currentlyLoadedWorld);
+    pauseRenderThread(&globalRenderThread);
+    cleanupWorld(world);
+    loadWorld(world, editorState, worldFile);
+    resumeRenderThread(&globalRenderThread);
+  }
+
+  char fileName[64];
+  time_t now = time(nullptr);
+  strftime(fileName, sizeof(fileName), "input_%Y%m%d_%H%M%S.noopinput", localtime(&now));
+  if(beginInputRecording(fileName, editorState->currentlyLoadedWorld, editorState->cursorEnabled)) {
+    world->UBOs.fragUbo.time = 0.0f; // NOTE: as at startup, where replays begin
+    addCStringF(&editorState->debugCStringRingBuffer, "Recording input to %s, F10 to stop", fileName);
+  } else {
+    addCStringF(&editorState->debugCStringRingBuffer, "Error: Could not record input to %s", fileName);
+  }
+}
+
+// NOTE: Loads the world the input log was recorded in
+b32 beginInputReplaySession(World* world, EditorState* editorState, const char* inputLogFile) {
+  InputLogHeader header;
+  if(!beginInputReplay(inputLogFile, &header)) {
+    std::cout << "Could not replay input log: " << inputLogFile << std::endl;
+    return false;
+  }
+  if(!empty(header.worldFile)) {
+    if(!fileReadable(header.worldFile)) {
+      std::cout << "Could not load the input log's world: " << header.worldFile << std::endl;
+      return false;
+    }
+    loadWorld(world, editorState, header.worldFile);
+  }
+  editorState->cursorEnabled = header.cursorEnabled;
+  return true;
+}
+
+void portalScene(GLFWwindow* window, const LaunchOptions& options) {
   vec2_u32 windowExtent = getWindowExtent();
   const vec2_u32 initWindowExtent = windowExtent;
   globalWorld.aspect = f32(windowExtent.width) / windowExtent.height;
+  globalWorld.viewportHeight = f32(windowExtent.height);
   glGenQueries(ArrayCount(portalQueryObjects), portalQueryObjects);
 
-  VertexAtt cubePosVertexAtt = cubePosVertexAttBuffers();
-
   initGlobalShaders();
   initGlobalVertexAtts();
+  builtInVertexBufferMark = vertexBufferMark();
 
   initPlayer(&globalWorld.player);
 
   initCamera(&globalWorld.camera, globalWorld.player);
+  resetSimulation(&globalWorld);
 
   globalWorld.fov = fieldOfView(13.5f, 25.0f);
   globalWorld.UBOs.projectionViewModelUbo.projection = perspective(globalWorld.fov, globalWorld.aspect, near, far);
@@ -843,6 +1573,7 @@ void portalScene(GLFWwindow* window) {
   glCullFace(GL_BACK);
   glEnable(GL_STENCIL_TEST);
   glViewport(0, 0, windowExtent.width, windowExtent.height);
+  setLightClusterTileSize(&globalWorld, windowExtent);
 
   // UBOs
   {
@@ -860,29 +1591,74 @@ void portalScene(GLFWwindow* window) {
     // attach buffer to ubo binding point
     glBindBufferRange(GL_UNIFORM_BUFFER, fragUBOBindingIndex, globalWorld.UBOs.fragUboId, 0, sizeof(FragUBO));
 
+    // NOTE: Every scene's lights stay resident in their own block. Blocks are bound by range when a scene is drawn.
+    GLint uboOffsetAlignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uboOffsetAlignment);
+    globalWorld.UBOs.lightUboStride = (u32)(((sizeof(LightUBO) + uboOffsetAlignment - 1) / uboOffsetAlignment) * uboOffsetAlignment);
     glGenBuffers(1, &globalWorld.UBOs.lightUboId);
     // allocate size for buffer
     glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.lightUboId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightUBO), NULL, GL_STATIC_DRAW);
+    glBufferData(GL_UNIFORM_BUFFER, globalWorld.UBOs.lightUboStride * ArrayCount(globalWorld.scenes), NULL, GL_STATIC_DRAW);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    // attach buffer to ubo binding point
-    glBindBufferRange(GL_UNIFORM_BUFFER, lightUBOBindingIndex, globalWorld.UBOs.lightUboId, 0, sizeof(globalWorld.UBOs.lightUbo));
   }
 
+  initFramePackets();
+
   globalWorld.stopWatch = createStopWatch();
+  profilerRegisterThread("Main");
   initGuiState(&globalEditorState);
 
-  loadPrevEditorState(&globalWorld, &globalEditorState);
+  Benchmark benchmark{};
+  if(options.flythroughFile != nullptr) {
+    if(beginBenchmark(&benchmark, &globalWorld, &globalEditorState, options.flythroughFile)) {
+      glfwSwapInterval(0); // NOTE: frame times aren't capped by the display's refresh rate
+    } else {
+      glfwSetWindowShouldClose(window, true);
+    }
+  } else if(options.inputReplayFile != nullptr) {
+    if(!beginInputReplaySession(&globalWorld, &globalEditorState, options.inputReplayFile)) {
+      glfwSetWindowShouldClose(window, true);
+    }
+  } else {
+    loadPrevEditorState(&globalWorld, &globalEditorState);
+    if(options.inputRecordFile != nullptr &&
+       !beginInputRecording(options.inputRecordFile, globalEditorState.currentlyLoadedWorld, globalEditorState.cursorEnabled)) {
+      std::cout << "Could not record input to: " << options.inputRecordFile << std::endl;
+    }
+  }
   enableCursor(window, globalEditorState.cursorEnabled);
 
+  if(options.traceFrameCount > 0) { beginTraceCapture(&globalWorld.traceCapture, globalWorld.renderStats.gpuTimers, options.traceFrameCount); }
+
+  // NOTE: The render thread owns the context from here on, see render_thread.h
+  void* framePackets[RENDER_THREAD_FRAMES_IN_FLIGHT];
+  for(u32 packetIndex = 0; packetIndex < RENDER_THREAD_FRAMES_IN_FLIGHT; packetIndex++) { framePackets[packetIndex] = globalFramePackets + packetIndex; }
+  startRenderThread(&globalRenderThread, window, renderFramePacket, framePackets);
+
+  u32 reportedDroppedInputEventCount = 0;
   while(glfwWindowShouldClose(window) == GL_FALSE)
   {
-    loadInputStateForFrame(window);
     updateStopWatch(&globalWorld.stopWatch);
-    globalWorld.UBOs.fragUbo.time = globalWorld.stopWatch.totalElapsed;
-
-    vec3 playerCenter;
-    vec3 playerViewPosition = calcPlayerViewingPosition(&globalWorld.player);
+    const f32 frameMs = globalWorld.stopWatch.delta * 1000.0f;
+    {
+      PROFILE_SCOPE("Input");
+      loadInputStateForFrame(window, &globalWorld.stopWatch.delta);
+    }
+    if(getDroppedInputEventCount() != reportedDroppedInputEventCount) {
+      addCStringF(&globalEditorState.debugCStringRingBuffer, "Warning: %d input events dropped to a full queue, consider raising INPUT_EVENT_QUEUE_CAPACITY",
+                  getDroppedInputEventCount() - reportedDroppedInputEventCount);
+      reportedDroppedInputEventCount = getDroppedInputEventCount();
+    }
+    if(options.inputReplayFile != nullptr && !isReplayingInput()) {
+      glfwSetWindowShouldClose(window, true);
+      break;
+    }
+    if(isRecordingInput() || isReplayingInput()) { // NOTE: shader time follows the logged frame deltas so replays match
+      globalWorld.UBOs.fragUbo.time += globalWorld.stopWatch.delta;
+    } else {
+      globalWorld.UBOs.fragUbo.time = (f32)globalWorld.stopWatch.totalElapsed;
+    }
+    if(benchmark.active) { stepBenchmark(&benchmark, &globalWorld); }
 
     if (isActive(KeyboardInput_Esc))
     {
@@ -894,11 +1670,34 @@ void portalScene(GLFWwindow* window) {
     if(isActive(KeyboardInput_Alt_Right) && hotPress(KeyboardInput_Enter)) {
       windowExtent = toggleWindowSize(window, initWindowExtent.width, initWindowExtent.height);
       globalWorld.aspect = f32(windowExtent.width) / windowExtent.height;
-      glViewport(0, 0, windowExtent.width, windowExtent.height);
+      globalWorld.viewportHeight = f32(windowExtent.height);
+      setLightClusterTileSize(&globalWorld, windowExtent);
 
       adjustAspectPerspProj(&globalWorld.UBOs.projectionViewModelUbo.projection, globalWorld.fov, globalWorld.aspect);
     }
 
+    if(hotPress(KeyboardInput_F12) && !globalWorld.traceCapture.active) {
+      pauseRenderThread(&globalRenderThread);
+      copyRenderFrameStats(&globalRenderThread, &globalWorld.renderStats); // NOTE: GPU results collected from here on are the trace's
+      beginTraceCapture(&globalWorld.traceCapture, globalWorld.renderStats.gpuTimers, TRACE_DEFAULT_FRAME_COUNT);
+      resumeRenderThread(&globalRenderThread);
+      addCStringF(&globalEditorState.debugCStringRingBuffer, "Capturing trace of %d frames", TRACE_DEFAULT_FRAME_COUNT);
+    }
+
+    if(hotPress(KeyboardInput_F10) && !isReplayingInput()) {
+      toggleInputRecording(&globalWorld, &globalEditorState);
+    }
+
+    if(hotPress(KeyboardInput_F11)) {
+      FlythroughRecorder* recorder = &globalEditorState.flythroughRecorder;
+      if(recorder->recording) {
+        endFlythroughRecording(recorder, &globalEditorState);
+      } else {
+        beginFlythroughRecording(recorder, globalWorld);
+        addCString(&globalEditorState.debugCStringRingBuffer, "Recording flythrough, F11 to stop");
+      }
+    }
+
     // toggle cursor
     if(hotPress(KeyboardInput_Space)) {
       globalEditorState.cursorEnabled = !globalEditorState.cursorEnabled;
@@ -906,67 +1705,46 @@ void portalScene(GLFWwindow* window) {
     }
 
     // gather input
-    b32 leftShiftIsActive = isActive(KeyboardInput_Shift_Left);
-    b32 leftIsActive = isActive(KeyboardInput_A) || isActive(KeyboardInput_Left);
-    b32 rightIsActive = isActive(KeyboardInput_D) || isActive(KeyboardInput_Right);
-    b32 upIsActive = isActive(KeyboardInput_W) || isActive(KeyboardInput_Up);
-    b32 downIsActive = isActive(KeyboardInput_S) || isActive(KeyboardInput_Down);
-    b32 tabHotPress = hotPress(KeyboardInput_Tab);
-    vec2_f64 mouseDelta = getMouseDelta();
-
-    // gather input for movement and camera changes
-    const bool cameraMovementEnabled = !globalEditorState.cursorEnabled;
-    if(cameraMovementEnabled) {
-      b32 lateralMovement = leftIsActive != rightIsActive;
-      b32 forwardMovement = upIsActive != downIsActive;
-      vec3 playerDelta{};
-      if (lateralMovement || forwardMovement)
-      {
-        f32 playerMovementSpeed = leftShiftIsActive ? 8.0f : 4.0f;
-
-        // Camera movement direction
-        vec3 playerMovementDirection{};
-        if (lateralMovement)
-        {
-          playerMovementDirection += rightIsActive ? globalWorld.camera.right : -globalWorld.camera.right;
-        }
-
-        if (forwardMovement)
-        {
-          playerMovementDirection += upIsActive ? globalWorld.camera.forward : -globalWorld.camera.forward;
-        }
-
-        playerMovementDirection = normalize(playerMovementDirection.x, playerMovementDirection.y, 0.0);
-        playerDelta = playerMovementDirection * playerMovementSpeed * globalWorld.stopWatch.delta;
-      }
-
-      // TODO: Do not apply immediately, check for collisions
-      globalWorld.player.boundingBox.min += playerDelta;
-      playerCenter = calcBoundingBoxCenterPosition(globalWorld.player.boundingBox);
-
-      if(tabHotPress) { // switch between third and first person
-        vec3 xyForward = normalize(globalWorld.camera.forward.x, globalWorld.camera.forward.y, 0.0f);
-
-        if(!globalWorld.camera.thirdPerson) {
-          lookAt_ThirdPerson(playerCenter, xyForward, &globalWorld.camera);
-        } else { // camera is first person now
-          vec3 focus = playerViewPosition + xyForward;
-          lookAt_FirstPerson(playerViewPosition, focus, &globalWorld.camera);
-        }
-      }
+    // NOTE: mouse movement and perspective toggles wait for the next simulation step if this frame takes none
+    SimulationInput* simulationInput = &globalWorld.simulationInput;
+    simulationInput->movementEnabled = !globalEditorState.cursorEnabled && !benchmark.active;
+    if(simulationInput->movementEnabled) {
+      vec2_f64 mouseDelta = getMouseDelta();
+      simulationInput->sprint = isActive(KeyboardInput_Shift_Left);
+      simulationInput->left = isActive(KeyboardInput_A) || isActive(KeyboardInput_Left);
+      simulationInput->right = isActive(KeyboardInput_D) || isActive(KeyboardInput_Right);
+      simulationInput->forward = isActive(KeyboardInput_W) || isActive(KeyboardInput_Up);
+      simulationInput->back = isActive(KeyboardInput_S) || isActive(KeyboardInput_Down);
+      simulationInput->togglePerspective |= hotPress(KeyboardInput_Tab);
+      simulationInput->mouseDelta = {simulationInput->mouseDelta.x + mouseDelta.x, simulationInput->mouseDelta.y + mouseDelta.y};
+    } else {
+      *simulationInput = {};
+    }
 
-      const f32 mouseDeltaMultConst = 0.0005f;
-      if(globalWorld.camera.thirdPerson) {
-        updateCamera_ThirdPerson(&globalWorld.camera, playerCenter, f32(-mouseDelta.y * mouseDeltaMultConst),f32(-mouseDelta.x * mouseDeltaMultConst));
-      } else {
-        updateCamera_FirstPerson(&globalWorld.camera, playerDelta, f32(-mouseDelta.y * mouseDeltaMultConst), f32(-mouseDelta.x * mouseDeltaMultConst));
+    // simulate
+    f32 interpolationAlpha;
+    {
+      PROFILE_SCOPE("Simulation");
+      // NOTE: benchmarks take exactly one step per frame so every run simulates the same states
+      u32 stepCount = benchmark.active ? 1 : updateFixedTimestep(&globalWorld.simulationTimestep, globalWorld.stopWatch.delta);
+      f32 timestep = benchmark.active ? benchmark.flythrough.timestep : globalWorld.simulationTimestep.timestep;
+      for(u32 step = 0; step < stepCount; step++) {
+        simulateStep(&globalWorld, timestep);
+        updateFlythroughRecording(&globalEditorState.flythroughRecorder, globalWorld, timestep);
       }
+      interpolationAlpha = benchmark.active ? 1.0f : fixedTimestepAlpha(globalWorld.simulationTimestep);
     }
-    globalWorld.UBOs.projectionViewModelUbo.view = getViewMat(globalWorld.camera);
+
+    // interpolate the state drawn this frame
+    Camera renderCamera = lerpCamera(globalWorld.previousCamera, globalWorld.camera, interpolationAlpha);
+    vec3 renderPlayerMin = lerp(globalWorld.previousPlayerMin, globalWorld.player.boundingBox.min, interpolationAlpha);
+    interpolateEntities(&globalWorld, interpolationAlpha);
+    globalWorld.UBOs.projectionViewModelUbo.view = getViewMat(renderCamera);
+    globalWorld.UBOs.projectionViewModelUbo.cameraPos.xyz = renderCamera.origin;
 
     // Start the Dear ImGui frame
     {
-      ImGui_ImplOpenGL3_NewFrame();
+      PROFILE_SCOPE("ImGui");
       ImGui_ImplGlfw_NewFrame();
       ImGui::NewFrame();
 
@@ -1005,6 +1783,14 @@ void portalScene(GLFWwindow* window) {
             globalEditorState.showDemoWindow = !globalEditorState.showDemoWindow;
           }
 
+          if (ImGui::MenuItem("Performance", NULL)) {
+            globalEditorState.showPerformanceWindow = !globalEditorState.showPerformanceWindow;
+          }
+
+          if (ImGui::MenuItem("Profiler", NULL)) {
+            globalEditorState.showProfilerWindow = !globalEditorState.showProfilerWindow;
+          }
+
           ImGui::EndMenu();
         }
         ImGui::EndMainMenuBar();
@@ -1019,8 +1805,10 @@ void portalScene(GLFWwindow* window) {
           std::string filePathName = ImGuiFileDialog::Instance()->GetFilePathName();
 
           if(fileReadable(filePathName.c_str())) {
+            pauseRenderThread(&globalRenderThread);
             cleanupWorld(&globalWorld);
             loadWorld(&globalWorld, &globalEditorState, filePathName.c_str());
+            resumeRenderThread(&globalRenderThread);
             globalEditorState.cursorEnabled = !globalEditorState.cursorEnabled;
             enableCursor(window, globalEditorState.cursorEnabled);
           } else {
@@ -1056,6 +1844,8 @@ void portalScene(GLFWwindow* window) {
       if(globalEditorState.showDebugTextWindow) {
         ImGui::Begin("Debug text output", &globalEditorState.showDebugTextWindow, ImGuiWindowFlags_None);
         {
+          f32 smoothedDelta = globalWorld.stopWatch.smoothedDelta;
+          ImGui::Text("Frame: %.2f ms (%.1f fps)", smoothedDelta * 1000.0f, smoothedDelta > 0.0f ? 1.0f / smoothedDelta : 0.0f);
           ImGui::BeginChild("Scrolling");
           {
             // TODO: Can I extract this logic while without increasing number of modulos?
@@ -1079,6 +1869,18 @@ void portalScene(GLFWwindow* window) {
         ImGui::End();
       }
 
+      if(globalEditorState.showPerformanceWindow) {
+        ImGui::Begin("Performance", &globalEditorState.showPerformanceWindow, ImGuiWindowFlags_None);
+        drawPerformanceGui(globalWorld.renderStats.gpuTimers);
+        ImGui::End();
+      }
+
+      if(globalEditorState.showProfilerWindow) {
+        ImGui::Begin("Profiler", &globalEditorState.showProfilerWindow, ImGuiWindowFlags_None);
+        drawProfilerGui(globalWorld.renderStats);
+        ImGui::End();
+      }
+
       if(globalEditorState.showDemoWindow)
       {
         ImGui::ShowDemoWindow(&globalEditorState.showDemoWindow);
@@ -1088,76 +1890,30 @@ void portalScene(GLFWwindow* window) {
       ImGui::Render();
     }
 
-    // draw
-    glStencilMask(0xFF);
-    glStencilFunc(GL_ALWAYS, // stencil function always passes
-                  0x00, // reference
-                  0x00); // mask
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-    // universal matrices in UBO
-    glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.projectionViewModelUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(ProjectionViewModelUBO, model), &globalWorld.UBOs.projectionViewModelUbo);
-
-    glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.fragUboId);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FragUBO), &globalWorld.UBOs.fragUbo);
-
-    if(globalWorld.camera.thirdPerson) { // draw player if third person
-      vec3 playerViewCenter = calcPlayerViewingPosition(&globalWorld.player);
-      vec3 playerBoundingBoxColor_Red{1.0f, 0.0f, 0.0f};
-      vec3 playerViewBoxColor_White{1.0f, 1.0f, 1.0f};
-      vec3 playerMinCoordBoxColor_Green{0.0f, 1.0f, 0.0f};
-      vec3 playerMinCoordBoxColor_Black{0.0f, 0.0f, 0.0f};
-
-      mat4 thirdPersonPlayerBoxesModelMatrix;
-
-      glUseProgram(globalShaders.singleColor.id);
-      glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-      glDisable(GL_CULL_FACE);
-
-      // debug player bounding box
-      glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.projectionViewModelUboId);
-      thirdPersonPlayerBoxesModelMatrix = scaleTrans_mat4(globalWorld.player.boundingBox.diagonal, playerCenter);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &thirdPersonPlayerBoxesModelMatrix);
-      setUniform(globalShaders.singleColor.id, baseColorUniformName, playerBoundingBoxColor_Red);
-      drawTriangles(&cubePosVertexAtt);
-
-      // debug player center
-      glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.projectionViewModelUboId);
-      thirdPersonPlayerBoxesModelMatrix = scaleTrans_mat4(0.05f, playerCenter);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &thirdPersonPlayerBoxesModelMatrix);
-      setUniform(globalShaders.singleColor.id, baseColorUniformName, playerMinCoordBoxColor_Black);
-      drawTriangles(&cubePosVertexAtt);
-
-      // debug player min coordinate box
-      glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.projectionViewModelUboId);
-      thirdPersonPlayerBoxesModelMatrix = scaleTrans_mat4(0.1f, globalWorld.player.boundingBox.min);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &thirdPersonPlayerBoxesModelMatrix);
-      setUniform(globalShaders.singleColor.id, baseColorUniformName, playerMinCoordBoxColor_Green);
-      drawTriangles(&cubePosVertexAtt);
-
-      // debug player view
-      glBindBuffer(GL_UNIFORM_BUFFER, globalWorld.UBOs.projectionViewModelUboId);
-      thirdPersonPlayerBoxesModelMatrix = scaleTrans_mat4(0.1f, playerViewCenter);
-      glBufferSubData(GL_UNIFORM_BUFFER, offsetof(ProjectionViewModelUBO, model), sizeof(mat4), &thirdPersonPlayerBoxesModelMatrix);
-      glBindBuffer(GL_UNIFORM_BUFFER, 0);
-      setUniform(globalShaders.singleColor.id, baseColorUniformName, playerViewBoxColor_White);
-      drawTriangles(&cubePosVertexAtt);
-
-      glEnable(GL_CULL_FACE);
-      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // hand the frame to the render thread
+    {
+      FramePacket* framePacket = (FramePacket*)beginFramePacket(&globalRenderThread);
+      recordFramePacket(&globalWorld, renderCamera, renderPlayerMin, windowExtent, frameMs, framePacket);
+      submitFramePacket(&globalRenderThread);
     }
 
-    updateEntities(&globalWorld);
-
-    drawSceneWithPortals(&globalWorld);
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-    glfwSwapBuffers(window); // swaps double buffers (call after all render commands are completed)
     glfwPollEvents(); // checks for events (ex: keyboard/mouse input)
+    profilerEndFrame();
+    copyRenderFrameStats(&globalRenderThread, &globalWorld.renderStats);
+    if(updateTraceCapture(&globalWorld.traceCapture, globalWorld.renderStats, frameMs)) {
+      finishTraceCapture(globalWorld.traceCapture, &globalEditorState);
+    }
+    if(benchmark.active && endBenchmarkFrame(&benchmark, globalWorld, (f32)(secondsSince(globalWorld.stopWatch.lastFrameTicks) * 1000.0))) {
+      glfwSetWindowShouldClose(window, true);
+    }
   }
 
-  saveEditorState(&globalEditorState);
+  stopRenderThread(&globalRenderThread);
+  endInputRecording();
+  // NOTE: benchmarks and replays don't change the editor's world
+  if(options.flythroughFile == nullptr && options.inputReplayFile == nullptr) { saveEditorState(&globalEditorState); }
   cleanupEditorState(&globalEditorState);
   cleanupWorld(&globalWorld);
+  deleteFramePackets();
+  deleteVertexBuffers();
 }
\ No newline at end of file
@@ -0,0 +1,270 @@
+#pragma once
+
+/*
+ * CPU scope profiler
+ * - PROFILE_SCOPE("name") times the rest of the enclosing scope with the CPU's timestamp counter.
+ * - Each thread writes completed scopes to its own ring buffer, only ever read by profilerEndFrame(). The buffer's
+ *   write and read indices are atomics, so no locks are taken on either side.
+ * - profilerEndFrame() drains every thread's buffer into a tree of nodes, one per distinct call path, and keeps
+ *   a history of each node's per frame time for rolling statistics.
+ * - Compiles out entirely when PROFILER_ON is 0, which it is by default in release (NDEBUG) builds.
+ */
+
+#ifndef PROFILER_ON
+#ifdef NDEBUG
+#define PROFILER_ON 0
+#else
+#define PROFILER_ON 1
+#endif
+#endif
+
+#if PROFILER_ON
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#define PROFILER_MAX_THREADS 8
+#define PROFILER_THREAD_EVENT_CAPACITY 4096 // NOTE: must be a power of two
+#define PROFILER_MAX_NODES 512
+#define PROFILER_MAX_DEPTH 32
+#define PROFILER_HISTORY_FRAMES 128
+#define PROFILER_NODE_NONE U32_MAX
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+struct ProfileEvent {
+  const char* name;
+  u64 startCycles;
+  u64 endCycles;
+  u32 depth;
+  u32 threadIndex; // NOTE: set when drained
+};
+
+struct ProfilerThreadBuffer {
+  ProfileEvent events[PROFILER_THREAD_EVENT_CAPACITY];
+  std::atomic<u32> writeIndex; // NOTE: only written by the owning thread
+  std::atomic<u32> readIndex; // NOTE: only written by profilerEndFrame()
+  std::atomic<u32> droppedEventCount; // NOTE: scopes lost to a full buffer
+  u32 depth; // NOTE: scopes currently open on the owning thread
+  u32 rootNode; // NOTE: set by profilerEndFrame()
+  char threadName[32];
+};
+
+struct ProfileNode {
+  const char* name;
+  u32 parent;
+  u32 firstChild;
+  u32 nextSibling;
+  u64 frameCycles;
+  u32 frameCallCount;
+  f32 lastFrameMs; // NOTE: 0 if the node didn't run last frame
+  u32 lastFrameCallCount;
+  f32 historyMs[PROFILER_HISTORY_FRAMES]; // NOTE: ring of the frames the node ran in
+  u32 historyCount;
+  u32 historyNext;
+};
+
+struct ProfileStats {
+  f32 minMs;
+  f32 avgMs;
+  f32 p95Ms;
+  f32 p99Ms;
+};
+
+struct Profiler {
+  std::atomic<ProfilerThreadBuffer*> threads[PROFILER_MAX_THREADS];
+  std::atomic<u32> threadCount;
+  ProfileNode nodes[PROFILER_MAX_NODES];
+  u32 nodeCount;
+  u64 frameStartCycles;
+  u64 frameStartTicks;
+  f64 secondsPerCycle; // NOTE: calibrated against the steady clock every frame, 0 until the first frame ends
+  std::vector<ProfileEvent> frameEvents; // NOTE: every thread's scopes drained by the last profilerEndFrame(), grouped by thread
+};
+
+global_variable Profiler globalProfiler;
+thread_local ProfilerThreadBuffer* localProfilerThreadBuffer = nullptr;
+
+inline u64 profilerCycles() {
+  return __rdtsc();
+}
+
+// NOTE: The calling thread's buffer, registered on first use. Threads are never unregistered.
+ProfilerThreadBuffer* profilerThreadBuffer(const char* threadName = nullptr) {
+  if(localProfilerThreadBuffer != nullptr) { return localProfilerThreadBuffer; }
+  u32 threadIndex = globalProfiler.threadCount.fetch_add(1);
+  Assert(threadIndex < PROFILER_MAX_THREADS);
+  ProfilerThreadBuffer* buffer = new ProfilerThreadBuffer;
+  buffer->writeIndex = 0;
+  buffer->readIndex = 0;
+  buffer->droppedEventCount = 0;
+  buffer->depth = 0;
+  buffer->rootNode = PROFILER_NODE_NONE;
+  if(threadName != nullptr) {
+    snprintf(buffer->threadName, sizeof(buffer->threadName), "%s", threadName);
+  } else {
+    snprintf(buffer->threadName, sizeof(buffer->threadName), "Thread %d", threadIndex);
+  }
+  globalProfiler.threads[threadIndex].store(buffer, std::memory_order_release);
+  localProfilerThreadBuffer = buffer;
+  return buffer;
+}
+
+// NOTE: Optional, names the calling thread's root node. Must be called before the thread's first PROFILE_SCOPE.
+void profilerRegisterThread(const char* threadName) {
+  Assert(localProfilerThreadBuffer == nullptr);
+  profilerThreadBuffer(threadName);
+}
+
+struct ProfileScope {
+  ProfilerThreadBuffer* buffer;
+  const char* name;
+  u64 startCycles;
+
+  ProfileScope(const char* name): buffer(profilerThreadBuffer()), name(name) {
+    buffer->depth++;
+    startCycles = profilerCycles();
+  }
+
+  ~ProfileScope() {
+    u64 endCycles = profilerCycles();
+    buffer->depth--;
+    u32 writeIndex = buffer->writeIndex.load(std::memory_order_relaxed);
+    if(writeIndex - buffer->readIndex.load(std::memory_order_acquire) >= PROFILER_THREAD_EVENT_CAPACITY) {
+      buffer->droppedEventCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    buffer->events[writeIndex & (PROFILER_THREAD_EVENT_CAPACITY - 1)] = ProfileEvent{name, startCycles, endCycles, buffer->depth, 0};
+    buffer->writeIndex.store(writeIndex + 1, std::memory_order_release);
+  }
+};
+
+internal_func u32 addProfileNode(const char* name, u32 parent) {
+  Assert(globalProfiler.nodeCount < PROFILER_MAX_NODES);
+  u32 nodeIndex = globalProfiler.nodeCount++;
+  ProfileNode* node = globalProfiler.nodes + nodeIndex;
+  *node = {};
+  node->name = name;
+  node->parent = parent;
+  node->firstChild = PROFILER_NODE_NONE;
+  node->nextSibling = PROFILER_NODE_NONE;
+  if(parent != PROFILER_NODE_NONE) { // NOTE: appended, so children stay in the order they first ran
+    u32* link = &globalProfiler.nodes[parent].firstChild;
+    while(*link != PROFILER_NODE_NONE) { link = &globalProfiler.nodes[*link].nextSibling; }
+    *link = nodeIndex;
+  }
+  return nodeIndex;
+}
+
+u32 findProfileNode(u32 parent, const char* name) {
+  for(u32 child = globalProfiler.nodes[parent].firstChild; child != PROFILER_NODE_NONE; child = globalProfiler.nodes[child].nextSibling) {
+    const char* childName = globalProfiler.nodes[child].name;
+    if(childName == name || strcmp(childName, name) == 0) { return child; }
+  }
+  return PROFILER_NODE_NONE;
+}
+
+// NOTE: Call once per frame, outside of any PROFILE_SCOPE
+void profilerEndFrame() {
+  u64 frameEndCycles = profilerCycles();
+  u64 frameEndTicks = getTicks();
+  if(globalProfiler.frameStartTicks != 0 && frameEndCycles > globalProfiler.frameStartCycles) {
+    globalProfiler.secondsPerCycle = ticksToSeconds(frameEndTicks - globalProfiler.frameStartTicks) /
+                                     (f64)(frameEndCycles - globalProfiler.frameStartCycles);
+  }
+  globalProfiler.frameStartCycles = frameEndCycles;
+  globalProfiler.frameStartTicks = frameEndTicks;
+
+  for(u32 nodeIndex = 0; nodeIndex < globalProfiler.nodeCount; nodeIndex++) {
+    globalProfiler.nodes[nodeIndex].frameCycles = 0;
+    globalProfiler.nodes[nodeIndex].frameCallCount = 0;
+  }
+
+  globalProfiler.frameEvents.clear();
+  u32 threadCount = Min(globalProfiler.threadCount.load(std::memory_order_acquire), (u32)PROFILER_MAX_THREADS);
+  for(u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    ProfilerThreadBuffer* buffer = globalProfiler.threads[threadIndex].load(std::memory_order_acquire);
+    if(buffer == nullptr) { continue; } // NOTE: registering, its scopes are picked up next frame
+    if(buffer->rootNode == PROFILER_NODE_NONE) { buffer->rootNode = addProfileNode(buffer->threadName, PROFILER_NODE_NONE); }
+
+    u32 readIndex = buffer->readIndex.load(std::memory_order_relaxed);
+    u32 writeIndex = buffer->writeIndex.load(std::memory_order_acquire);
+    size_t firstEvent = globalProfiler.frameEvents.size();
+    for(u32 i = readIndex; i != writeIndex; i++) {
+      globalProfiler.frameEvents.push_back(buffer->events[i & (PROFILER_THREAD_EVENT_CAPACITY - 1)]);
+      globalProfiler.frameEvents.back().threadIndex = threadIndex;
+    }
+    buffer->readIndex.store(writeIndex, std::memory_order_release);
+
+    // NOTE: Scopes complete children first, ordering by start puts every parent right before its subtree
+    std::sort(globalProfiler.frameEvents.begin() + firstEvent, globalProfiler.frameEvents.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+      return a.startCycles != b.startCycles ? a.startCycles < b.startCycles : a.depth < b.depth;
+    });
+    u32 nodeStack[PROFILER_MAX_DEPTH];
+    u32 nodeStackCount = 0;
+    for(size_t eventIndex = firstEvent; eventIndex < globalProfiler.frameEvents.size(); eventIndex++) {
+      const ProfileEvent& event = globalProfiler.frameEvents[eventIndex];
+      // NOTE: an event deeper than the stack has a parent that is still open, it is attached to the deepest known node
+      u32 depth = Min(Min(event.depth, nodeStackCount), (u32)PROFILER_MAX_DEPTH - 1);
+      u32 parent = depth > 0 ? nodeStack[depth - 1] : buffer->rootNode;
+      u32 node = findProfileNode(parent, event.name);
+      if(node == PROFILER_NODE_NONE) {
+        if(globalProfiler.nodeCount == PROFILER_MAX_NODES) { continue; }
+        node = addProfileNode(event.name, parent);
+      }
+      globalProfiler.nodes[node].frameCycles += event.endCycles - event.startCycles;
+      globalProfiler.nodes[node].frameCallCount++;
+      if(depth == 0) { globalProfiler.nodes[buffer->rootNode].frameCycles += event.endCycles - event.startCycles; }
+      nodeStack[depth] = node;
+      nodeStackCount = depth + 1;
+    }
+    globalProfiler.nodes[buffer->rootNode].frameCallCount = globalProfiler.nodes[buffer->rootNode].frameCycles > 0 ? 1 : 0;
+  }
+
+  for(u32 nodeIndex = 0; nodeIndex < globalProfiler.nodeCount; nodeIndex++) {
+    ProfileNode* node = globalProfiler.nodes + nodeIndex;
+    node->lastFrameMs = (f32)(node->frameCycles * globalProfiler.secondsPerCycle * 1000.0);
+    node->lastFrameCallCount = node->frameCallCount;
+    if(node->frameCallCount == 0 || globalProfiler.secondsPerCycle == 0.0) { continue; }
+    node->historyMs[node->historyNext] = node->lastFrameMs;
+    node->historyNext = (node->historyNext + 1) % PROFILER_HISTORY_FRAMES;
+    node->historyCount = Min(node->historyCount + 1, (u32)PROFILER_HISTORY_FRAMES);
+  }
+}
+
+ProfileStats profileNodeStats(const ProfileNode& node) {
+  ProfileStats stats{};
+  if(node.historyCount == 0) { return stats; }
+  f32 sortedMs[PROFILER_HISTORY_FRAMES];
+  f32 totalMs = 0.0f;
+  for(u32 i = 0; i < node.historyCount; i++) {
+    sortedMs[i] = node.historyMs[i];
+    totalMs += node.historyMs[i];
+  }
+  std::sort(sortedMs, sortedMs + node.historyCount);
+  auto percentile = [&sortedMs, &node](f32 fraction) {
+    u32 rank = (u32)ceilf(fraction * node.historyCount);
+    return sortedMs[rank > 0 ? rank - 1 : 0];
+  };
+  stats.minMs = sortedMs[0];
+  stats.avgMs = totalMs / node.historyCount;
+  stats.p95Ms = percentile(0.95f);
+  stats.p99Ms = percentile(0.99f);
+  return stats;
+}
+
+#else
+
+#define PROFILE_SCOPE(name)
+inline void profilerRegisterThread(const char*) {}
+inline void profilerEndFrame() {}
+
+#endif
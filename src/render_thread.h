@@ -0,0 +1,179 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/*
+ * Render thread
+ * - The render thread owns the GL context while it runs. The main thread records every frame into a frame packet,
+ *   everything needed to draw it, and the render thread draws the packets in order then swaps buffers. The main
+ *   thread's next frame overlaps with submitting and presenting the previous one.
+ * - Packets are reused in turn. Beginning a packet waits for the render thread to be done with it, so the main thread
+ *   never runs more than RENDER_THREAD_FRAMES_IN_FLIGHT frames ahead of the last frame drawn.
+ * - The main thread borrows the context for GL work of its own (ex: loading a world) between pauseRenderThread() and
+ *   resumeRenderThread(). Pausing waits for every submitted packet to be drawn.
+ * - GPU timings and GL call counts are measured on the render thread, the main thread reads a copy of them.
+ */
+
+#define RENDER_THREAD_FRAMES_IN_FLIGHT 2
+
+struct RenderFrameStats {
+  GpuTimers gpuTimers;
+#if GL_DEBUG_LAYER_ON
+  GlDebugFrameCounts glCalls;
+#endif
+};
+
+#define RENDER_FRAME_PACKET(name) void name(void* packet, GpuTimers* gpuTimers)
+typedef RENDER_FRAME_PACKET(render_frame_packet);
+
+struct RenderThread {
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable condition;
+  GLFWwindow* window;
+  render_frame_packet* renderFramePacket;
+  void* packets[RENDER_THREAD_FRAMES_IN_FLIGHT];
+  b32 running; // NOTE: only accessed by the main thread
+
+  // NOTE: guarded by mutex
+  u32 submittedCount; // NOTE: packets submitted so far, packet n is packets[n % RENDER_THREAD_FRAMES_IN_FLIGHT]
+  u32 drawnCount; // NOTE: packets drawn so far
+  b32 pauseRequested;
+  b32 paused; // NOTE: the render thread has released the context
+  b32 stopRequested;
+  RenderFrameStats publishedStats; // NOTE: as of the latest packet drawn
+
+  RenderFrameStats stats; // NOTE: only accessed by the render thread once started
+};
+
+internal_func void drawRenderThreadPacket(RenderThread* renderThread, void* packet) {
+  renderThread->renderFramePacket(packet, &renderThread->stats.gpuTimers);
+  {
+    PROFILE_SCOPE("glfwSwapBuffers");
+    glfwSwapBuffers(renderThread->window);
+  }
+  glDebugLayerEndFrame();
+#if GL_DEBUG_LAYER_ON
+  renderThread->stats.glCalls = globalGlDebugLayer.lastFrame;
+#endif
+}
+
+internal_func void renderThreadMain(RenderThread* renderThread) {
+  glfwMakeContextCurrent(renderThread->window);
+  profilerRegisterThread("Render");
+
+  std::unique_lock<std::mutex> lock(renderThread->mutex);
+  while(true) {
+    renderThread->condition.wait(lock, [renderThread] {
+      return renderThread->drawnCount != renderThread->submittedCount || renderThread->pauseRequested || renderThread->stopRequested;
+    });
+
+    // NOTE: submitted packets are always drawn before pausing or stopping
+    if(renderThread->drawnCount != renderThread->submittedCount) {
+      void* packet = renderThread->packets[renderThread->drawnCount % RENDER_THREAD_FRAMES_IN_FLIGHT];
+      lock.unlock();
+      drawRenderThreadPacket(renderThread, packet);
+      lock.lock();
+      renderThread->publishedStats = renderThread->stats;
+      renderThread->drawnCount++;
+      renderThread->condition.notify_all();
+    } else if(renderThread->stopRequested) {
+      break;
+    } else {
+      glfwMakeContextCurrent(nullptr);
+      renderThread->paused = true;
+      renderThread->condition.notify_all();
+      renderThread->condition.wait(lock, [renderThread] { return !renderThread->pauseRequested; });
+      glfwMakeContextCurrent(renderThread->window);
+      renderThread->paused = false;
+    }
+  }
+
+  glfwMakeContextCurrent(nullptr);
+}
+
+// NOTE: Call on the thread the window's context is current on, the context is handed over to the render thread
+void startRenderThread(RenderThread* renderThread, GLFWwindow* window, render_frame_packet* renderFramePacket, void** packets) {
+  Assert(!renderThread->running);
+  renderThread->window = window;
+  renderThread->renderFramePacket = renderFramePacket;
+  for(u32 packetIndex = 0; packetIndex < RENDER_THREAD_FRAMES_IN_FLIGHT; packetIndex++) {
+    renderThread->packets[packetIndex] = packets[packetIndex];
+  }
+  renderThread->submittedCount = 0;
+  renderThread->drawnCount = 0;
+  renderThread->pauseRequested = false;
+  renderThread->paused = false;
+  renderThread->stopRequested = false;
+  initGpuTimers(&renderThread->stats.gpuTimers);
+  renderThread->publishedStats = renderThread->stats;
+
+  glfwMakeContextCurrent(nullptr);
+  renderThread->running = true;
+  renderThread->thread = std::thread(renderThreadMain, renderThread);
+}
+
+// NOTE: Draws every packet submitted, then hands the context back to the calling thread
+void stopRenderThread(RenderThread* renderThread) {
+  Assert(renderThread->running);
+  {
+    std::lock_guard<std::mutex> lock(renderThread->mutex);
+    renderThread->stopRequested = true;
+  }
+  renderThread->condition.notify_all();
+  renderThread->thread.join();
+  renderThread->running = false;
+
+  glfwMakeContextCurrent(renderThread->window);
+  deleteGpuTimers(&renderThread->stats.gpuTimers);
+}
+
+// NOTE: Waits for the render thread to be done with the packet, it is the caller's until submitFramePacket()
+void* beginFramePacket(RenderThread* renderThread) {
+  PROFILE_SCOPE("Wait for render thread");
+  std::unique_lock<std::mutex> lock(renderThread->mutex);
+  renderThread->condition.wait(lock, [renderThread] {
+    return renderThread->submittedCount - renderThread->drawnCount < RENDER_THREAD_FRAMES_IN_FLIGHT;
+  });
+  return renderThread->packets[renderThread->submittedCount % RENDER_THREAD_FRAMES_IN_FLIGHT];
+}
+
+void submitFramePacket(RenderThread* renderThread) {
+  {
+    std::lock_guard<std::mutex> lock(renderThread->mutex);
+    renderThread->submittedCount++;
+  }
+  renderThread->condition.notify_all();
+}
+
+void copyRenderFrameStats(RenderThread* renderThread, Out RenderFrameStats* stats) {
+  std::lock_guard<std::mutex> lock(renderThread->mutex);
+  *stats = renderThread->publishedStats;
+}
+
+// NOTE: Makes the context current on the calling thread once every submitted packet is drawn, does nothing if the
+// render thread isn't running
+void pauseRenderThread(RenderThread* renderThread) {
+  if(!renderThread->running) { return; }
+  PROFILE_SCOPE("pauseRenderThread");
+  {
+    std::unique_lock<std::mutex> lock(renderThread->mutex);
+    Assert(!renderThread->pauseRequested);
+    renderThread->pauseRequested = true;
+    renderThread->condition.notify_all();
+    renderThread->condition.wait(lock, [renderThread] { return renderThread->paused; });
+  }
+  glfwMakeContextCurrent(renderThread->window);
+}
+
+void resumeRenderThread(RenderThread* renderThread) {
+  if(!renderThread->running) { return; }
+  glfwMakeContextCurrent(nullptr);
+  {
+    std::lock_guard<std::mutex> lock(renderThread->mutex);
+    renderThread->pauseRequested = false;
+  }
+  renderThread->condition.notify_all();
+}
@@ -67,6 +67,15 @@ struct SaveFormat {
   std::vector<ShaderSaveFormat> shaders;
 };
 
+struct FlythroughSaveFormat {
+  std::string worldFile;
+  u32 startingSceneIndex; // NOTE: scene the path starts in, portal crossings along the path may change it
+  f32 timestep; // NOTE: simulated seconds per frame
+  u32 warmupFrames; // NOTE: frames held on the first keyframe before measuring
+  u32 frameCount; // NOTE: measured frames
+  std::vector<FlythroughKeyframe> keyframes;
+};
+
 void save(const SaveFormat& saveFormat, const char* saveFileName) {
   nlohmann::json saveJson{};
 
@@ -383,4 +392,70 @@ SaveFormat loadSave(const char* saveJson) {
   }
 
   return saveFormat;
-}
\ No newline at end of file
+}
+
+void saveFlythrough(const FlythroughSaveFormat& flythrough, const char* saveFileName) {
+  nlohmann::json saveJson{};
+  saveJson["worldFile"] = flythrough.worldFile;
+  saveJson["startingSceneIndex"] = flythrough.startingSceneIndex;
+  saveJson["timestep"] = flythrough.timestep;
+  saveJson["warmupFrames"] = flythrough.warmupFrames;
+  saveJson["frameCount"] = flythrough.frameCount;
+
+  nlohmann::json keyframesJson;
+  for(const FlythroughKeyframe& keyframe : flythrough.keyframes) {
+    keyframesJson.push_back({
+            {"time", keyframe.time},
+            {"viewPosition", {keyframe.viewPosition.x, keyframe.viewPosition.y, keyframe.viewPosition.z}},
+            {"pitch", keyframe.pitch},
+            {"yaw", keyframe.yaw}
+    });
+  }
+  saveJson["keyframes"] = keyframesJson;
+
+  std::ofstream o(saveFileName);
+  o << std::setw(4) << saveJson << std::endl;
+}
+
+FlythroughSaveFormat loadFlythrough(const char* flythroughJson) {
+  FlythroughSaveFormat flythrough{};
+
+  nlohmann::json json;
+  { // parse file
+    std::ifstream flythroughJsonFileInput(flythroughJson);
+    flythroughJsonFileInput >> json;
+  }
+
+  json["worldFile"].get_to(flythrough.worldFile);
+  flythrough.startingSceneIndex = json["startingSceneIndex"];
+  flythrough.timestep = json["timestep"].is_null() ? FLYTHROUGH_DEFAULT_TIMESTEP : (f32)json["timestep"];
+  flythrough.warmupFrames = json["warmupFrames"].is_null() ? FLYTHROUGH_DEFAULT_WARMUP_FRAMES : (u32)json["warmupFrames"];
+
+  size_t keyframeCount = json["keyframes"].size();
+  flythrough.keyframes.reserve(keyframeCount);
+  for(u32 keyframeIndex = 0; keyframeIndex < keyframeCount; keyframeIndex++) {
+    nlohmann::json keyframeJson = json["keyframes"][keyframeIndex];
+    FlythroughKeyframe keyframe;
+    keyframe.time = keyframeJson["time"];
+    Assert(keyframeJson["viewPosition"].size() == 3);
+    keyframe.viewPosition = {
+            keyframeJson["viewPosition"][0],
+            keyframeJson["viewPosition"][1],
+            keyframeJson["viewPosition"][2]
+    };
+    keyframe.pitch = keyframeJson["pitch"];
+    keyframe.yaw = keyframeJson["yaw"];
+    Assert(flythrough.keyframes.empty() || keyframe.time > flythrough.keyframes.back().time);
+    flythrough.keyframes.push_back(keyframe);
+  }
+
+  // NOTE: by default the whole path is measured
+  if(json["frameCount"].is_null()) {
+    f32 duration = flythrough.keyframes.empty() ? 0.0f : flythrough.keyframes.back().time;
+    flythrough.frameCount = (u32)ceilf(duration / flythrough.timestep) + 1;
+  } else {
+    flythrough.frameCount = json["frameCount"];
+  }
+
+  return flythrough;
+}
@@ -1,32 +1,42 @@
 #pragma once
 
-internal_func u32 loadShader(const char* shaderPath, GLenum shaderType);
+#define SHADER_INCLUDE_MAX_DEPTH 8
 
-ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* noiseTexture = nullptr) {
-  ShaderProgram shaderProgram{};
-  shaderProgram.vertexFileName = cStrAllocateAndCopy(vertexPath);
-  shaderProgram.fragmentFileName = cStrAllocateAndCopy(fragmentPath);
-  shaderProgram.vertexShader = loadShader(shaderProgram.vertexFileName, GL_VERTEX_SHADER);
-  shaderProgram.fragmentShader = loadShader(shaderProgram.fragmentFileName, GL_FRAGMENT_SHADER);
+internal_func u32 loadShader(const char* shaderPath, GLenum shaderType, u32 permutationFlags = 0, Out u32* referencedPermutationFlags = nullptr);
 
-  // shader program
-  shaderProgram.id = glCreateProgram(); // NOTE: returns 0 if error occurs when creating program
-  glAttachShader(shaderProgram.id, shaderProgram.vertexShader);
-  glAttachShader(shaderProgram.id, shaderProgram.fragmentShader);
-  glLinkProgram(shaderProgram.id);
+internal_func GLuint linkShaderProgram(GLuint vertexShader, GLuint fragmentShader) {
+  GLuint programId = glCreateProgram(); // NOTE: returns 0 if error occurs when creating program
+  glAttachShader(programId, vertexShader);
+  glAttachShader(programId, fragmentShader);
+  glLinkProgram(programId);
 
   s32 linkSuccess;
-  glGetProgramiv(shaderProgram.id, GL_LINK_STATUS, &linkSuccess);
+  glGetProgramiv(programId, GL_LINK_STATUS, &linkSuccess);
   if (!linkSuccess)
   {
     char infoLog[512];
-    glGetProgramInfoLog(shaderProgram.id, 512, NULL, infoLog);
+    glGetProgramInfoLog(programId, 512, NULL, infoLog);
     std::cout << "ERROR::PROGRAM::SHADER::LINK_FAILED\n" << infoLog << std::endl;
     exit(-1);
   }
 
-  glDetachShader(shaderProgram.id, shaderProgram.vertexShader);
-  glDetachShader(shaderProgram.id, shaderProgram.fragmentShader);
+  glDetachShader(programId, vertexShader);
+  glDetachShader(programId, fragmentShader);
+  return programId;
+}
+
+ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPath, const char* noiseTexture = nullptr) {
+  ShaderProgram shaderProgram{};
+  shaderProgram.vertexFileName = cStrAllocateAndCopy(vertexPath);
+  shaderProgram.fragmentFileName = cStrAllocateAndCopy(fragmentPath);
+  u32 vertexPermutationMask, fragmentPermutationMask;
+  shaderProgram.vertexShader = loadShader(shaderProgram.vertexFileName, GL_VERTEX_SHADER, 0, &vertexPermutationMask);
+  shaderProgram.fragmentShader = loadShader(shaderProgram.fragmentFileName, GL_FRAGMENT_SHADER, 0, &fragmentPermutationMask);
+  shaderProgram.permutationMask = vertexPermutationMask | fragmentPermutationMask;
+
+  // shader program
+  shaderProgram.id = linkShaderProgram(shaderProgram.vertexShader, shaderProgram.fragmentShader);
+  shaderProgram.permutationIds[0] = shaderProgram.id;
 
   if(noiseTexture != nullptr) {
     shaderProgram.noiseTextureFileName = cStrAllocateAndCopy(noiseTexture);
@@ -36,6 +46,22 @@ ShaderProgram createShaderProgram(const char* vertexPath, const char* fragmentPa
   return shaderProgram;
 }
 
+// NOTE: Flags the shader source never references are ignored, so meshes with differing flags can share a program.
+// NOTE: Permutations are compiled the first time they are requested. Request them at load time to avoid hitches.
+GLuint shaderPermutationId(ShaderProgram* shaderProgram, u32 permutationFlags) {
+  u32 permutation = permutationFlags & shaderProgram->permutationMask;
+  Assert(permutation < SHADER_PERMUTATION_COUNT);
+  if(shaderProgram->permutationIds[permutation] == 0) {
+    GLuint vertexShader = loadShader(shaderProgram->vertexFileName, GL_VERTEX_SHADER, permutation);
+    GLuint fragmentShader = loadShader(shaderProgram->fragmentFileName, GL_FRAGMENT_SHADER, permutation);
+    shaderProgram->permutationIds[permutation] = linkShaderProgram(vertexShader, fragmentShader);
+    // NOTE: only the base permutation holds on to its shader objects
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+  }
+  return shaderProgram->permutationIds[permutation];
+}
+
 void deleteShaderProgram(ShaderProgram* shaderProgram)
 {
   // delete the shaders
@@ -45,6 +71,11 @@ void deleteShaderProgram(ShaderProgram* shaderProgram)
   glDeleteShader(shaderProgram->vertexShader);
   glDeleteShader(shaderProgram->fragmentShader);
   glDeleteProgram(shaderProgram->id);
+  for(u32 permutation = 1; permutation < SHADER_PERMUTATION_COUNT; permutation++) {
+    if(shaderProgram->permutationIds[permutation] != 0) {
+      glDeleteProgram(shaderProgram->permutationIds[permutation]);
+    }
+  }
 
   if(shaderProgram->noiseTextureFileName != nullptr) {
     delete[] shaderProgram->noiseTextureFileName;
@@ -78,6 +109,10 @@ inline void setSampler2D(GLuint shaderId, const std::string& name, GLint activeT
   glUniform1i(glGetUniformLocation(shaderId, name.c_str()), activeTextureIndex);
 }
 
+inline void setSamplerBuffer(GLuint shaderId, const std::string& name, GLint activeTextureIndex) {
+  glUniform1i(glGetUniformLocation(shaderId, name.c_str()), activeTextureIndex);
+}
+
 inline void setUniform(GLuint shaderId, const std::string& name, f32 value)
 {
   glUniform1f(glGetUniformLocation(shaderId, name.c_str()), value);
@@ -163,11 +198,93 @@ void readShaderCodeAsString(const char* shaderPath, std::string* shaderCode)
   }
 }
 
+// NOTE: Replaces each line of the form '#include "relative/path.glsl"' with the contents of that file.
+// NOTE: Paths are relative to the including file and each file is only included once per shader.
+internal_func void resolveShaderIncludes(const char* shaderPath, std::string* shaderCode, std::vector<std::string>* includedPaths, u32 depth = 0) {
+  Assert(depth < SHADER_INCLUDE_MAX_DEPTH);
+
+  std::string directory = shaderPath;
+  size_t lastSlash = directory.find_last_of("/\\");
+  directory = (lastSlash == std::string::npos) ? "" : directory.substr(0, lastSlash + 1);
+
+  std::istringstream inputStream(*shaderCode);
+  std::string resolvedCode;
+  std::string line;
+  u32 lineNumber = 0;
+  while(std::getline(inputStream, line)) {
+    lineNumber++;
+    size_t directiveStart = line.find_first_not_of(" \t");
+    if(directiveStart == std::string::npos || line.compare(directiveStart, 8, "#include") != 0) {
+      resolvedCode += line + '\n';
+      continue;
+    }
+
+    size_t includePathStart = line.find('"', directiveStart);
+    size_t includePathEnd = includePathStart == std::string::npos ? std::string::npos : line.find('"', includePathStart + 1);
+    if(includePathEnd == std::string::npos) {
+      std::cout << "ERROR::SHADER::MALFORMED_INCLUDE - " << shaderPath << "(" << lineNumber << ")" << std::endl;
+      resolvedCode += '\n';
+      continue;
+    }
+
+    std::string includePath = directory + line.substr(includePathStart + 1, includePathEnd - includePathStart - 1);
+    if(std::find(includedPaths->begin(), includedPaths->end(), includePath) != includedPaths->end()) {
+      resolvedCode += '\n'; // already included, keep line numbers intact
+      continue;
+    }
+    includedPaths->push_back(includePath);
+
+    std::string includeCode;
+    readShaderCodeAsString(includePath.c_str(), &includeCode);
+    resolveShaderIncludes(includePath.c_str(), &includeCode, includedPaths, depth + 1);
+    // NOTE: #line directives keep compile error line numbers relative to the file they came from
+    resolvedCode += "#line 1\n" + includeCode + "#line " + std::to_string(lineNumber + 1) + '\n';
+  }
+
+  *shaderCode = resolvedCode;
+}
+
+// NOTE: Defines must come after the #version directive, which must be the first directive of the shader
+internal_func void injectShaderDefines(u32 permutationFlags, std::string* shaderCode) {
+  std::string defines = "#define MAX_DIR_LIGHTS " + std::to_string(MAX_DIR_LIGHTS) + '\n';
+  defines += "#define LIGHT_CLUSTER_COUNT_X " + std::to_string(LIGHT_CLUSTER_COUNT_X) + '\n';
+  defines += "#define LIGHT_CLUSTER_COUNT_Y " + std::to_string(LIGHT_CLUSTER_COUNT_Y) + '\n';
+  defines += "#define LIGHT_CLUSTER_COUNT_Z " + std::to_string(LIGHT_CLUSTER_COUNT_Z) + '\n';
+  defines += "#define DRAW_INSTANCE_TEXEL_COUNT " + std::to_string(DRAW_INSTANCE_TEXEL_COUNT) + '\n';
+  for(u32 flagIndex = 0; flagIndex < ArrayCount(shaderPermutationDefineNames); flagIndex++) {
+    if(flagIsSet(permutationFlags, 1 << flagIndex)) {
+      defines += std::string("#define ") + shaderPermutationDefineNames[flagIndex] + '\n';
+    }
+  }
+
+  size_t versionStart = shaderCode->find("#version");
+  size_t versionEnd = versionStart == std::string::npos ? std::string::npos : shaderCode->find('\n', versionStart);
+  if(versionEnd == std::string::npos) {
+    *shaderCode = defines + "#line 1\n" + *shaderCode;
+    return;
+  }
+
+  u32 versionLineNumber = (u32)std::count(shaderCode->begin(), shaderCode->begin() + versionEnd, '\n') + 1;
+  shaderCode->insert(versionEnd + 1, defines + "#line " + std::to_string(versionLineNumber + 1) + '\n');
+}
+
+internal_func u32 shaderPermutationFlagsReferenced(const std::string& shaderCode) {
+  u32 referencedFlags = 0;
+  for(u32 flagIndex = 0; flagIndex < ArrayCount(shaderPermutationDefineNames); flagIndex++) {
+    if(shaderCode.find(shaderPermutationDefineNames[flagIndex]) != std::string::npos) {
+      referencedFlags |= 1 << flagIndex;
+    }
+  }
+  return referencedFlags;
+}
+
 /*
  * parameters:
  * shaderType can be GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, or GL_GEOMETRY_SHADER
+ * permutationFlags are ShaderPermutationFlags to be injected as #defines
+ * referencedPermutationFlags (optional) returns the ShaderPermutationFlags the shader source checks for
  */
-internal_func u32 loadShader(const char* shaderPath, GLenum shaderType) {
+internal_func u32 loadShader(const char* shaderPath, GLenum shaderType, u32 permutationFlags, Out u32* referencedPermutationFlags) {
   std::string shaderTypeStr;
   if(shaderType == GL_VERTEX_SHADER) {
     shaderTypeStr = "VERTEX";
@@ -177,6 +294,12 @@ internal_func u32 loadShader(const char* shaderPath, GLenum shaderType) {
 
   std::string shaderCode;
   readShaderCodeAsString(shaderPath, &shaderCode);
+  std::vector<std::string> includedPaths;
+  resolveShaderIncludes(shaderPath, &shaderCode, &includedPaths);
+  if(referencedPermutationFlags != nullptr) {
+    *referencedPermutationFlags = shaderPermutationFlagsReferenced(shaderCode);
+  }
+  injectShaderDefines(permutationFlags, &shaderCode);
   const char* shaderCodeCStr = shaderCode.c_str();
 
   u32 shader = glCreateShader(shaderType);
@@ -189,7 +312,7 @@ internal_func u32 loadShader(const char* shaderPath, GLenum shaderType) {
   {
     char infoLog[512];
     glGetShaderInfoLog(shader, 512, NULL, infoLog);
-    std::cout << "ERROR::SHADER::" << shaderTypeStr << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+    std::cout << "ERROR::SHADER::" << shaderTypeStr << "::COMPILATION_FAILED - " << shaderPath << "\n" << infoLog << std::endl;
   }
 
   return shader;
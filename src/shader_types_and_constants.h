@@ -7,21 +7,51 @@
 // NOTE: Assuming 8 bits per stencil value
 #define MAX_STENCIL_VALUE 0xFF
 
+// NOTE: Injected into every shader as a #define of the same name
+#define MAX_DIR_LIGHTS 8
+#define LIGHT_CLUSTER_COUNT_X 16
+#define LIGHT_CLUSTER_COUNT_Y 9
+#define LIGHT_CLUSTER_COUNT_Z 24
+#define DRAW_INSTANCE_TEXEL_COUNT 8 // NOTE: RGBA32F texels per DrawInstance (see draw_list.h)
+
+// NOTE: Positional lights are culled into view space clusters on the CPU (see lights.h) and never live in a UBO
+#define MAX_POS_LIGHTS 256
+
+/*
+ * Permutation flags are injected into both shader stages as a #define (see shaderPermutationDefineNames)
+ * NOTE: SHADER_PERMUTATION_COUNT must remain 2^(number of flags)
+ */
+enum ShaderPermutationFlags {
+  ShaderPermutation_HasAlbedoMap = 1 << 0,
+  ShaderPermutation_HasNormalMap = 1 << 1,
+  ShaderPermutation_DrawInstanced = 1 << 2,
+};
+#define SHADER_PERMUTATION_COUNT 8
+const char* shaderPermutationDefineNames[] = {
+        "HAS_ALBEDO_MAP",
+        "HAS_NORMAL_MAP",
+        "DRAW_INSTANCED",
+};
+
 struct ShaderProgram {
-  GLuint id;
+  GLuint id; // NOTE: permutation with no flags set, always equal to permutationIds[0]
   GLuint vertexShader;
   GLuint fragmentShader;
   GLuint noiseTextureId;
   const char* vertexFileName;
   const char* fragmentFileName;
   const char* noiseTextureFileName;
+  u32 permutationMask; // NOTE: ShaderPermutationFlags actually referenced by the shader source
+  GLuint permutationIds[SHADER_PERMUTATION_COUNT]; // NOTE: 0 until the permutation has been compiled
 };
 
 u32 projectionViewModelUBOBindingIndex = 0;
 struct ProjectionViewModelUBO {  // base alignment   // aligned offset
-  mat4 projection;               // 4                // 0
-  mat4 view;                     // 4                // 64
-  mat4 model;                    // 4                // 128
+  mat4 projection;               // 16               // 0
+  mat4 view;                     // 16               // 64
+  vec4 cameraPos;                // 16               // 128 // w unused
+  mat4 model;                    // 16               // 144
+  mat4 normal;                   // 16               // 208 // upper-left 3x3 used
 };
 
 u32 fragUBOBindingIndex = 1;
@@ -34,45 +64,45 @@ struct LightUniform {
   vec4 color; // NOTE: fourth component used for light power
   vec4 pos; // NOTE: fourth component for padding, currently un-defined
 };
-struct LightUBO {
-  vec4 ambientLight;
-  LightUniform dirPosLightStack[8];
-  u32 dirLightCount;
-  u32 posLightCount;
+struct LightUBO {                     // base alignment   // aligned offset
+  vec4 ambientLight;                  // 16               // 0
+  LightUniform dirLights[MAX_DIR_LIGHTS]; // 16           // 16
+  u32 dirLightCount;                  // 4                // 272
+  u32 posLightCount;                  // 4                // 276
+  f32 clusterSliceScale;              // 4                // 280
+  f32 clusterSliceBias;               // 4                // 284
+  vec2 clusterTileSize;               // 8                // 288 // NOTE: in pixels
 };
 
-/*NOTE: GLSL Shader UBO Examples
-layout (binding = 0, std140) uniform UBO {
-  mat4 projection;
-  mat4 view;
-  mat4 model;
-} ubo;
-
-layout (binding = 1, std140) uniform FragUBO {
-  float time;
-} fragUbo;
-
-layout (binding = 2, std140) uniform LightInfoUBO {
-        vec3 directionalLightColor;
-        vec3 ambientLightColor;
-        vec3 directionalLightDirToSource;
-} lightInfoUbo;
-*/
+// NOTE: GLSL declarations of these UBOs are shared by all shaders in src/shaders/include/UBOs.glsl
 
 const char* baseColorUniformName = "baseColor";
 const char* skyboxTexUniformName = "skyboxTex";
 const char* albedoTexUniformName = "albedoTex";
 const char* normalTexUniformName = "normalTex";
 const char* noiseTexUniformName = "noiseTex";
+const char* posLightsTexUniformName = "posLightsTex";
+const char* lightClustersTexUniformName = "lightClustersTex";
+const char* lightIndicesTexUniformName = "lightIndicesTex";
+const char* drawInstancesTexUniformName = "drawInstancesTex";
+const char* firstDrawInstanceUniformName = "firstDrawInstance";
 /* NOTE: GLSL Shader Texture Usage Examples
 uniform vec4 baseColor;
 uniform samplerCube skyboxTex;
 uniform sampler2D albedoTex;
 uniform sampler2D normalTex;
 uniform sampler2D noiseTex;
+uniform samplerBuffer posLightsTex;
+uniform usamplerBuffer lightClustersTex;
+uniform usamplerBuffer lightIndicesTex;
+uniform samplerBuffer drawInstancesTex;
  */
 
 const s32 skyboxActiveTextureIndex = 0;
 const s32 albedoActiveTextureIndex = 1;
 const s32 normalActiveTextureIndex = 2;
-const s32 noiseActiveTextureIndex = 3;
\ No newline at end of file
+const s32 noiseActiveTextureIndex = 3;
+const s32 posLightsActiveTextureIndex = 4;
+const s32 lightClustersActiveTextureIndex = 5;
+const s32 lightIndicesActiveTextureIndex = 6;
+const s32 drawInstancesActiveTextureIndex = 7;
\ No newline at end of file
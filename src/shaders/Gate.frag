@@ -5,35 +5,35 @@ layout (location = 1) in vec2 inTexCoord;
 layout (location = 2) in vec3 inFragmentWorldPos;
 layout (location = 3) in vec3 inCameraWorldPos;
 
-layout (binding = 1, std140) uniform FragUBO {
-  float time;
-} fragUbo;
-
-struct InLight {
-  vec4 color;
-  vec4 pos;
-};
-
-layout (binding = 2, std140) uniform LightInfoUBO {
-  vec4 ambientLightColor;
-  InLight dirPosLightStack[8];
-  uint dirLightCount;
-  uint posLightCount;
-} lightInfoUbo;
+#include "include/UBOs.glsl"
+#include "include/ClusteredLights.glsl"
 
+#ifdef HAS_ALBEDO_MAP
 uniform sampler2D albedoTex;
+#else
+uniform vec3 baseColor;
+#endif
+#ifdef HAS_NORMAL_MAP
 uniform sampler2D normalTex;
+#endif
 uniform sampler2D noiseTex;
 
 const float noiseStength = 40.0;
 
 layout (location = 0) out vec4 outColor;
 
+#ifdef HAS_NORMAL_MAP
 vec3 getNormal(vec2 texCoord);
+#endif
 
 void main() {
+#if defined(HAS_ALBEDO_MAP) || defined(HAS_NORMAL_MAP)
   vec2 time = vec2(fragUbo.time * 10.0);
+#ifdef HAS_ALBEDO_MAP
   vec2 albedoTexSize = textureSize(albedoTex, 0);
+#else
+  vec2 albedoTexSize = textureSize(normalTex, 0);
+#endif
   vec2 noiseTexSize = textureSize(noiseTex, 0);
 
   vec2 noiseTexCoord = ((inTexCoord * albedoTexSize) / noiseTexSize) + (vec2(-time.x, time.y) / noiseTexSize);
@@ -42,23 +42,35 @@ void main() {
   noise = noise * noiseStength;
   vec2 texCoordNoise = inTexCoord + (vec2(noise) / albedoTexSize);
   vec2 texCoordNoiseTime = texCoordNoise + (time / albedoTexSize);
+#endif
 
+#ifdef HAS_ALBEDO_MAP
   vec3 albedoColor = texture(albedoTex, texCoordNoiseTime).rgb;
+#else
+  vec3 albedoColor = baseColor;
+#endif
 
+#ifdef HAS_NORMAL_MAP
   vec3 surfaceNormal = getNormal(texCoordNoiseTime);
+#else
+  vec3 surfaceNormal = normalize(inNormal);
+#endif
 
   vec3 lightContribution = lightInfoUbo.ambientLightColor.rgb * lightInfoUbo.ambientLightColor.a;
 
-  float directLightContribution = 0.0;
-  for(uint i = 0; i < lightInfoUbo.dirLightCount; i++) {
-    vec3 surfaceToSource = lightInfoUbo.dirPosLightStack[i].pos.xyz;
+  // NOTE: Constant trip count allows the compiler to unroll the loop
+  for(uint i = 0; i < MAX_DIR_LIGHTS; i++) {
+    if(i >= lightInfoUbo.dirLightCount) { break; }
+    vec3 surfaceToSource = lightInfoUbo.dirLights[i].pos.xyz;
     float cosTerm = max(dot(surfaceNormal, surfaceToSource), 0.0);
-    lightContribution += lightInfoUbo.dirPosLightStack[i].color.rgb * lightInfoUbo.dirPosLightStack[i].color.a * cosTerm;
+    lightContribution += lightInfoUbo.dirLights[i].color.rgb * lightInfoUbo.dirLights[i].color.a * cosTerm;
   }
+  lightContribution += positionalLightContribution(inFragmentWorldPos, surfaceNormal);
 
   outColor = vec4(lightContribution * albedoColor, 1.0);
 }
 
+#ifdef HAS_NORMAL_MAP
 // Note: https://github.com/SaschaWillems/Vulkan-glTF-PBR/blob/master/data/shaders/pbr.vert
 vec3 getNormal(vec2 texCoord)
 {
@@ -76,4 +88,5 @@ vec3 getNormal(vec2 texCoord)
   mat3 TBN = mat3(T, B, N);
 
   return normalize(TBN * tangentNormal);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
@@ -1,13 +1,10 @@
 #version 420
 layout (location = 0) in vec3 inPos;
 
-layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
-  mat4 projection;                         // 64               // 0
-  mat4 view;                               // 64               // 64
-  mat4 model;                              // 64             // 128
-} ubo;
+#include "include/UBOs.glsl"
+#include "include/DrawInstance.glsl"
 
 void main()
 {
-  gl_Position = ubo.projection * ubo.view * ubo.model * vec4(inPos, 1.0);
+  gl_Position = ubo.projection * ubo.view * modelMat() * vec4(inPos, 1.0);
 }
\ No newline at end of file
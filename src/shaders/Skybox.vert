@@ -1,11 +1,7 @@
 #version 420
 layout (location = 0) in vec3 inPos;
 
-layout (binding = 0, std140) uniform UBO {
-  mat4 projection;
-  mat4 view;
-//mat4 model; //NOTE: Available but not needed
-} ubo;
+#include "include/UBOs.glsl"
 
 layout (location = 0) out vec3 outTexCoord;
 
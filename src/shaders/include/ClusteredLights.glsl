@@ -0,0 +1,35 @@
+// NOTE: Requires UBOs.glsl. Positional lights are binned into view space clusters on the CPU (see lights.h).
+// LIGHT_CLUSTER_COUNT_X/Y/Z are injected by the shader loader.
+
+uniform samplerBuffer posLightsTex; // two texels per light: (color.rgb, power) & (pos.xyz, radius)
+uniform usamplerBuffer lightClustersTex; // (first index into lightIndicesTex, light count) per cluster
+uniform usamplerBuffer lightIndicesTex;
+
+uint lightClusterIndex(vec3 worldPos) {
+  uvec2 tile = min(uvec2(gl_FragCoord.xy / lightInfoUbo.clusterTileSize),
+                   uvec2(LIGHT_CLUSTER_COUNT_X - 1, LIGHT_CLUSTER_COUNT_Y - 1));
+  float viewDepth = -(ubo.view * vec4(worldPos, 1.0)).z;
+  float slice = (log(viewDepth) * lightInfoUbo.clusterSliceScale) - lightInfoUbo.clusterSliceBias;
+  uint sliceIndex = uint(clamp(slice, 0.0, float(LIGHT_CLUSTER_COUNT_Z - 1)));
+  return tile.x + (LIGHT_CLUSTER_COUNT_X * (tile.y + (LIGHT_CLUSTER_COUNT_Y * sliceIndex)));
+}
+
+vec3 positionalLightContribution(vec3 worldPos, vec3 surfaceNormal) {
+  vec3 lightContribution = vec3(0.0);
+  uvec2 clusterOffsetCount = texelFetch(lightClustersTex, int(lightClusterIndex(worldPos))).rg;
+  for(uint i = 0; i < clusterOffsetCount.y; i++) {
+    int lightIndex = int(texelFetch(lightIndicesTex, int(clusterOffsetCount.x + i)).r);
+    vec4 colorPower = texelFetch(posLightsTex, lightIndex * 2);
+    vec4 posRadius = texelFetch(posLightsTex, (lightIndex * 2) + 1);
+
+    vec3 surfaceToSource = posRadius.xyz - worldPos;
+    float distSquared = dot(surfaceToSource, surfaceToSource);
+    float cosTerm = max(dot(surfaceNormal, surfaceToSource * inversesqrt(max(distSquared, 0.0001))), 0.0);
+    // NOTE: window reaches zero at the light's radius, so lights never pop as they leave a cluster
+    float distOverRadiusSquared = distSquared / (posRadius.w * posRadius.w);
+    float window = clamp(1.0 - (distOverRadiusSquared * distOverRadiusSquared), 0.0, 1.0);
+    float falloff = (window * window) / (1.0 + distSquared);
+    lightContribution += colorPower.rgb * colorPower.a * falloff * cosTerm;
+  }
+  return lightContribution;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+// NOTE: Requires UBOs.glsl. Vertex shaders fetch their model & normal matrices through these functions.
+// With DRAW_INSTANCED, matrices come from the instance data of an instanced draw (see draw_list.h).
+// Otherwise, they come from the model & normal matrices of the UBO.
+
+#ifdef DRAW_INSTANCED
+uniform samplerBuffer drawInstancesTex; // DRAW_INSTANCE_TEXEL_COUNT texels per instance: model columns & normal columns
+uniform int firstDrawInstance;
+
+mat4 drawInstanceMat4(int firstTexel) {
+  return mat4(texelFetch(drawInstancesTex, firstTexel),
+              texelFetch(drawInstancesTex, firstTexel + 1),
+              texelFetch(drawInstancesTex, firstTexel + 2),
+              texelFetch(drawInstancesTex, firstTexel + 3));
+}
+
+mat4 modelMat() {
+  return drawInstanceMat4((firstDrawInstance + gl_InstanceID) * DRAW_INSTANCE_TEXEL_COUNT);
+}
+
+mat3 normalMat() {
+  return mat3(drawInstanceMat4(((firstDrawInstance + gl_InstanceID) * DRAW_INSTANCE_TEXEL_COUNT) + 4));
+}
+#else
+mat4 modelMat() {
+  return ubo.model;
+}
+
+mat3 normalMat() {
+  return mat3(ubo.normal);
+}
+#endif
@@ -0,0 +1,21 @@
+// NOTE: Define REFRACTIVE_INDEX before including to refract, otherwise reflects
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec3 inNormal;
+layout (location = 2) in vec3 inCameraPos;
+
+uniform samplerCube skyboxTex;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+  vec3 cameraToPos = normalize(inPos - inCameraPos);
+#ifdef REFRACTIVE_INDEX
+  vec3 envMapDir = refract(cameraToPos, inNormal, 1.0 / REFRACTIVE_INDEX);
+#else
+  vec3 envMapDir = reflect(cameraToPos, inNormal);
+#endif
+  // NOTE: samplerCubes assume y is up, so we must adjust accordingly
+  vec3 envMapDirYIsUp = vec3(envMapDir.x, envMapDir.z, -envMapDir.y);
+  outColor = vec4(texture(skyboxTex, envMapDirYIsUp).rgb, 1.0);
+}
@@ -0,0 +1,28 @@
+// NOTE: MAX_DIR_LIGHTS is injected by the shader loader to match LightUBO in shader_types_and_constants.h
+
+layout (binding = 0, std140) uniform UBO { // base alignment   // aligned offset
+  mat4 projection;                         // 16               // 0
+  mat4 view;                               // 16               // 64
+  vec4 cameraPos;                          // 16               // 128
+  mat4 model;                              // 16               // 144
+  mat4 normal;                             // 16               // 208
+} ubo;
+
+layout (binding = 1, std140) uniform FragUBO {
+  float time;
+} fragUbo;
+
+struct InLight {
+  vec4 color;
+  vec4 pos;
+};
+
+layout (binding = 2, std140) uniform LightInfoUBO {
+  vec4 ambientLightColor;
+  InLight dirLights[MAX_DIR_LIGHTS];
+  uint dirLightCount;
+  uint posLightCount;
+  float clusterSliceScale;
+  float clusterSliceBias;
+  vec2 clusterTileSize;
+} lightInfoUbo;
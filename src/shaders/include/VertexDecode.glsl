@@ -0,0 +1,11 @@
+// NOTE: Decoding for quantized vertex attributes (see PosNormTexVertex in vertex_attributes.h).
+// Positions need no decoding, their dequantization is folded into the model matrix.
+
+// NOTE: Inverse of the octahedral encoding in octEncode() of noop_math.h
+vec3 octDecode(vec2 encoded) {
+  vec3 result = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+  if(result.z < 0.0) {
+    result.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+  }
+  return normalize(result);
+}
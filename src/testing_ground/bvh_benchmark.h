@@ -0,0 +1,132 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+
+#include "../bvh.h"
+#include "../timer.h"
+
+/*
+ * Compares BVH queries against linear scans over randomly scattered boxes of increasing count.
+ * Query results are checked against the linear scans as well.
+ */
+
+internal_func f32 benchmarkRandom(u32* state) { // NOTE: xorshift32, [0,1)
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return (*state >> 8) * (1.0f / 16777216.0f);
+}
+
+internal_func mat4 benchmarkView(const vec3& position, const vec3& forward) {
+  vec3 right = normalize(cross(forward, vec3{0.0f, 0.0f, 1.0f}));
+  vec3 up = cross(right, forward);
+  mat4 view;
+  view.col[0] = {right.x, up.x, -forward.x, 0.0f};
+  view.col[1] = {right.y, up.y, -forward.y, 0.0f};
+  view.col[2] = {right.z, up.z, -forward.z, 0.0f};
+  view.col[3] = {-dot(right, position), -dot(up, position), dot(forward, position), 1.0f};
+  return view;
+}
+
+void runBVHBenchmark() {
+  const u32 itemCounts[] = {16, 128, 1024, 8192, 65536};
+  const u32 queryCount = 1000;
+  const f32 worldSize = 1000.0f;
+  u32 randomState = 0x9E3779B9;
+
+  printf("BVH benchmark (%d queries, microseconds per query)\n", queryCount);
+  printf("%8s | %10s %10s | %10s %10s | %10s %10s | %9s %9s\n", "items", "box bvh", "box scan", "ray bvh", "ray scan",
+         "frust bvh", "frust scan", "build ms", "refit us");
+  for(u32 countIndex = 0; countIndex < ArrayCount(itemCounts); countIndex++) {
+    u32 itemCount = itemCounts[countIndex];
+    std::vector<BoundingBox> itemBounds(itemCount);
+    for(u32 item = 0; item < itemCount; item++) {
+      vec3 min{benchmarkRandom(&randomState), benchmarkRandom(&randomState), benchmarkRandom(&randomState)};
+      vec3 diagonal{benchmarkRandom(&randomState), benchmarkRandom(&randomState), benchmarkRandom(&randomState)};
+      itemBounds[item] = BoundingBox{min * worldSize, (diagonal * 10.0f) + vec3{0.1f, 0.1f, 0.1f}};
+    }
+
+    BVH bvh;
+    initBVH(&bvh, itemCount);
+    u64 buildStart = getTicks();
+    buildBVH(&bvh, itemBounds.data(), itemCount);
+    f64 buildSeconds = secondsSince(buildStart);
+
+    std::vector<u32> bvhItems(itemCount);
+    std::vector<u32> scanItems(itemCount);
+    f64 boxSeconds[2] = {}, raySeconds[2] = {}, frustumSeconds[2] = {};
+    for(u32 query = 0; query < queryCount; query++) {
+      vec3 point = vec3{benchmarkRandom(&randomState), benchmarkRandom(&randomState), benchmarkRandom(&randomState)} * worldSize;
+
+      // box overlap
+      BoundingBox box{point, {20.0f, 20.0f, 20.0f}};
+      u64 start = getTicks();
+      u32 bvhItemCount = queryBVHOverlap(bvh, box, bvhItems.data(), itemCount);
+      boxSeconds[0] += secondsSince(start);
+      start = getTicks();
+      u32 scanItemCount = 0;
+      for(u32 item = 0; item < itemCount; item++) {
+        if(overlap(itemBounds[item], box)) { scanItems[scanItemCount++] = item; }
+      }
+      boxSeconds[1] += secondsSince(start);
+      std::sort(bvhItems.begin(), bvhItems.begin() + bvhItemCount);
+      Assert(bvhItemCount == scanItemCount && std::equal(scanItems.begin(), scanItems.begin() + scanItemCount, bvhItems.begin()));
+
+      // closest ray hit
+      vec3 direction = normalize(vec3{benchmarkRandom(&randomState), benchmarkRandom(&randomState), benchmarkRandom(&randomState)} - vec3{0.5f, 0.5f, 0.5f});
+      vec3 inverseDirection{1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+      u32 bvhHit = BVH_NODE_NONE;
+      f32 bvhHitDistance = 0.0f;
+      start = getTicks();
+      queryBVHRay(bvh, point, direction, worldSize, &bvhHit, &bvhHitDistance);
+      raySeconds[0] += secondsSince(start);
+      start = getTicks();
+      u32 scanHit = BVH_NODE_NONE;
+      f32 scanHitDistance = worldSize;
+      for(u32 item = 0; item < itemCount; item++) {
+        f32 distance;
+        if(rayBoxIntersection(point, inverseDirection, itemBounds[item], scanHitDistance, &distance)) {
+          scanHitDistance = distance;
+          scanHit = item;
+        }
+      }
+      raySeconds[1] += secondsSince(start);
+      Assert(bvhHit == scanHit || epsilonComparison(bvhHitDistance, scanHitDistance)); // NOTE: ties may pick either
+
+      // frustum
+      mat4 view = benchmarkView(point, direction);
+      vec4 planes[6];
+      frustumPlanes(perspective(60.0f * RadiansPerDegree, 16.0f / 9.0f, 0.1f, 200.0f) * view, planes);
+      start = getTicks();
+      bvhItemCount = queryBVHFrustum(bvh, planes, bvhItems.data(), itemCount);
+      frustumSeconds[0] += secondsSince(start);
+      start = getTicks();
+      scanItemCount = 0;
+      for(u32 item = 0; item < itemCount; item++) {
+        if(frustumBoxIntersection(planes, itemBounds[item])) { scanItems[scanItemCount++] = item; }
+      }
+      frustumSeconds[1] += secondsSince(start);
+      Assert(bvhItemCount == scanItemCount);
+    }
+
+    // move some items, queries must stay correct after refitting
+    u64 refitStart = getTicks();
+    for(u32 item = 0; item < itemCount; item += 8) {
+      itemBounds[item].min += vec3{benchmarkRandom(&randomState), benchmarkRandom(&randomState), benchmarkRandom(&randomState)} * 50.0f;
+      refitBVHItem(&bvh, item, itemBounds[item]);
+    }
+    f64 refitSeconds = secondsSince(refitStart);
+    for(u32 item = 0; item < itemCount; item += 8) {
+      u32 bvhItemCount = queryBVHOverlap(bvh, itemBounds[item], bvhItems.data(), itemCount);
+      Assert(std::find(bvhItems.begin(), bvhItems.begin() + bvhItemCount, item) != bvhItems.begin() + bvhItemCount);
+    }
+
+    const f64 microsecondsPerQuery = 1000000.0 / queryCount;
+    printf("%8d | %10.3f %10.3f | %10.3f %10.3f | %10.3f %10.3f | %9.3f %9.3f\n", itemCount,
+           boxSeconds[0] * microsecondsPerQuery, boxSeconds[1] * microsecondsPerQuery,
+           raySeconds[0] * microsecondsPerQuery, raySeconds[1] * microsecondsPerQuery,
+           frustumSeconds[0] * microsecondsPerQuery, frustumSeconds[1] * microsecondsPerQuery,
+           buildSeconds * 1000.0, refitSeconds * 1000000.0 / ((itemCount + 7) / 8));
+    deleteBVH(&bvh);
+  }
+}
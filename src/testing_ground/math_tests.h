@@ -2,12 +2,20 @@
 #include <math.h>
 #include <stdio.h>
 #include <windows.h>
+#include <xmmintrin.h>
 
 #undef near
 #undef far
 
 #include "../noop_types.h"
 #include "../noop_math.h"
+#include "../collision.h"
+#include "../portal_crossing.h"
+#include "../timer.h"
+#include "../profiler.h"
+#include "../flythrough.h"
+#include "../mesh_optimization.h"
+#include "../mesh_simplification.h"
 
 global_variable HANDLE hConsole;
 
@@ -367,6 +375,585 @@ void inversePerspectiveTests() {
   printIfNotEqual(shouldBeIdentityFOV, identity_mat4());
 }
 
+void mat3InverseTest() {
+  mat3 A = rotate_mat3(0.7f, vec3{1.0f, -2.0f, 0.5f}) * scale_mat3(vec3{2.0f, 0.5f, 3.0f});
+  mat3 inverseA = inverse(A);
+
+  Assert(inverseA * A == identity_mat3());
+  Assert(A * inverseA == identity_mat3());
+}
+
+void normalMatTest() {
+  mat4 modelMat = scaleRotTrans_mat4(vec3{4.0f, 1.0f, 0.25f}, vec3{0.0f, 0.0f, 1.0f}, 1.2f, vec3{3.0f, -7.0f, 2.0f});
+  mat3 normalMatrix = normalMat(modelMat);
+
+  // a surface normal must stay perpendicular to a transformed tangent of that surface
+  vec3 normal = normalize(1.0f, 1.0f, 1.0f);
+  vec3 tangent = normalize(1.0f, -1.0f, 0.0f);
+  vec3 transformedNormal = normalMatrix * normal;
+  vec3 transformedTangent = (modelMat * Vec4(tangent, 0.0f)).xyz;
+  Assert(epsilonComparison(dot(transformedNormal, transformedTangent), 0.0f));
+
+  // uniform scale normal matrices only differ from the model matrix by a scalar
+  mat4 uniformModelMat = scaleRotTrans_mat4(vec3{2.0f, 2.0f, 2.0f}, vec3{0.0f, 0.0f, 1.0f}, 1.2f, vec3{0.0f, 0.0f, 0.0f});
+  Assert(normalize(normalMat(uniformModelMat) * normal) == normalize((uniformModelMat * Vec4(normal, 0.0f)).xyz));
+}
+
+void octahedralEncodingTest() {
+  vec3 unitVecs[] = {
+          {1.0f, 0.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f},
+          normalize(1.0f, 1.0f, 1.0f), normalize(-1.0f, 2.0f, -3.0f), normalize(0.3f, -0.2f, -0.9f)
+  };
+  for(u32 i = 0; i < ArrayCount(unitVecs); i++) {
+    vec2 encoded = octEncode(unitVecs[i]);
+    Assert(fabsf(encoded.x) <= 1.0f && fabsf(encoded.y) <= 1.0f);
+    Assert(octDecode(encoded) == unitVecs[i]);
+
+    // survives a round trip through snorm16
+    vec2 quantized{dequantizeSnorm16(quantizeSnorm16(encoded.x)), dequantizeSnorm16(quantizeSnorm16(encoded.y))};
+    Assert(octDecode(quantized) == unitVecs[i]);
+  }
+}
+
+void halfFloatTest() {
+  Assert(halfFloat(0.0f) == 0x0000);
+  Assert(halfFloat(-0.0f) == 0x8000);
+  Assert(halfFloat(1.0f) == 0x3C00);
+  Assert(halfFloat(-2.0f) == 0xC000);
+  Assert(halfFloat(65504.0f) == 0x7BFF); // largest half
+  Assert(halfFloat(100000.0f) == 0x7C00); // overflows to infinity
+  Assert(halfFloat(5.9604645e-8f) == 0x0001); // smallest subnormal half
+  Assert(halfFloat(1.0f + (1.0f / 2048.0f)) == 0x3C00); // ties round to even
+  Assert(halfFloat(1.0f + (3.0f / 2048.0f)) == 0x3C02);
+
+  f32 values[] = {0.5f, 0.25f, 0.125f, 0.9f, -3.75f, 1024.0f, 0.000123f};
+  for(u32 i = 0; i < ArrayCount(values); i++) {
+    f32 roundTrip = floatFromHalf(halfFloat(values[i]));
+    Assert(fabsf(roundTrip - values[i]) <= fabsf(values[i]) * (1.0f / 2048.0f));
+  }
+}
+
+void transformBoundingBoxTest() {
+  BoundingBox box{{1.0f, 2.0f, 3.0f}, {2.0f, 4.0f, 6.0f}};
+  vec3 corners[8];
+  for(u32 i = 0; i < 8; i++) {
+    corners[i] = box.min + hadamard(box.diagonal, vec3{f32(i & 1), f32((i >> 1) & 1), f32((i >> 2) & 1)});
+  }
+
+  mat4 transforms[] = {
+          identity_mat4(),
+          scaleTrans_mat4(vec3{2.0f, 0.5f, 1.0f}, vec3{-1.0f, 3.0f, 0.0f}),
+          scaleRotTrans_mat4(vec3{1.0f, 2.0f, 3.0f}, vec3{0.0f, 0.0f, 1.0f}, 30.0f * RadiansPerDegree, vec3{5.0f, -2.0f, 1.0f}),
+          scaleRotTrans_mat4(vec3{0.5f, 0.5f, 0.5f}, normalize(1.0f, -2.0f, 0.5f), 120.0f * RadiansPerDegree, vec3{0.0f, 0.0f, -4.0f})
+  };
+  for(u32 i = 0; i < ArrayCount(transforms); i++) {
+    // bounds of the transformed box match the bounds of its transformed corners
+    vec3 cornersMin{F32_MAX, F32_MAX, F32_MAX};
+    vec3 cornersMax{-F32_MAX, -F32_MAX, -F32_MAX};
+    for(u32 j = 0; j < 8; j++) {
+      vec3 corner = (transforms[i] * Vec4(corners[j], 1.0f)).xyz;
+      cornersMin = {Min(cornersMin.x, corner.x), Min(cornersMin.y, corner.y), Min(cornersMin.z, corner.z)};
+      cornersMax = {Max(cornersMax.x, corner.x), Max(cornersMax.y, corner.y), Max(cornersMax.z, corner.z)};
+    }
+    BoundingBox transformedBox = transformBoundingBox(box, transforms[i]);
+    Assert(transformedBox.min == cornersMin);
+    Assert(transformedBox.diagonal == cornersMax - cornersMin);
+  }
+
+  BoundingBox boxUnion = boundingBoxUnion(box, BoundingBox{{-1.0f, 3.0f, 4.0f}, {1.0f, 10.0f, 1.0f}});
+  Assert(boxUnion.min == (vec3{-1.0f, 2.0f, 3.0f}));
+  Assert(boxUnion.diagonal == (vec3{4.0f, 11.0f, 6.0f}));
+}
+
+void rayBoxIntersectionTest() {
+  BoundingBox box{{1.0f, -1.0f, -1.0f}, {2.0f, 2.0f, 2.0f}};
+  f32 distance;
+
+  vec3 direction = {1.0f, 0.0f, 0.0f};
+  vec3 inverseDirection = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+  Assert(rayBoxIntersection(vec3{}, inverseDirection, box, 10.0f, &distance));
+  Assert(epsilonComparison(distance, 1.0f));
+  Assert(!rayBoxIntersection(vec3{}, inverseDirection, box, 0.5f)); // box beyond max distance
+  Assert(!rayBoxIntersection(vec3{}, -inverseDirection, box, 10.0f)); // box behind ray
+  Assert(rayBoxIntersection(vec3{2.0f, 0.0f, 0.0f}, inverseDirection, box, 10.0f, &distance)); // starts inside
+  Assert(distance == 0.0f);
+
+  direction = normalize(1.0f, 1.0f, 0.0f);
+  inverseDirection = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+  Assert(rayBoxIntersection(vec3{0.0f, -1.0f, 0.0f}, inverseDirection, box, 10.0f, &distance));
+  Assert(epsilonComparison(distance, sqrtf(2.0f)));
+  Assert(!rayBoxIntersection(vec3{0.0f, 2.0f, 0.0f}, inverseDirection, box, 10.0f));
+
+  // parallel ray starting exactly on a slab
+  direction = {0.0f, 1.0f, 0.0f};
+  inverseDirection = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+  Assert(rayBoxIntersection(vec3{1.0f, -5.0f, 0.0f}, inverseDirection, box, 10.0f, &distance));
+  Assert(epsilonComparison(distance, 4.0f));
+}
+
+void frustumPlanesTest() {
+  mat4 projection = perspective(90.0f * RadiansPerDegree, 1.0f, 0.1f, 100.0f);
+  vec4 planes[6];
+  frustumPlanes(projection, planes);
+
+  // NOTE: OpenGL views look down -z
+  auto box = [](vec3 center) { return BoundingBox{center - vec3{0.5f, 0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}}; };
+  Assert(frustumBoxIntersection(planes, box({0.0f, 0.0f, -10.0f})));
+  Assert(frustumBoxIntersection(planes, box({9.9f, 0.0f, -10.0f}))); // straddles right plane
+  Assert(!frustumBoxIntersection(planes, box({0.0f, 0.0f, 10.0f}))); // behind
+  Assert(!frustumBoxIntersection(planes, box({12.0f, 0.0f, -10.0f}))); // right of frustum
+  Assert(!frustumBoxIntersection(planes, box({0.0f, -12.0f, -10.0f}))); // below frustum
+  Assert(!frustumBoxIntersection(planes, box({0.0f, 0.0f, -101.0f}))); // beyond far plane
+
+  // planes are normalized, the near plane sits 0.1 in front of the camera
+  Assert(epsilonComparison(magnitude(planes[4].xyz), 1.0f));
+  Assert(epsilonComparison(dot(planes[4].xyz, vec3{0.0f, 0.0f, -0.1f}) + planes[4].w, 0.0f));
+}
+
+void sweepBoxesTest() {
+  BoundingBox box{{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+  BoundingBox wall{{3.0f, -5.0f, -5.0f}, {1.0f, 10.0f, 10.0f}};
+  f32 hitTime;
+  vec3 hitNormal;
+  Assert(sweepBoxes(box, {4.0f, 0.0f, 0.0f}, wall, &hitTime, &hitNormal));
+  Assert(epsilonComparison(hitTime, 0.5f));
+  Assert(hitNormal == (vec3{-1.0f, 0.0f, 0.0f}));
+  Assert(!sweepBoxes(box, {1.0f, 0.0f, 0.0f}, wall, &hitTime, &hitNormal)); // stops short
+  Assert(!sweepBoxes(box, {-4.0f, 0.0f, 0.0f}, wall, &hitTime, &hitNormal)); // moving away
+  Assert(!sweepBoxes(box, {0.0f, 4.0f, 0.0f}, wall, &hitTime, &hitNormal)); // moving parallel
+  Assert(!sweepBoxes(BoundingBox{{3.5f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}}, {1.0f, 0.0f, 0.0f}, wall, &hitTime, &hitNormal)); // already overlapping
+}
+
+// NOTE: Scripted movements of a player sized box through a room, checked against the expected resting positions
+void moveAndSlideTest() {
+  const vec3 playerSize{0.25f, 0.25f, 1.75f};
+  const BoundingBox obstacles[] = {
+          {{5.0f, -10.0f, 0.0f}, {0.1f, 20.0f, 3.0f}}, // thin wall facing -x
+          {{-10.0f, 5.0f, 0.0f}, {20.0f, 1.0f, 3.0f}}, // wall facing -y
+  };
+  const f32 skinTolerance = 2.0f * COLLISION_SKIN;
+
+  // walking straight into a wall stops at the wall
+  BoundingBox player{{0.0f, 0.0f, 0.0f}, playerSize};
+  vec3 moved = moveAndSlide(player, {10.0f, 0.0f, 0.0f}, obstacles, ArrayCount(obstacles));
+  Assert(moved.x <= 5.0f - playerSize.x && moved.x > 5.0f - playerSize.x - skinTolerance);
+  Assert(moved.y == 0.0f && moved.z == 0.0f);
+
+  // walking into a wall at an angle slides along it
+  moved = moveAndSlide(player, {10.0f, 2.0f, 0.0f}, obstacles, ArrayCount(obstacles));
+  Assert(moved.x <= 5.0f - playerSize.x && moved.x > 5.0f - playerSize.x - skinTolerance);
+  Assert(epsilonComparison(moved.y, 2.0f));
+
+  // walking into the corner stops against both walls
+  moved = moveAndSlide(player, {10.0f, 10.0f, 0.0f}, obstacles, ArrayCount(obstacles));
+  Assert(moved.x <= 5.0f - playerSize.x && moved.x > 5.0f - playerSize.x - skinTolerance);
+  Assert(moved.y <= 5.0f - playerSize.y && moved.y > 5.0f - playerSize.y - skinTolerance);
+
+  // a single large step can't tunnel through the thin wall
+  moved = moveAndSlide(player, {1000.0f, 0.0f, 0.0f}, obstacles, ArrayCount(obstacles));
+  Assert(moved.x < 5.0f);
+
+  // many small steps into the wall neither tunnel nor end up overlapping it
+  for(u32 step = 0; step < 1000; step++) {
+    player.min += moveAndSlide(player, {0.0161f, 0.0037f, 0.0f}, obstacles, ArrayCount(obstacles));
+    for(u32 i = 0; i < ArrayCount(obstacles); i++) { Assert(!overlap(player, obstacles[i])); }
+  }
+  Assert(player.min.x > 5.0f - playerSize.x - skinTolerance && player.min.x <= 5.0f - playerSize.x);
+
+  // starting inside an obstacle never traps the player
+  BoundingBox stuckPlayer{{5.0f, 0.0f, 0.0f}, playerSize};
+  moved = moveAndSlide(stuckPlayer, {-1.0f, 0.0f, 0.0f}, obstacles, ArrayCount(obstacles));
+  Assert(epsilonComparison(moved.x, -1.0f));
+}
+
+void portalCrossingTest() {
+  // NOTE: three 2x3 portals in a row facing -y, then one facing +x
+  PortalRects rects{};
+  setPortalRect(&rects, 0, {0.0f, 0.0f, 1.5f}, {0.0f, -1.0f, 0.0f}, {2.0f, 3.0f});
+  setPortalRect(&rects, 1, {0.0f, 2.0f, 1.5f}, {0.0f, -1.0f, 0.0f}, {2.0f, 3.0f});
+  setPortalRect(&rects, 2, {0.0f, 4.0f, 1.5f}, {0.0f, -1.0f, 0.0f}, {2.0f, 3.0f});
+  setPortalRect(&rects, 3, {10.0f, 0.0f, 1.5f}, {1.0f, 0.0f, 0.0f}, {2.0f, 3.0f});
+  u32 portalIndex;
+  f32 t;
+
+  // a small step through the front of a portal
+  Assert(firstPortalCrossing(rects, 4, {0.5f, -0.05f, 1.6f}, {0.5f, 0.05f, 1.6f}, 0.0f, &portalIndex, &t));
+  Assert(portalIndex == 0 && epsilonComparison(t, 0.5f));
+  // stepping back out through the back of the same portal isn't a crossing
+  Assert(!firstPortalCrossing(rects, 4, {0.5f, 0.05f, 1.6f}, {0.5f, -0.05f, 1.6f}, 0.0f, &portalIndex, &t));
+  // passing the plane beside or above the portal isn't a crossing
+  Assert(!firstPortalCrossing(rects, 4, {1.5f, -0.05f, 1.6f}, {1.5f, 0.05f, 1.6f}, 0.0f, &portalIndex, &t));
+  Assert(!firstPortalCrossing(rects, 4, {0.5f, -0.05f, 3.1f}, {0.5f, 0.05f, 3.1f}, 0.0f, &portalIndex, &t));
+  // ending exactly on the plane counts, so the next test starting there won't cross it again
+  Assert(firstPortalCrossing(rects, 4, {0.5f, -1.0f, 1.6f}, {0.5f, 0.0f, 1.6f}, 0.0f, &portalIndex, &t));
+  Assert(portalIndex == 0 && t == 1.0f);
+  Assert(!firstPortalCrossing(rects, 4, {0.5f, 0.0f, 1.6f}, {0.5f, 1.0f, 1.6f}, 0.0f, &portalIndex, &t));
+
+  // a large step, like a long frame while sprinting, crosses every portal along it in order
+  const vec3 from{0.5f, -1.0f, 1.6f};
+  const vec3 to{0.5f, 7.0f, 1.6f};
+  const f32 expectedT[] = {0.125f, 0.375f, 0.625f};
+  t = 0.0f;
+  for(u32 i = 0; i < ArrayCount(expectedT); i++) {
+    Assert(firstPortalCrossing(rects, 4, from, to, t, &portalIndex, &t));
+    Assert(portalIndex == i && epsilonComparison(t, expectedT[i]));
+  }
+  Assert(!firstPortalCrossing(rects, 4, from, to, t, &portalIndex, &t));
+  // portals past the count are ignored
+  Assert(firstPortalCrossing(rects, 1, from, to, 0.0f, &portalIndex, &t) && portalIndex == 0);
+  Assert(!firstPortalCrossing(rects, 1, from, to, t, &portalIndex, &t));
+  // the portal facing +x is only crossed moving in -x
+  Assert(firstPortalCrossing(rects, 4, {12.0f, 0.5f, 1.0f}, {8.0f, 0.5f, 1.0f}, 0.0f, &portalIndex, &t));
+  Assert(portalIndex == 3 && epsilonComparison(t, 0.5f));
+
+  // facing and in focus
+  u32 inFocusMask;
+  u32 facingMask = portalsFacingPoint(rects, 4, {0.5f, -1.0f, 1.6f}, &inFocusMask);
+  Assert(facingMask == 0b0111 && inFocusMask == 0b0111);
+  facingMask = portalsFacingPoint(rects, 4, {0.5f, 3.0f, 1.6f}, &inFocusMask);
+  Assert(facingMask == 0b0100 && inFocusMask == 0b0100);
+  facingMask = portalsFacingPoint(rects, 4, {11.0f, 5.0f, 1.6f}, &inFocusMask);
+  Assert(facingMask == 0b1000 && inFocusMask == 0); // facing beside the portal
+}
+
+void stopWatchTest() {
+  StopWatch stopWatch = createStopWatch();
+  u64 previousTicks = stopWatch.startTicks;
+  f64 scopedSeconds = 0.0;
+  for(u32 i = 0; i < 100; i++) {
+    ScopedTimer scopedTimer(&scopedSeconds);
+    updateStopWatch(&stopWatch);
+    Assert(stopWatch.lastFrameTicks >= previousTicks); // monotonic
+    Assert(stopWatch.delta >= 0.0f);
+    previousTicks = stopWatch.lastFrameTicks;
+  }
+  Assert(stopWatch.totalElapsed == ticksToSeconds(stopWatch.lastFrameTicks - stopWatch.startTicks));
+  Assert(scopedSeconds > 0.0 && scopedSeconds <= secondsSince(stopWatch.startTicks));
+  Assert(ticksToSeconds(0) == 0.0);
+}
+
+void fixedTimestepTest() {
+  const f32 epsilon = 0.001f;
+  FixedTimestep fixedTimestep = createFixedTimestep(0.01f);
+  Assert(updateFixedTimestep(&fixedTimestep, 0.025f) == 2);
+  Assert(fabsf(fixedTimestepAlpha(fixedTimestep) - 0.5f) < epsilon);
+  Assert(updateFixedTimestep(&fixedTimestep, 0.004f) == 0); // NOTE: frames shorter than a step take no steps
+  Assert(fabsf(fixedTimestepAlpha(fixedTimestep) - 0.9f) < epsilon);
+  Assert(updateFixedTimestep(&fixedTimestep, 0.006f) == 1);
+  Assert(fabsf(fixedTimestepAlpha(fixedTimestep) - 0.5f) < epsilon);
+  Assert(fixedTimestep.stepCount == 3);
+
+  // long frames are capped and keep their remainder
+  Assert(updateFixedTimestep(&fixedTimestep, 1.0f) == FIXED_TIMESTEP_MAX_STEPS_PER_UPDATE);
+  Assert(fixedTimestep.accumulator >= 0.0 && fixedTimestep.accumulator < fixedTimestep.timestep);
+  Assert(fabsf(fixedTimestepAlpha(fixedTimestep) - 0.5f) < epsilon);
+  Assert(fixedTimestep.stepCount == 3 + FIXED_TIMESTEP_MAX_STEPS_PER_UPDATE);
+}
+
+void profilerTest() {
+#if PROFILER_ON
+  profilerEndFrame(); // NOTE: starts the first frame, calibration needs one full frame
+  const u32 frameCount = 3;
+  for(u32 frame = 0; frame < frameCount; frame++) {
+    {
+      PROFILE_SCOPE("A");
+      for(u32 i = 0; i < 2; i++) {
+        PROFILE_SCOPE("B");
+        volatile u32 busy = 0;
+        for(u32 j = 0; j < 1000; j++) { busy += j; }
+      }
+    }
+    if(frame == frameCount - 1) { // NOTE: same name as the other "A", different path
+      PROFILE_SCOPE("C");
+      PROFILE_SCOPE("A");
+    }
+    profilerEndFrame();
+  }
+
+  u32 root = profilerThreadBuffer()->rootNode;
+  Assert(root != PROFILER_NODE_NONE);
+  u32 a = findProfileNode(root, "A");
+  u32 b = findProfileNode(a, "B");
+  u32 c = findProfileNode(root, "C");
+  Assert(a != PROFILER_NODE_NONE && b != PROFILER_NODE_NONE && c != PROFILER_NODE_NONE);
+  Assert(findProfileNode(root, "B") == PROFILER_NODE_NONE);
+  Assert(findProfileNode(c, "A") != PROFILER_NODE_NONE && findProfileNode(c, "A") != a);
+  Assert(globalProfiler.nodes[a].lastFrameCallCount == 1 && globalProfiler.nodes[b].lastFrameCallCount == 2);
+  Assert(globalProfiler.nodes[a].historyCount == frameCount && globalProfiler.nodes[c].historyCount == 1);
+
+  ProfileStats aStats = profileNodeStats(globalProfiler.nodes[a]);
+  ProfileStats bStats = profileNodeStats(globalProfiler.nodes[b]);
+  Assert(bStats.minMs > 0.0f && bStats.minMs <= bStats.avgMs && bStats.avgMs <= bStats.p99Ms && bStats.p95Ms <= bStats.p99Ms);
+  Assert(aStats.minMs >= bStats.minMs); // NOTE: parents include their children
+#endif
+}
+
+void flythroughTest() {
+  FlythroughKeyframe keyframes[] = {
+          {0.0f, {0.0f, 0.0f, 1.0f}, 0.0f, 3.0f},
+          {1.0f, {4.0f, 0.0f, 1.0f}, 0.5f, -3.0f}, // NOTE: yaw turns the short way, through Pi
+          {3.0f, {4.0f, 8.0f, 2.0f}, 0.0f, -3.0f},
+  };
+  u32 keyframeCount = ArrayCount(keyframes);
+
+  // passes through every keyframe, clamps outside of the path
+  for(u32 i = 0; i < keyframeCount; i++) {
+    FlythroughPose pose = sampleFlythrough(keyframes, keyframeCount, keyframes[i].time);
+    Assert(pose.viewPosition == keyframes[i].viewPosition && epsilonComparison(pose.pitch, keyframes[i].pitch));
+  }
+  Assert(sampleFlythrough(keyframes, keyframeCount, -1.0f).viewPosition == keyframes[0].viewPosition);
+  Assert(sampleFlythrough(keyframes, keyframeCount, 10.0f).viewPosition == keyframes[2].viewPosition);
+  Assert(sampleFlythrough(keyframes, 1, 0.5f).viewPosition == keyframes[0].viewPosition);
+
+  FlythroughPose halfway = sampleFlythrough(keyframes, keyframeCount, 0.5f);
+  Assert(halfway.viewPosition.x > 0.0f && halfway.viewPosition.x < 4.0f);
+  Assert(epsilonComparison(halfway.pitch, 0.25f));
+  f32 turned = halfway.yaw - 3.0f;
+  Assert(turned > 0.0f && epsilonComparison(turned, (Tau32 - 6.0f) * 0.5f));
+
+  // continuous across keyframes
+  const f32 step = 0.001f;
+  vec3 beforeKeyframe = sampleFlythrough(keyframes, keyframeCount, 1.0f - step).viewPosition;
+  vec3 afterKeyframe = sampleFlythrough(keyframes, keyframeCount, 1.0f + step).viewPosition;
+  Assert(magnitude(afterKeyframe - beforeKeyframe) < 0.05f);
+}
+
+void benchmarkReportTest() {
+  std::vector<BenchmarkFrame> frames;
+  for(u32 i = 0; i < 100; i++) {
+    BenchmarkFrame frame{};
+    frame.frameIndex = i;
+    frame.cpuMs = (f32)(i + 1); // NOTE: 1 to 100 ms
+    frame.viewPosition = {(f32)i, 0.0f, 0.0f};
+    frame.sceneIndex = i % 2;
+    frames.push_back(frame);
+  }
+  std::vector<f32> gpuFrameMs{2.0f, 4.0f};
+
+  BenchmarkReport report = buildBenchmarkReport(frames, gpuFrameMs);
+  Assert(report.cpu.frameCount == 100);
+  Assert(epsilonComparison(report.cpu.meanMs, 50.5f));
+  Assert(report.cpu.p50Ms == 50.0f && report.cpu.p95Ms == 95.0f && report.cpu.p99Ms == 99.0f && report.cpu.maxMs == 100.0f);
+  Assert(report.gpu.frameCount == 2 && report.gpu.meanMs == 3.0f && report.gpu.maxMs == 4.0f);
+  Assert(report.worstFrameCount == BENCHMARK_WORST_FRAME_COUNT);
+  for(u32 i = 0; i < report.worstFrameCount; i++) {
+    Assert(report.worstFrames[i].cpuMs == (f32)(100 - i)); // NOTE: slowest first
+  }
+  Assert(report.worstFrames[9].frameIndex == 90 && report.worstFrames[9].viewPosition.x == 90.0f);
+
+  BenchmarkReport emptyReport = buildBenchmarkReport({}, {});
+  Assert(emptyReport.cpu.frameCount == 0 && emptyReport.worstFrameCount == 0);
+}
+
+// NOTE: Triangle grid over the xy-plane of (cellCount + 1)^2 vertices, two CCW triangles per cell
+void gridMesh(u32 cellCount, std::vector<vec3>* positions, std::vector<u32>* indices) {
+  u32 rowVertexCount = cellCount + 1;
+  positions->clear();
+  indices->clear();
+  for(u32 y = 0; y < rowVertexCount; y++) {
+    for(u32 x = 0; x < rowVertexCount; x++) { positions->push_back(vec3{(f32)x, (f32)y, 0.0f}); }
+  }
+  for(u32 y = 0; y < cellCount; y++) {
+    for(u32 x = 0; x < cellCount; x++) {
+      u32 corner = (y * rowVertexCount) + x;
+      u32 cellIndices[] = {corner, corner + 1, corner + rowVertexCount + 1, corner, corner + rowVertexCount + 1, corner + rowVertexCount};
+      indices->insert(indices->end(), cellIndices, cellIndices + ArrayCount(cellIndices));
+    }
+  }
+}
+
+void shuffleTriangles(std::vector<u32>* indices, u32 seed) {
+  u32 triangleCount = (u32)indices->size() / 3;
+  u32 randomState = seed;
+  for(u32 triangle = triangleCount - 1; triangle > 0; triangle--) {
+    randomState ^= randomState << 13; randomState ^= randomState >> 17; randomState ^= randomState << 5; // xorshift32
+    u32 other = randomState % (triangle + 1);
+    for(u32 j = 0; j < 3; j++) { std::swap((*indices)[(triangle * 3) + j], (*indices)[(other * 3) + j]); }
+  }
+}
+
+// NOTE: Triangles keyed by their vertices with winding kept, for comparing triangle sets in any order. Vertices < 2^21
+std::vector<u64> sortedTriangleKeys(const u32* indices, u32 indexCount, const u32* vertexIds = nullptr) {
+  std::vector<u64> keys;
+  for(u32 i = 0; i < indexCount; i += 3) {
+    u64 v[3];
+    for(u32 j = 0; j < 3; j++) { v[j] = vertexIds != nullptr ? vertexIds[indices[i + j]] : indices[i + j]; }
+    u32 first = v[0] < v[1] ? (v[0] < v[2] ? 0 : 2) : (v[1] < v[2] ? 1 : 2);
+    keys.push_back((v[first] << 42) | (v[(first + 1) % 3] << 21) | v[(first + 2) % 3]);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+void meshOptimizationTest() {
+  std::vector<vec3> positions;
+  std::vector<u32> indices;
+  gridMesh(100, &positions, &indices);
+  shuffleTriangles(&indices, 0x9E3779B9);
+  u32 vertexCount = (u32)positions.size();
+  u32 indexCount = (u32)indices.size();
+  std::vector<u64> originalTriangles = sortedTriangleKeys(indices.data(), indexCount);
+
+  f32 shuffledAcmr = acmr(analyzeVertexCache(indices.data(), indexCount, vertexCount));
+  Assert(shuffledAcmr > 2.5f); // NOTE: 3.0 is the worst possible
+
+  optimizeVertexCache(indices.data(), indexCount, vertexCount);
+  f32 optimizedAcmr = acmr(analyzeVertexCache(indices.data(), indexCount, vertexCount));
+  Assert(optimizedAcmr < shuffledAcmr && optimizedAcmr < 1.0f);
+  Assert(sortedTriangleKeys(indices.data(), indexCount) == originalTriangles);
+
+  optimizeOverdraw(indices.data(), indexCount, positions.data(), vertexCount);
+  Assert(acmr(analyzeVertexCache(indices.data(), indexCount, vertexCount)) < 1.0f);
+  Assert(sortedTriangleKeys(indices.data(), indexCount) == originalTriangles);
+
+  // NOTE: vertices are their original index, to follow them through reordering
+  std::vector<u32> vertexIds(vertexCount);
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) { vertexIds[vertex] = vertex; }
+  std::vector<u32> indicesBeforeFetch = indices;
+  vertexIds.push_back(U32_MAX); // unreferenced vertex
+  u32 fetchVertexCount = optimizeVertexFetch(indices.data(), indexCount, vertexIds.data(), vertexCount + 1, sizeof(u32));
+  Assert(fetchVertexCount == vertexCount);
+  Assert(sortedTriangleKeys(indices.data(), indexCount, vertexIds.data()) == originalTriangles);
+  for(u32 i = 0; i < indexCount; i++) { Assert(vertexIds[indices[i]] == indicesBeforeFetch[i]); }
+  u32 nextNewVertex = 0;
+  for(u32 i = 0; i < indexCount; i++) { // NOTE: vertices in order of first use
+    Assert(indices[i] <= nextNewVertex);
+    if(indices[i] == nextNewVertex) { nextNewVertex++; }
+  }
+}
+
+// NOTE: Closed unit sphere, rings of segmentCount vertices between single vertex poles, no duplicate positions
+void sphereMesh(u32 ringCount, u32 segmentCount, std::vector<vec3>* positions, std::vector<u32>* indices) {
+  positions->clear();
+  indices->clear();
+  positions->push_back(vec3{0.0f, 0.0f, 1.0f});
+  for(u32 ring = 1; ring < ringCount; ring++) {
+    f32 theta = Pi32 * ring / ringCount;
+    for(u32 segment = 0; segment < segmentCount; segment++) {
+      f32 phi = Tau32 * segment / segmentCount;
+      positions->push_back(vec3{sinf(theta) * cosf(phi), sinf(theta) * sinf(phi), cosf(theta)});
+    }
+  }
+  positions->push_back(vec3{0.0f, 0.0f, -1.0f});
+  u32 southPole = (u32)positions->size() - 1;
+  auto ringVertex = [segmentCount](u32 ring, u32 segment) { return 1 + ((ring - 1) * segmentCount) + (segment % segmentCount); };
+  for(u32 segment = 0; segment < segmentCount; segment++) {
+    u32 northFan[] = {0, ringVertex(1, segment), ringVertex(1, segment + 1)};
+    indices->insert(indices->end(), northFan, northFan + 3);
+    for(u32 ring = 1; ring < ringCount - 1; ring++) {
+      u32 a = ringVertex(ring, segment), b = ringVertex(ring, segment + 1);
+      u32 c = ringVertex(ring + 1, segment), d = ringVertex(ring + 1, segment + 1);
+      u32 quad[] = {a, c, d, a, d, b};
+      indices->insert(indices->end(), quad, quad + 6);
+    }
+    u32 southFan[] = {southPole, ringVertex(ringCount - 1, segment + 1), ringVertex(ringCount - 1, segment)};
+    indices->insert(indices->end(), southFan, southFan + 3);
+  }
+}
+
+b32 referencesVertex(const u32* indices, u32 indexCount, u32 vertex) {
+  for(u32 i = 0; i < indexCount; i++) {
+    if(indices[i] == vertex) { return true; }
+  }
+  return false;
+}
+
+void meshSimplificationTest() {
+  std::vector<vec3> positions;
+  std::vector<u32> indices;
+
+  // closed meshes reach their target
+  sphereMesh(16, 32, &positions, &indices);
+  u32 indexCount = (u32)indices.size();
+  u32 targetIndexCount = ((indexCount / 3) / 2) * 3;
+  f32 error;
+  u32 simplifiedIndexCount = simplifyMesh(indices.data(), indexCount, positions.data(), (u32)positions.size(), targetIndexCount, 1.0f, &error);
+  Assert(simplifiedIndexCount <= targetIndexCount && simplifiedIndexCount >= (targetIndexCount * 9) / 10);
+  Assert(error > 0.0f && error < 1.0f);
+  for(u32 i = 0; i < simplifiedIndexCount; i += 3) { // no degenerate triangles remain
+    Assert(indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i + 2] != indices[i]);
+  }
+
+  // no collapse is allowed over the target error
+  sphereMesh(16, 32, &positions, &indices);
+  Assert(simplifyMesh(indices.data(), indexCount, positions.data(), (u32)positions.size(), 0, 0.0001f) == indexCount);
+
+  // open grid with a texture seam down the middle, the seam's vertices are duplicated for the right half's triangles
+  const u32 cellCount = 10;
+  const u32 seamX = cellCount / 2;
+  gridMesh(cellCount, &positions, &indices);
+  u32 gridVertexCount = (u32)positions.size();
+  std::vector<u32> seamDuplicates(gridVertexCount, U32_MAX);
+  indexCount = (u32)indices.size();
+  for(u32 i = 0; i < indexCount; i += 3) {
+    b32 rightOfSeam = positions[indices[i]].x + positions[indices[i + 1]].x + positions[indices[i + 2]].x > 3.0f * seamX;
+    for(u32 j = 0; j < 3 && rightOfSeam; j++) {
+      u32 vertex = indices[i + j];
+      if(positions[vertex].x != (f32)seamX) { continue; }
+      if(seamDuplicates[vertex] == U32_MAX) {
+        seamDuplicates[vertex] = (u32)positions.size();
+        positions.push_back(positions[vertex]);
+      }
+      indices[i + j] = seamDuplicates[vertex];
+    }
+  }
+  u32 vertexCount = (u32)positions.size();
+  Assert(vertexCount == gridVertexCount + cellCount + 1);
+
+  simplifiedIndexCount = simplifyMesh(indices.data(), indexCount, positions.data(), vertexCount, 0, 0.001f, &error);
+  Assert(simplifiedIndexCount < indexCount / 2);
+  Assert(error < 0.001f); // NOTE: flat, every collapse is free
+  for(u32 vertex = 0; vertex < vertexCount; vertex++) {
+    const vec3& p = positions[vertex];
+    b32 border = p.x == 0.0f || p.y == 0.0f || p.x == (f32)cellCount || p.y == (f32)cellCount;
+    b32 seam = p.x == (f32)seamX;
+    if(border || seam) { Assert(referencesVertex(indices.data(), simplifiedIndexCount, vertex)); }
+  }
+
+  // coarser levels as the mesh gets smaller on screen
+  const f32 lodErrors[] = {0.0f, 0.01f, 0.05f, 0.2f};
+  const f32 maxPixelError = 1.0f;
+  Assert(selectLod(lodErrors, ArrayCount(lodErrors), F32_MAX, maxPixelError) == 0);
+  Assert(selectLod(lodErrors, ArrayCount(lodErrors), 1000.0f, maxPixelError) == 0);
+  Assert(selectLod(lodErrors, ArrayCount(lodErrors), 100.0f, maxPixelError) == 1);
+  Assert(selectLod(lodErrors, ArrayCount(lodErrors), 20.0f, maxPixelError) == 2);
+  Assert(selectLod(lodErrors, ArrayCount(lodErrors), 5.0f, maxPixelError) == 3);
+  Assert(selectLod(lodErrors, 2, 5.0f, maxPixelError) == 1); // NOTE: never past the last level
+  u32 previousLod = 0;
+  for(f32 pixelsPerUnit = 2000.0f; pixelsPerUnit > 1.0f; pixelsPerUnit *= 0.9f) {
+    u32 lod = selectLod(lodErrors, ArrayCount(lodErrors), pixelsPerUnit, maxPixelError);
+    Assert(lod >= previousLod);
+    previousLod = lod;
+  }
+}
+
+void generateIndicesTest() {
+  struct TestVertex {
+    vec3 position;
+    u32 id; // NOTE: differs between vertices sharing a position, as attributes do at seams
+  };
+  const TestVertex vertexStream[] = {
+          {{0.0f, 0.0f, 0.0f}, 0}, {{1.0f, 0.0f, 0.0f}, 0}, {{1.0f, 1.0f, 0.0f}, 0},
+          {{0.0f, 0.0f, 0.0f}, 0}, {{1.0f, 1.0f, 0.0f}, 0}, {{0.0f, 1.0f, 0.0f}, 0}, // NOTE: repeats two of the first
+          {{1.0f, 1.0f, 0.0f}, 1}, {{0.0f, 1.0f, 0.0f}, 0}, {{1.0f, 0.0f, 0.0f}, 0},
+  };
+  const u32 vertexCount = ArrayCount(vertexStream);
+  TestVertex vertices[vertexCount];
+  memcpy(vertices, vertexStream, sizeof(vertexStream));
+  u32 indices[vertexCount];
+
+  u32 uniqueVertexCount = generateIndices(vertices, vertexCount, sizeof(TestVertex), indices);
+  Assert(uniqueVertexCount == 5);
+  const u32 expectedIndices[vertexCount] = {0, 1, 2, 0, 2, 3, 4, 3, 1}; // NOTE: unique vertices in order of first occurrence
+  for(u32 i = 0; i < vertexCount; i++) {
+    Assert(indices[i] == expectedIndices[i]);
+    Assert(memcmp(&vertices[indices[i]], &vertexStream[i], sizeof(TestVertex)) == 0); // reproduces the stream
+  }
+  for(u32 a = 0; a < uniqueVertexCount; a++) {
+    for(u32 b = a + 1; b < uniqueVertexCount; b++) { Assert(memcmp(&vertices[a], &vertices[b], sizeof(TestVertex)) != 0); }
+  }
+}
+
 void runAllMathTests()
 {
   translateTest();
@@ -381,6 +968,24 @@ void runAllMathTests()
   bracketAssignmentOperatorsSanityCheck();
   quaternionOrientTest();
   inversePerspectiveTests();
+  mat3InverseTest();
+  normalMatTest();
+  octahedralEncodingTest();
+  halfFloatTest();
+  transformBoundingBoxTest();
+  rayBoxIntersectionTest();
+  frustumPlanesTest();
+  sweepBoxesTest();
+  moveAndSlideTest();
+  portalCrossingTest();
+  stopWatchTest();
+  fixedTimestepTest();
+  profilerTest();
+  flythroughTest();
+  benchmarkReportTest();
+  meshOptimizationTest();
+  meshSimplificationTest();
+  generateIndicesTest();
 }
 
 void runMathTests() {
@@ -1,7 +1,9 @@
 #include "math_tests.h"
+#include "bvh_benchmark.h"
 
 int main()
 {
   runMathTests();
+  runBVHBenchmark();
   return 0;
 }
\ No newline at end of file
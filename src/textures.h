@@ -15,6 +15,11 @@ enum FramebufferCreationFlags {
   FramebufferCreate_color_sRGB = 1 << 1,
 };
 
+struct TextureBuffer {
+  GLuint bufferId;
+  GLuint textureId;
+};
+
 internal_func inline void bindActiveTexture(s32 activeIndex, GLuint textureId, GLenum target) {
   glActiveTexture(GL_TEXTURE0 + activeIndex);
   glBindTexture(target, textureId);
@@ -28,8 +33,26 @@ void inline bindActiveTextureCubeMap(s32 activeIndex, GLuint textureId) {
   bindActiveTexture(activeIndex, textureId, GL_TEXTURE_CUBE_MAP);
 }
 
+void initTextureBuffer(TextureBuffer* textureBuffer, GLenum internalFormat, GLsizeiptr capacityInBytes) {
+  glGenBuffers(1, &textureBuffer->bufferId);
+  glBindBuffer(GL_TEXTURE_BUFFER, textureBuffer->bufferId);
+  glBufferData(GL_TEXTURE_BUFFER, capacityInBytes, NULL, GL_STREAM_DRAW);
+  glGenTextures(1, &textureBuffer->textureId);
+  glBindTexture(GL_TEXTURE_BUFFER, textureBuffer->textureId);
+  glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, textureBuffer->bufferId);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+  glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void deleteTextureBuffer(TextureBuffer* textureBuffer) {
+  glDeleteTextures(1, &textureBuffer->textureId);
+  glDeleteBuffers(1, &textureBuffer->bufferId);
+  *textureBuffer = {};
+}
+
 void load2DTexture(const char* imgLocation, u32* textureId, bool flipImageVert = false, bool inputSRGB = false, u32* width = NULL, u32* height = NULL)
 {
+  PROFILE_SCOPE("load2DTexture");
   glGenTextures(1, textureId);
   glBindTexture(GL_TEXTURE_2D, *textureId);
 
@@ -88,6 +111,7 @@ void load2DTexture(const char* imgLocation, u32* textureId, bool flipImageVert =
 }
 
 void loadCubeMapTexture(const char* directory, const char* extension, GLuint* textureId, bool flipImageVert = false) {
+  PROFILE_SCOPE("loadCubeMapTexture");
 
   const char* skyboxTextureTitles[] = {
           "front.",
@@ -162,6 +186,7 @@ void loadCubeMapTexture(const char* directory, const char* extension, GLuint* te
 
 void loadCubeMapTexture(const char* const imgLocations[6], GLuint* textureId, bool flipImageVert = false)
 {
+  PROFILE_SCOPE("loadCubeMapTexture");
   glGenTextures(1, textureId);
   glBindTexture(GL_TEXTURE_CUBE_MAP, *textureId);
   glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+
+/*
+ * Wall clock timing on the monotonic steady clock
+ * - Time points are 64 bit integer ticks, durations are only converted to seconds once taken, in double precision.
+ * - StopWatch deltas are measured between frames, smoothedDelta averages them for display.
+ */
+
+#define STOPWATCH_DELTA_SMOOTHING 0.05f // NOTE: weight of the newest delta in the moving average
+
+u64 getTicks() {
+  return (u64)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+f64 ticksToSeconds(u64 ticks) {
+  return (f64)ticks * ((f64)std::chrono::steady_clock::period::num / (f64)std::chrono::steady_clock::period::den);
+}
+
+f64 secondsSince(u64 startTicks) {
+  return ticksToSeconds(getTicks() - startTicks);
+}
+
+// stopwatch
+struct StopWatch {
+  u64 startTicks;
+  u64 lastFrameTicks;
+  f64 totalElapsed; // NOTE: seconds since the stopwatch was created
+  f32 delta; // NOTE: seconds since the previous update
+  f32 smoothedDelta;
+};
+
+StopWatch createStopWatch() {
+  StopWatch stopWatch;
+  stopWatch.startTicks = getTicks();
+  stopWatch.lastFrameTicks = stopWatch.startTicks;
+  stopWatch.totalElapsed = 0.0;
+  stopWatch.delta = 0.0f;
+  stopWatch.smoothedDelta = 0.0f;
+  return stopWatch;
+}
+
+void updateStopWatch(StopWatch* stopWatch) {
+  u64 ticks = getTicks();
+  stopWatch->delta = (f32)ticksToSeconds(ticks - stopWatch->lastFrameTicks);
+  stopWatch->lastFrameTicks = ticks;
+  // NOTE: elapsed time is measured from the start rather than summed from deltas, so it doesn't drift
+  stopWatch->totalElapsed = ticksToSeconds(ticks - stopWatch->startTicks);
+  stopWatch->smoothedDelta = stopWatch->smoothedDelta == 0.0f ? stopWatch->delta :
+                             stopWatch->smoothedDelta + (STOPWATCH_DELTA_SMOOTHING * (stopWatch->delta - stopWatch->smoothedDelta));
+}
+
+// fixed timestep
+#define FIXED_TIMESTEP_MAX_STEPS_PER_UPDATE 8 // NOTE: time past this many steps is dropped, so slow frames can't snowball
+
+/*
+ * Accumulates elapsed time and hands it out in whole steps of a fixed size
+ * The remainder is less than a step, alpha is the fraction of a step it makes up and is what rendering interpolates by.
+ */
+struct FixedTimestep {
+  f32 timestep; // NOTE: seconds per step
+  f64 accumulator; // NOTE: seconds elapsed but not yet stepped
+  u64 stepCount; // NOTE: steps taken since creation
+};
+
+FixedTimestep createFixedTimestep(f32 timestep) {
+  Assert(timestep > 0.0f);
+  FixedTimestep fixedTimestep;
+  fixedTimestep.timestep = timestep;
+  fixedTimestep.accumulator = 0.0;
+  fixedTimestep.stepCount = 0;
+  return fixedTimestep;
+}
+
+// NOTE: returns the number of steps to take for delta seconds having passed
+u32 updateFixedTimestep(FixedTimestep* fixedTimestep, f32 delta) {
+  fixedTimestep->accumulator += delta;
+  u32 stepCount = 0;
+  while(fixedTimestep->accumulator >= fixedTimestep->timestep) {
+    if(stepCount == FIXED_TIMESTEP_MAX_STEPS_PER_UPDATE) {
+      fixedTimestep->accumulator = fmod(fixedTimestep->accumulator, (f64)fixedTimestep->timestep);
+      break;
+    }
+    fixedTimestep->accumulator -= fixedTimestep->timestep;
+    stepCount++;
+  }
+  fixedTimestep->stepCount += stepCount;
+  return stepCount;
+}
+
+// NOTE: [0, 1), how far past the latest step the elapsed time is
+f32 fixedTimestepAlpha(const FixedTimestep& fixedTimestep) {
+  return Min((f32)(fixedTimestep.accumulator / fixedTimestep.timestep), 1.0f);
+}
+
+// NOTE: Adds the seconds between its construction and destruction to *seconds
+struct ScopedTimer {
+  f64* seconds;
+  u64 startTicks;
+
+  ScopedTimer(f64* seconds): seconds(seconds), startTicks(getTicks()) {}
+  ~ScopedTimer() { *seconds += secondsSince(startTicks); }
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <time.h>
+
+/*
+ * Trace capture in the Chrome Trace Event Format, viewable in chrome://tracing or ui.perfetto.dev
+ * - Records a number of frames of profiler scopes (one track per thread), GPU passes (their own track) and per frame
+ *   counters (frame times, GL call counts), then writes them out as JSON.
+ * - GPU timestamps are mapped onto the CPU timeline by reading GL_TIMESTAMP when the capture begins. GPU results lag
+ *   by GPU_TIMER_FRAMES_IN_FLIGHT frames, so the capture keeps collecting them that many frames after the last one.
+ * - Asset loads show up through the profiler scopes around world, model and texture loading.
+ */
+
+#define TRACE_NAME_SIZE 48
+#define TRACE_PROCESS_ID 1
+#define TRACE_GPU_THREAD_ID 1000
+#define TRACE_DEFAULT_FRAME_COUNT 300
+
+struct TraceEvent {
+  char name[TRACE_NAME_SIZE];
+  const char* category;
+  char phase; // NOTE: 'X' complete event, 'C' counter
+  f64 timestampUs;
+  f64 durationOrValue; // NOTE: microseconds for complete events, the counter's value for counters
+  u32 threadId;
+};
+
+struct TraceCapture {
+  b32 active;
+  u32 framesRemaining;
+  u32 gpuFramesRemaining; // NOTE: frames left to collect GPU results once the CPU frames are done
+  u32 capturedFrameCount;
+  u64 startTicks;
+  u64 startCycles; // NOTE: profiler cycles
+  GLint64 startGpuNs;
+  u32 gpuResultFrameCount; // NOTE: GpuTimers::resultFrameCount when last collected
+  std::vector<TraceEvent> events;
+};
+
+internal_func void addTraceEvent(TraceCapture* capture, const char* name, const char* category, char phase,
+                                 f64 timestampUs, f64 durationOrValue, u32 threadId) {
+  TraceEvent event;
+  snprintf(event.name, TRACE_NAME_SIZE, "%s", name);
+  event.category = category;
+  event.phase = phase;
+  event.timestampUs = timestampUs;
+  event.durationOrValue = durationOrValue;
+  event.threadId = threadId;
+  capture->events.push_back(event);
+}
+
+// NOTE: reads GL_TIMESTAMP, the GL context must be current on the calling thread
+void beginTraceCapture(TraceCapture* capture, const GpuTimers& gpuTimers, u32 frameCount) {
+  capture->active = true;
+  capture->framesRemaining = frameCount;
+  capture->gpuFramesRemaining = GPU_TIMER_FRAMES_IN_FLIGHT + 1;
+  capture->capturedFrameCount = 0;
+  capture->events.clear();
+  capture->gpuResultFrameCount = gpuTimers.resultFrameCount;
+  capture->startTicks = getTicks();
+#if PROFILER_ON
+  capture->startCycles = profilerCycles();
+#endif
+  glGetInteger64v(GL_TIMESTAMP, &capture->startGpuNs);
+}
+
+/*
+ * Collects the frame that just ended, call after profilerEndFrame() with the render thread's latest stats
+ * returns true on the frame the capture completes
+ */
+b32 updateTraceCapture(TraceCapture* capture, const RenderFrameStats& renderStats, f32 cpuFrameMs) {
+  if(!capture->active) { return false; }
+  const GpuTimers& gpuTimers = renderStats.gpuTimers;
+
+  if(capture->framesRemaining > 0) {
+    f64 frameEndUs = secondsSince(capture->startTicks) * 1000000.0;
+#if PROFILER_ON
+    const f64 microsecondsPerCycle = globalProfiler.secondsPerCycle * 1000000.0;
+    for(const ProfileEvent& event : globalProfiler.frameEvents) {
+      if(event.startCycles < capture->startCycles) { continue; } // NOTE: began before the capture
+      addTraceEvent(capture, event.name, "cpu", 'X', (event.startCycles - capture->startCycles) * microsecondsPerCycle,
+                    (event.endCycles - event.startCycles) * microsecondsPerCycle, event.threadIndex);
+    }
+#endif
+    addTraceEvent(capture, "CPU frame ms", "frame", 'C', frameEndUs, cpuFrameMs, 0);
+#if GL_DEBUG_LAYER_ON
+    addTraceEvent(capture, "GL calls", "frame", 'C', frameEndUs, renderStats.glCalls.callCount, 0);
+    addTraceEvent(capture, "GL redundant calls", "frame", 'C', frameEndUs, renderStats.glCalls.redundantCount, 0);
+#endif
+    capture->framesRemaining--;
+    capture->capturedFrameCount++;
+  } else {
+    capture->gpuFramesRemaining--;
+  }
+
+  if(gpuTimers.resultFrameCount != capture->gpuResultFrameCount) {
+    capture->gpuResultFrameCount = gpuTimers.resultFrameCount;
+    b32 frameStartedInCapture = gpuTimers.resultPassCount > 0 && (GLint64)gpuTimers.resultBeginNs[0] >= capture->startGpuNs;
+    for(u32 passIndex = 0; frameStartedInCapture && passIndex < gpuTimers.resultPassCount; passIndex++) {
+      f64 beginUs = (f64)((GLint64)gpuTimers.resultBeginNs[passIndex] - capture->startGpuNs) / 1000.0;
+      f64 durationUs = (f64)(gpuTimers.resultEndNs[passIndex] - gpuTimers.resultBeginNs[passIndex]) / 1000.0;
+      addTraceEvent(capture, gpuTimers.resultPasses[passIndex].name, "gpu", 'X', beginUs, durationUs, TRACE_GPU_THREAD_ID);
+    }
+    if(frameStartedInCapture) {
+      f64 frameEndUs = (f64)((GLint64)gpuTimers.resultEndNs[0] - capture->startGpuNs) / 1000.0;
+      addTraceEvent(capture, "GPU frame ms", "frame", 'C', frameEndUs, gpuTimers.resultMs[0], TRACE_GPU_THREAD_ID);
+    }
+  }
+
+  if(capture->framesRemaining == 0 && capture->gpuFramesRemaining == 0) {
+    capture->active = false;
+    return true;
+  }
+  return false;
+}
+
+internal_func void writeTraceJsonString(FILE* file, const char* cStr) {
+  fputc('"', file);
+  for(const char* c = cStr; *c != '\0'; c++) {
+    if(*c == '"' || *c == '\\') { fputc('\\', file); }
+    if((u8)*c >= 0x20) { fputc(*c, file); }
+  }
+  fputc('"', file);
+}
+
+b32 writeTraceCapture(const TraceCapture& capture, const char* fileName) {
+  FILE* file = fopen(fileName, "w");
+  if(file == nullptr) { return false; }
+
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  // thread names
+#if PROFILER_ON
+  u32 threadCount = Min(globalProfiler.threadCount.load(), (u32)PROFILER_MAX_THREADS);
+  for(u32 threadIndex = 0; threadIndex < threadCount; threadIndex++) {
+    ProfilerThreadBuffer* buffer = globalProfiler.threads[threadIndex].load();
+    if(buffer == nullptr) { continue; }
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", TRACE_PROCESS_ID, threadIndex);
+    writeTraceJsonString(file, buffer->threadName);
+    fprintf(file, "}},\n");
+  }
+#endif
+  fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", TRACE_PROCESS_ID, TRACE_GPU_THREAD_ID);
+
+  for(const TraceEvent& event : capture.events) {
+    fprintf(file, ",\n{\"name\":");
+    writeTraceJsonString(file, event.name);
+    fprintf(file, ",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,", event.category, event.phase,
+            TRACE_PROCESS_ID, event.threadId, event.timestampUs);
+    if(event.phase == 'C') {
+      fprintf(file, "\"args\":{\"value\":%.3f}}", event.durationOrValue);
+    } else {
+      fprintf(file, "\"dur\":%.3f}", event.durationOrValue);
+    }
+  }
+  fprintf(file, "\n]}\n");
+  fclose(file);
+  return true;
+}
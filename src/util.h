@@ -1,34 +1,5 @@
 #pragma once
 
-#include <time.h>
-
-f32 getTime() {
-  clock_t time = clock();
-  return (f32)time / CLOCKS_PER_SEC;
-}
-
-// stopwatch
-struct StopWatch {
-  f32 totalElapsed;
-  f32 lastFrame;
-  f32 delta;
-};
-
-StopWatch createStopWatch() {
-  StopWatch stopWatch;
-  stopWatch.totalElapsed = 0.0f;
-  stopWatch.lastFrame = getTime();
-  stopWatch.delta = 0.0f;
-  return stopWatch;
-}
-
-void updateStopWatch(StopWatch* stopWatch) {
-  f32 t = getTime();
-  stopWatch->delta = t - stopWatch->lastFrame;
-  stopWatch->lastFrame = t;
-  stopWatch->totalElapsed += stopWatch->delta;
-}
-
 // 32 bit boolean flags
 void clearFlags(b32* flags) {
   *flags = 0;
@@ -1,4 +1,4 @@
-// TODO: When, if ever, does this vertex attribute data get deleted?
+// NOTE: Built-in shapes are added to the vertex buffers once and freed along with them in deleteVertexBuffers()
 global_variable union {
   struct {
     VertexAtt cubePos;
@@ -168,194 +168,221 @@ u32 convertSizeInBytesToOpenGLUIntType(u8 sizeInBytes) {
   return 0;
 }
 
+struct VertexAttributeDesc {
+  u32 location;
+  u32 componentCount;
+  GLenum type;
+  GLboolean normalized;
+  u32 offsetInBytes;
+};
+
+struct VertexFormatDesc {
+  u32 strideInBytes;
+  u32 attributeCount;
+  VertexAttributeDesc attributes[3];
+};
+
+const VertexFormatDesc vertexFormatDescs[VertexFormat_Count] = {
+        { // VertexFormat_Pos
+                3 * sizeof(f32), 1, {{0, 3, GL_FLOAT, GL_FALSE, 0}}
+        },
+        { // VertexFormat_PosTex
+                5 * sizeof(f32), 2, {{0, 3, GL_FLOAT, GL_FALSE, 0},
+                                     {1, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(f32)}}
+        },
+        { // VertexFormat_PosNormTex
+                sizeof(PosNormTexVertex), 3, {{0, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PosNormTexVertex, position)},
+                                              {1, 2, GL_SHORT, GL_TRUE, offsetof(PosNormTexVertex, normal)},
+                                              {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PosNormTexVertex, texCoord)}}
+        },
+};
+
+const u32 initialVertexBufferVertexCapacity = 1 << 16;
+const u32 initialVertexBufferIndexCapacityInBytes = 1 << 18;
+
+global_variable VertexBuffer globalVertexBuffers[VertexFormat_Count];
+global_variable GLuint boundVertexArrayObject = 0;
+
+internal_func void bindVertexArrayObject(GLuint arrayObject) {
+  if(boundVertexArrayObject != arrayObject) {
+    glBindVertexArray(arrayObject);
+    boundVertexArrayObject = arrayObject;
+  }
+}
+
+// NOTE: (Re)points the VAO at the current vertex and index buffer objects
+internal_func void specifyVertexBufferAttributes(VertexFormat format) {
+  VertexBuffer* vertexBuffer = globalVertexBuffers + format;
+  const VertexFormatDesc& formatDesc = vertexFormatDescs[format];
+
+  bindVertexArrayObject(vertexBuffer->arrayObject);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer->vertexBufferObject);
+  for(u32 attributeIndex = 0; attributeIndex < formatDesc.attributeCount; attributeIndex++) {
+    const VertexAttributeDesc& attributeDesc = formatDesc.attributes[attributeIndex];
+    glVertexAttribPointer(attributeDesc.location,
+                          attributeDesc.componentCount, // attribute size
+                          attributeDesc.type, // type of data
+                          attributeDesc.normalized, // should data be normalized
+                          formatDesc.strideInBytes, // stride
+                          (void*)(u64)attributeDesc.offsetInBytes); // offset of first component
+    glEnableVertexAttribArray(attributeDesc.location);
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vertexBuffer->indexBufferObject);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  bindVertexArrayObject(0);
+  // Must unbind EBO AFTER unbinding VAO, since VAO stores all glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _) calls
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+internal_func void initVertexBuffer(VertexFormat format) {
+  VertexBuffer* vertexBuffer = globalVertexBuffers + format;
+  const VertexFormatDesc& formatDesc = vertexFormatDescs[format];
+
+  vertexBuffer->vertexCapacity = initialVertexBufferVertexCapacity;
+  vertexBuffer->indexCapacityInBytes = initialVertexBufferIndexCapacityInBytes;
+
+  glGenVertexArrays(1, &vertexBuffer->arrayObject);
+  glGenBuffers(1, &vertexBuffer->vertexBufferObject);
+  glGenBuffers(1, &vertexBuffer->indexBufferObject);
+  // NOTE: uploads use the copy write target to avoid disturbing any bound VAO's element array binding
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->vertexBufferObject);
+  glBufferData(GL_COPY_WRITE_BUFFER, vertexBuffer->vertexCapacity * formatDesc.strideInBytes, NULL, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->indexBufferObject);
+  glBufferData(GL_COPY_WRITE_BUFFER, vertexBuffer->indexCapacityInBytes, NULL, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  specifyVertexBufferAttributes(format);
+}
+
+// NOTE: Returns a new buffer object containing the first usedSizeInBytes of the old one, the old one is deleted
+internal_func GLuint resizeBufferObject(GLuint bufferObject, u32 usedSizeInBytes, u32 newCapacityInBytes) {
+  GLuint newBufferObject;
+  glGenBuffers(1, &newBufferObject);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, newBufferObject);
+  glBufferData(GL_COPY_WRITE_BUFFER, newCapacityInBytes, NULL, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_READ_BUFFER, bufferObject);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSizeInBytes);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glDeleteBuffers(1, &bufferObject);
+  return newBufferObject;
+}
+
+internal_func VertexBuffer* reserveVertexBuffer(VertexFormat format, u32 additionalVertexCount, u32 additionalIndexSizeInBytes) {
+  VertexBuffer* vertexBuffer = globalVertexBuffers + format;
+  const VertexFormatDesc& formatDesc = vertexFormatDescs[format];
+  if(vertexBuffer->arrayObject == 0) {
+    initVertexBuffer(format);
+  }
+
+  b32 buffersResized = false;
+  u32 requiredVertexCapacity = vertexBuffer->vertexCount + additionalVertexCount;
+  if(requiredVertexCapacity > vertexBuffer->vertexCapacity) {
+    u32 newVertexCapacity = vertexBuffer->vertexCapacity * 2;
+    while(newVertexCapacity < requiredVertexCapacity) { newVertexCapacity *= 2; }
+    vertexBuffer->vertexBufferObject = resizeBufferObject(vertexBuffer->vertexBufferObject,
+                                                          vertexBuffer->vertexCount * formatDesc.strideInBytes,
+                                                          newVertexCapacity * formatDesc.strideInBytes);
+    vertexBuffer->vertexCapacity = newVertexCapacity;
+    buffersResized = true;
+  }
+
+  u32 requiredIndexCapacityInBytes = vertexBuffer->indexSizeInBytes + additionalIndexSizeInBytes;
+  if(requiredIndexCapacityInBytes > vertexBuffer->indexCapacityInBytes) {
+    u32 newIndexCapacityInBytes = vertexBuffer->indexCapacityInBytes * 2;
+    while(newIndexCapacityInBytes < requiredIndexCapacityInBytes) { newIndexCapacityInBytes *= 2; }
+    vertexBuffer->indexBufferObject = resizeBufferObject(vertexBuffer->indexBufferObject, vertexBuffer->indexSizeInBytes, newIndexCapacityInBytes);
+    vertexBuffer->indexCapacityInBytes = newIndexCapacityInBytes;
+    buffersResized = true;
+  }
+
+  if(buffersResized) {
+    specifyVertexBufferAttributes(format);
+  }
+
+  return vertexBuffer;
+}
+
+/*
+ * vertices must be laid out as described in vertexFormatDescs
+ * returns the base vertex of the newly added vertices
+ */
+s32 addVertices(VertexFormat format, const void* vertices, u32 vertexCount) {
+  VertexBuffer* vertexBuffer = reserveVertexBuffer(format, vertexCount, 0);
+  u32 strideInBytes = vertexFormatDescs[format].strideInBytes;
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->vertexBufferObject);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, vertexBuffer->vertexCount * strideInBytes, vertexCount * strideInBytes, vertices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  s32 baseVertex = (s32)vertexBuffer->vertexCount;
+  vertexBuffer->vertexCount += vertexCount;
+  return baseVertex;
+}
+
+/*
+ * Indices are relative to the base vertex returned from addVertices
+ * NOTE: 8-bit indices are widened to 16-bit, as many GPUs do not natively support them
+ * returns the first index of the newly added indices, in units of resultIndexTypeSizeInBytes
+ */
+u32 addIndices(VertexFormat format, const void* indices, u32 indexCount, u32 indexTypeSizeInBytes, Out u32* resultIndexTypeSizeInBytes) {
+  std::vector<u16> widenedIndices;
+  if(indexTypeSizeInBytes == sizeof(u8)) {
+    const u8* narrowIndices = (const u8*)indices;
+    widenedIndices.assign(narrowIndices, narrowIndices + indexCount);
+    indices = widenedIndices.data();
+    indexTypeSizeInBytes = sizeof(u16);
+  }
+  Assert(indexTypeSizeInBytes == sizeof(u16) || indexTypeSizeInBytes == sizeof(u32));
+
+  u32 indicesSizeInBytes = indexCount * indexTypeSizeInBytes;
+  // NOTE: Index offsets must be aligned to the index type, worst case padding is accounted for in the reservation
+  VertexBuffer* vertexBuffer = reserveVertexBuffer(format, 0, indicesSizeInBytes + indexTypeSizeInBytes);
+  u32 alignedOffsetInBytes = ((vertexBuffer->indexSizeInBytes + indexTypeSizeInBytes - 1) / indexTypeSizeInBytes) * indexTypeSizeInBytes;
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer->indexBufferObject);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, alignedOffsetInBytes, indicesSizeInBytes, indices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  vertexBuffer->indexSizeInBytes = alignedOffsetInBytes + indicesSizeInBytes;
+  *resultIndexTypeSizeInBytes = indexTypeSizeInBytes;
+  return alignedOffsetInBytes / indexTypeSizeInBytes;
+}
+
 void initCubeVertexAttBuffers()
 {
   if (customVertexAtts.cubePos.indexCount == 0)
   { // uninitialized
-    // normal cube vertex attribute
-    customVertexAtts.cubePos.indexCount = ArrayCount(cubePosAttsIndices);
-    customVertexAtts.cubePos.indexTypeSizeInBytes = sizeof(cubePosAttsIndices) / customVertexAtts.cubePos.indexCount;
-
-    const u32 positionAttributeIndex = 0;
-
-    glGenVertexArrays(1, &customVertexAtts.cubePos.arrayObject); // vertex array object
-    glGenBuffers(1, &customVertexAtts.cubePos.bufferObject); // vertex buffer object backing the VAO
-    glGenBuffers(1, &customVertexAtts.cubePos.indexObject);
-
-    glBindVertexArray(customVertexAtts.cubePos.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.cubePos.bufferObject);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubePosAtts), cubePosAtts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex, // index
-                          3, // size
-                          GL_FLOAT, // type of data
-                          GL_FALSE, // whether the data needs to be normalized
-                          cubePosAttStrideInBytes, // stride
-                          (void*) 0); // offset
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.cubePos.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.cubePos.indexCount, cubePosAttsIndices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    // open cube vertex attribute
-    customVertexAtts.cubePos_OpenNegYFace = customVertexAtts.cubePos;
-    customVertexAtts.cubePos_OpenNegYFace.indexCount = ArrayCount(cubePosAttsIndices_OpenNegYFace);
-    glGenVertexArrays(1, &customVertexAtts.cubePos_OpenNegYFace.arrayObject); // vertex array object
-    glGenBuffers(1, &customVertexAtts.cubePos_OpenNegYFace.indexObject);
-    glBindVertexArray(customVertexAtts.cubePos_OpenNegYFace.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.cubePos_OpenNegYFace.bufferObject);
-
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex, // index
-                          3, // size
-                          GL_FLOAT, // type of data
-                          GL_FALSE, // whether the data needs to be normalized
-                          cubePosAttStrideInBytes, // stride
-                          (void*) 0); // offset
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.cubePos_OpenNegYFace.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.cubePos_OpenNegYFace.indexCount, cubePosAttsIndices_OpenNegYFace,
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    // inverted cube vertex att
-    customVertexAtts.invertedCubePos = customVertexAtts.cubePos;
-    glGenVertexArrays(1, &customVertexAtts.invertedCubePos.arrayObject); // vertex array object
-    glGenBuffers(1, &customVertexAtts.invertedCubePos.indexObject);
-    glBindVertexArray(customVertexAtts.invertedCubePos.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.invertedCubePos.bufferObject);
-
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex, // index
-                          3, // size
-                          GL_FLOAT, // type of data
-                          GL_FALSE, // whether the data needs to be normalized
-                          cubePosAttStrideInBytes, // stride
-                          (void*) 0); // offset
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.invertedCubePos.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.invertedCubePos.indexCount, invertedWindingCubePosAttsIndices,
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-    // open cube vertex attribute
-    customVertexAtts.invertedCubePos_OpenNegYFace = customVertexAtts.cubePos_OpenNegYFace;
-    customVertexAtts.invertedCubePos_OpenNegYFace.indexCount = ArrayCount(cubePosAttsIndices_OpenNegYFace);
-    glGenVertexArrays(1, &customVertexAtts.invertedCubePos_OpenNegYFace.arrayObject); // vertex array object
-    glGenBuffers(1, &customVertexAtts.invertedCubePos_OpenNegYFace.indexObject);
-    glBindVertexArray(customVertexAtts.invertedCubePos_OpenNegYFace.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.invertedCubePos_OpenNegYFace.bufferObject);
-
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex, // index
-                          3, // size
-                          GL_FLOAT, // type of data
-                          GL_FALSE, // whether the data needs to be normalized
-                          cubePosAttStrideInBytes, // stride
-                          (void*) 0); // offset
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.invertedCubePos_OpenNegYFace.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.invertedCubePos_OpenNegYFace.indexCount, invertedWindingCubePosAttsIndices_OpenNegYFace,
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    s32 baseVertex = addVertices(VertexFormat_Pos, cubePosAtts, ArrayCount(cubePosAtts) / 3);
+
+    auto cubeVertexAtt = [baseVertex](const u8* indices, u32 indexCount) -> VertexAtt {
+      VertexAtt vertexAtt{};
+      vertexAtt.format = VertexFormat_Pos;
+      vertexAtt.baseVertex = baseVertex;
+      vertexAtt.indexCount = indexCount;
+      vertexAtt.firstIndex = addIndices(VertexFormat_Pos, indices, indexCount, sizeof(u8), &vertexAtt.indexTypeSizeInBytes);
+      return vertexAtt;
+    };
+
+    customVertexAtts.cubePos = cubeVertexAtt(cubePosAttsIndices, ArrayCount(cubePosAttsIndices));
+    customVertexAtts.cubePos_OpenNegYFace = cubeVertexAtt(cubePosAttsIndices_OpenNegYFace, ArrayCount(cubePosAttsIndices_OpenNegYFace));
+    customVertexAtts.invertedCubePos = cubeVertexAtt(invertedWindingCubePosAttsIndices, ArrayCount(invertedWindingCubePosAttsIndices));
+    customVertexAtts.invertedCubePos_OpenNegYFace = cubeVertexAtt(invertedWindingCubePosAttsIndices_OpenNegYFace, ArrayCount(invertedWindingCubePosAttsIndices_OpenNegYFace));
   }
 }
 
 void initQuadVertexAttBuffers() {
   if (customVertexAtts.quadPosTex.indexCount == 0)
   { // uninitialized
+    customVertexAtts.quadPosTex.format = VertexFormat_PosTex;
+    customVertexAtts.quadPosTex.baseVertex = addVertices(VertexFormat_PosTex, quadPosTexVertexAttributes, sizeof(quadPosTexVertexAttributes) / quadPosTexVertexAttSizeInBytes);
     customVertexAtts.quadPosTex.indexCount = ArrayCount(quadIndices);
-    customVertexAtts.quadPosTex.indexTypeSizeInBytes = sizeof(quadIndices) / customVertexAtts.quadPosTex.indexCount;
-    const u32 positionAttributeIndex = 0;
-    const u32 textureAttributeIndex = 1;
-
-    glGenVertexArrays(1, &customVertexAtts.quadPosTex.arrayObject);
-    glGenBuffers(1, &customVertexAtts.quadPosTex.bufferObject);
-    glGenBuffers(1, &customVertexAtts.quadPosTex.indexObject);
-
-    glBindVertexArray(customVertexAtts.quadPosTex.arrayObject);
-
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.quadPosTex.bufferObject);
-    glBufferData(GL_ARRAY_BUFFER,
-                 sizeof(quadPosTexVertexAttributes),
-                 quadPosTexVertexAttributes,
-                 GL_STATIC_DRAW);
-
-    // set the vertex attributes (position and texture)
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex,
-                          3, // attribute size
-                          GL_FLOAT,
-                          GL_FALSE,
-                          quadPosTexVertexAttSizeInBytes,
-                          (void*) 0);
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    // texture attribute
-    glVertexAttribPointer(textureAttributeIndex,
-                          2, // attribute size
-                          GL_FLOAT,
-                          GL_FALSE,
-                          quadPosTexVertexAttSizeInBytes,
-                          (void*) (3 * sizeof(f32)));
-    glEnableVertexAttribArray(textureAttributeIndex);
-
-    // bind element buffer object to give indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.quadPosTex.indexObject);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(quadIndices), quadIndices, GL_STATIC_DRAW);
-
-    // unbind VBO, VAO, & EBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO, since VAO stores all glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _) calls
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    customVertexAtts.quadPosTex.firstIndex = addIndices(VertexFormat_PosTex, quadIndices, ArrayCount(quadIndices), sizeof(u8),
+                                                        &customVertexAtts.quadPosTex.indexTypeSizeInBytes);
 
+    // NOTE: position only shaders simply ignore the texture attribute
     customVertexAtts.quadPos = customVertexAtts.quadPosTex;
-
-    // only need to create a new array object, the index buffer and data buffer will be the same
-    glGenVertexArrays(1, &customVertexAtts.quadPos.arrayObject);
-    glBindVertexArray(customVertexAtts.quadPos.arrayObject);
-    glBindBuffer(GL_ARRAY_BUFFER, customVertexAtts.quadPos.bufferObject);
-
-    // set the vertex attributes (position and texture)
-    // position attribute
-    glVertexAttribPointer(positionAttributeIndex,
-                          3, // attribute size
-                          GL_FLOAT,
-                          GL_FALSE,
-                          quadPosTexVertexAttSizeInBytes,
-                          (void*) 0);
-    glEnableVertexAttribArray(positionAttributeIndex);
-
-    // bind element buffer object to give indices
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, customVertexAtts.quadPos.indexObject);
-
-    // unbind VBO, VAO, & EBO
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    // Must unbind EBO AFTER unbinding VAO, since VAO stores all glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _) calls
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
   }
 }
 
@@ -378,11 +405,12 @@ VertexAtt quadPosVertexAttBuffers(b32 textureAtt) {
 
 internal_func void drawIndexedTriangles(const VertexAtt* vertexAtt, u32 indexCount, u64 indexOffset)
 {
-  glBindVertexArray(vertexAtt->arrayObject); // NOTE: Binding every time is unnecessary if the same vertexAtt is used for multiple calls in a row
-  glDrawElements(GL_TRIANGLES, // drawing mode
-                 indexCount, // number of elements
-                 convertSizeInBytesToOpenGLUIntType(vertexAtt->indexTypeSizeInBytes), // type of the indices
-                 (void*)(indexOffset * vertexAtt->indexTypeSizeInBytes)); // offset in the EBO
+  bindVertexArrayObject(globalVertexBuffers[vertexAtt->format].arrayObject);
+  glDrawElementsBaseVertex(GL_TRIANGLES, // drawing mode
+                           indexCount, // number of elements
+                           convertSizeInBytesToOpenGLUIntType(vertexAtt->indexTypeSizeInBytes), // type of the indices
+                           (void*)((vertexAtt->firstIndex + indexOffset) * vertexAtt->indexTypeSizeInBytes), // offset in the EBO
+                           vertexAtt->baseVertex);
 }
 
 void drawTriangles(const VertexAtt* vertexAtt, u32 count, u32 offset)
@@ -396,29 +424,46 @@ void drawTriangles(const VertexAtt* vertexAtt)
   drawTriangles(vertexAtt, vertexAtt->indexCount, 0);
 }
 
-void deleteVertexAtt(VertexAtt* vertexAtt)
+void drawTrianglesInstanced(const VertexAtt* vertexAtt, u32 instanceCount)
 {
-  // TODO: prevent from deleting global vertex atts
-  glDeleteBuffers(1, &vertexAtt->indexObject);
-  glDeleteVertexArrays(1, &vertexAtt->arrayObject);
-  glDeleteBuffers(1, &vertexAtt->bufferObject);
+  bindVertexArrayObject(globalVertexBuffers[vertexAtt->format].arrayObject);
+  glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                    vertexAtt->indexCount,
+                                    convertSizeInBytesToOpenGLUIntType(vertexAtt->indexTypeSizeInBytes),
+                                    (void*)((u64)vertexAtt->firstIndex * vertexAtt->indexTypeSizeInBytes),
+                                    instanceCount,
+                                    vertexAtt->baseVertex);
 }
 
-void deleteVertexAtts(VertexAtt* vertexAtts, u32 count)
-{
-  // TODO: prevent from deleting global vertex atts
-  u32* deleteBufferObjects = new u32[count * 3];
-  u32* deleteIndexBufferObjects = deleteBufferObjects + count;
-  u32* deleteVertexArrays = deleteIndexBufferObjects + count;
-  for(u32 i = 0; i < count; i++) {
-    VertexAtt vertexAtt = vertexAtts[i];
-    deleteBufferObjects[i] = vertexAtt.bufferObject;
-    deleteIndexBufferObjects[i] = vertexAtt.indexObject;
-    deleteVertexArrays[i] = vertexAtt.arrayObject;
+VertexBufferMark vertexBufferMark() {
+  VertexBufferMark mark;
+  for(u32 format = 0; format < VertexFormat_Count; format++) {
+    mark.vertexCount[format] = globalVertexBuffers[format].vertexCount;
+    mark.indexSizeInBytes[format] = globalVertexBuffers[format].indexSizeInBytes;
   }
+  return mark;
+}
 
-  glDeleteBuffers(count * 2, deleteBufferObjects);
-  glDeleteVertexArrays(count, deleteVertexArrays);
-
-  delete[] deleteBufferObjects;
+// NOTE: Any VertexAtt added after the mark is invalid after this call
+void freeToVertexBufferMark(const VertexBufferMark& mark) {
+  for(u32 format = 0; format < VertexFormat_Count; format++) {
+    Assert(mark.vertexCount[format] <= globalVertexBuffers[format].vertexCount);
+    Assert(mark.indexSizeInBytes[format] <= globalVertexBuffers[format].indexSizeInBytes);
+    globalVertexBuffers[format].vertexCount = mark.vertexCount[format];
+    globalVertexBuffers[format].indexSizeInBytes = mark.indexSizeInBytes[format];
+  }
 }
+
+void deleteVertexBuffers()
+{
+  bindVertexArrayObject(0);
+  for(u32 format = 0; format < VertexFormat_Count; format++) {
+    VertexBuffer* vertexBuffer = globalVertexBuffers + format;
+    if(vertexBuffer->arrayObject == 0) { continue; }
+    glDeleteBuffers(1, &vertexBuffer->vertexBufferObject);
+    glDeleteBuffers(1, &vertexBuffer->indexBufferObject);
+    glDeleteVertexArrays(1, &vertexBuffer->arrayObject);
+    *vertexBuffer = {};
+  }
+  customVertexAtts = {};
+}
\ No newline at end of file
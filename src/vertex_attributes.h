@@ -1,15 +1,54 @@
 #pragma once
 
-#define VERTEX_ATT_NO_INDEX_OBJECT -1
+/*
+ * All vertex/index data lives in one set of buffers per vertex format (see globalVertexBuffers).
+ * A VertexAtt is a range within those buffers and is drawn with glDrawElementsBaseVertex, so VAOs only need to be
+ * rebound when the vertex format changes.
+ */
+enum VertexFormat {
+  VertexFormat_Pos, // vec3 position
+  VertexFormat_PosTex, // vec3 position, vec2 texCoord (location = 1)
+  VertexFormat_PosNormTex, // PosNormTexVertex
+  VertexFormat_Count
+};
+
+/*
+ * Quantized vertex of loaded models, half the size of its 32-bit float equivalent
+ * - position: unorm16 relative to the mesh's bounding box, dequantized by meshModelMat() in model.h
+ * - normal: snorm16 octahedral encoding, decoded in shaders with octDecode() from include/VertexDecode.glsl
+ * - texCoord: half float
+ */
+struct PosNormTexVertex {
+  u16 position[3];
+  u16 padding; // NOTE: keeps the following attributes 4 byte aligned
+  s16 normal[2];
+  u16 texCoord[2];
+};
 
 struct VertexAtt {
-  GLuint arrayObject;
-  GLuint bufferObject;
-  GLuint indexObject;
+  VertexFormat format;
+  s32 baseVertex;
+  u32 firstIndex; // NOTE: in units of indexTypeSizeInBytes
   u32 indexCount;
   u32 indexTypeSizeInBytes;
 };
 
+struct VertexBuffer {
+  GLuint arrayObject;
+  GLuint vertexBufferObject;
+  GLuint indexBufferObject;
+  u32 vertexCount;
+  u32 vertexCapacity;
+  u32 indexSizeInBytes;
+  u32 indexCapacityInBytes;
+};
+
+// NOTE: Used to free everything allocated after the mark, vertex buffers are never freed piecemeal
+struct VertexBufferMark {
+  u32 vertexCount[VertexFormat_Count];
+  u32 indexSizeInBytes[VertexFormat_Count];
+};
+
 const vec3 cubeFaceNegativeXCenter{-0.5f, 0.0f, 0.0f};
 const vec3 cubeFacePositiveXCenter{0.5f, 0.0f, 0.0f};
 const vec3 cubeFaceNegativeYCenter{0.0f, -0.5f, 0.0f};
@@ -29,10 +68,15 @@ const BoundingBox cubeVertAttBoundingBox = {
 };
 
 VertexAtt cubePosVertexAttBuffers(bool invertedWindingOrder = false, bool openNegYFace = false);
-VertexAtt quadVertexPosAttBuffers(b32 textureAtt = false);
+VertexAtt quadPosVertexAttBuffers(b32 textureAtt = false);
+
+s32 addVertices(VertexFormat format, const void* vertices, u32 vertexCount);
+u32 addIndices(VertexFormat format, const void* indices, u32 indexCount, u32 indexTypeSizeInBytes, Out u32* resultIndexTypeSizeInBytes);
 
 void drawTriangles(const VertexAtt* vertexAtt, u32 count, u32 offset);
 void drawTriangles(const VertexAtt* vertexAtt);
+void drawTrianglesInstanced(const VertexAtt* vertexAtt, u32 instanceCount);
 
-void deleteVertexAtt(VertexAtt* vertexAtt);
-void deleteVertexAtts(VertexAtt* vertexAtts, u32 count);
\ No newline at end of file
+VertexBufferMark vertexBufferMark();
+void freeToVertexBufferMark(const VertexBufferMark& mark);
+void deleteVertexBuffers();
\ No newline at end of file